@@ -0,0 +1,200 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Benchmark.h"
+
+#include "Platform/Platform.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace 
+{
+    // Number of timed batches, the median is reported so one descheduled 
+    // batch doesn't skew the result.
+    static inline const size_t BATCH_COUNT = 5;
+
+    // Runs the body the given number of times, returns the elapsed seconds or
+    // a negative value on failure.
+    double TimeBatch(const std::function<bool()>& Body, size_t Iterations)
+    {
+        double StartTime = GetHighResolutionSeconds();
+        for (size_t i = 0; i < Iterations; i++)
+        {
+            if (!Body())
+            {
+                return -1.0;
+            }
+        }
+        return GetHighResolutionSeconds() - StartTime;
+    }
+};
+
+BenchmarkRunner::BenchmarkRunner(double InMinSecondsPerCase, const std::string& InFilter)
+    : MinSecondsPerCase(InMinSecondsPerCase)
+    , Filter(InFilter)
+{
+}
+
+void BenchmarkRunner::Run(const std::string& Name, const std::string& PayloadName, size_t PayloadSize, const std::function<bool()>& Body)
+{
+    std::string FullName = Name + "/" + PayloadName;
+    if (!Filter.empty() && FullName.find(Filter) == std::string::npos)
+    {
+        return;
+    }
+
+    BenchmarkResult Result;
+    Result.Name = Name;
+    Result.PayloadName = PayloadName;
+    Result.PayloadSize = PayloadSize;
+
+    // Grow the batch size until a single batch takes up its share of the
+    // time budget. This also doubles as the warmup.
+    double BatchSeconds = MinSecondsPerCase / BATCH_COUNT;
+    size_t Iterations = 1;
+    while (true)
+    {
+        double Elapsed = TimeBatch(Body, Iterations);
+        if (Elapsed < 0.0)
+        {
+            Result.Success = false;
+            break;
+        }
+        if (Elapsed >= BatchSeconds)
+        {
+            break;
+        }
+
+        // Aim straight for the target if we have a usable measurement, 
+        // otherwise just keep doubling.
+        size_t NextIterations = Iterations * 2;
+        if (Elapsed > BatchSeconds / 100.0)
+        {
+            NextIterations = std::max(NextIterations, (size_t)(Iterations * (BatchSeconds / Elapsed) * 1.1));
+        }
+        Iterations = NextIterations;
+    }
+
+    if (Result.Success)
+    {
+        std::vector<double> BatchTimes;
+        for (size_t i = 0; i < BATCH_COUNT && Result.Success; i++)
+        {
+            double Elapsed = TimeBatch(Body, Iterations);
+            Result.Success = (Elapsed >= 0.0);
+            BatchTimes.push_back(Elapsed);
+        }
+
+        if (Result.Success)
+        {
+            std::sort(BatchTimes.begin(), BatchTimes.end());
+            double Median = BatchTimes[BatchTimes.size() / 2];
+
+            Result.Iterations = Iterations * BATCH_COUNT;
+            Result.NanosecondsPerOp = (Median * 1000000000.0) / Iterations;
+            Result.BytesPerSecond = Median > 0.0 ? (double)(PayloadSize * Iterations) / Median : 0.0;
+        }
+    }
+
+    // Progress goes to stderr so stdout can be redirected to a file.
+    fprintf(stderr, "%-40s %s\n", FullName.c_str(), Result.Success ? "done" : "FAILED");
+
+    Results.push_back(Result);
+}
+
+void BenchmarkRunner::Check(const std::string& Name, const std::string& PayloadName, const std::function<bool()>& Body)
+{
+    std::string FullName = Name + "/" + PayloadName;
+    if (!Filter.empty() && FullName.find(Filter) == std::string::npos)
+    {
+        return;
+    }
+
+    BenchmarkResult Result;
+    Result.Name = Name;
+    Result.PayloadName = PayloadName;
+
+    double Elapsed = TimeBatch(Body, 1);
+    Result.Success = (Elapsed >= 0.0);
+    if (Result.Success)
+    {
+        Result.Iterations = 1;
+        Result.NanosecondsPerOp = Elapsed * 1000000000.0;
+    }
+
+    fprintf(stderr, "%-40s %s\n", FullName.c_str(), Result.Success ? "passed" : "FAILED");
+
+    Results.push_back(Result);
+}
+
+bool BenchmarkRunner::HasFailures() const
+{
+    return std::any_of(Results.begin(), Results.end(), [](const BenchmarkResult& Result) { return !Result.Success; });
+}
+
+void WriteResultsAsText(const std::vector<BenchmarkResult>& Results)
+{
+    printf("%-28s %-8s %8s %14s %12s %14s\n", "Benchmark", "Payload", "Bytes", "Iterations", "ns/op", "MB/s");
+    for (const BenchmarkResult& Result : Results)
+    {
+        if (!Result.Success)
+        {
+            printf("%-28s %-8s %8zu %14s\n", Result.Name.c_str(), Result.PayloadName.c_str(), Result.PayloadSize, "FAILED");
+            continue;
+        }
+
+        printf("%-28s %-8s %8zu %14zu %12.1f %14.2f\n", 
+            Result.Name.c_str(), 
+            Result.PayloadName.c_str(), 
+            Result.PayloadSize, 
+            Result.Iterations, 
+            Result.NanosecondsPerOp, 
+            Result.BytesPerSecond / (1024.0 * 1024.0)
+        );
+    }
+}
+
+void WriteResultsAsCsv(const std::vector<BenchmarkResult>& Results)
+{
+    printf("name,payload,bytes,iterations,ns_per_op,bytes_per_second,success\n");
+    for (const BenchmarkResult& Result : Results)
+    {
+        printf("%s,%s,%zu,%zu,%.3f,%.3f,%d\n", 
+            Result.Name.c_str(), 
+            Result.PayloadName.c_str(), 
+            Result.PayloadSize, 
+            Result.Iterations, 
+            Result.NanosecondsPerOp, 
+            Result.BytesPerSecond, 
+            Result.Success ? 1 : 0
+        );
+    }
+}
+
+void WriteResultsAsJson(const std::vector<BenchmarkResult>& Results)
+{
+    // Names are all our own identifiers, so no escaping is needed.
+    printf("[\n");
+    for (size_t i = 0; i < Results.size(); i++)
+    {
+        const BenchmarkResult& Result = Results[i];
+        printf("  { \"name\": \"%s\", \"payload\": \"%s\", \"bytes\": %zu, \"iterations\": %zu, \"ns_per_op\": %.3f, \"bytes_per_second\": %.3f, \"success\": %s }%s\n", 
+            Result.Name.c_str(), 
+            Result.PayloadName.c_str(), 
+            Result.PayloadSize, 
+            Result.Iterations, 
+            Result.NanosecondsPerOp, 
+            Result.BytesPerSecond, 
+            Result.Success ? "true" : "false",
+            i + 1 < Results.size() ? "," : ""
+        );
+    }
+    printf("]\n");
+}
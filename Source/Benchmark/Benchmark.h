@@ -0,0 +1,62 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+// Super simple harness for timing the primitives on the packet hot path
+// (ciphers, compression, etc). Each case is run in batches until it has
+// been running for long enough to get a stable figure, the median batch
+// is what gets reported.
+
+struct BenchmarkResult
+{
+    std::string Name;
+    std::string PayloadName;
+    size_t PayloadSize = 0;
+    size_t Iterations = 0;
+    double NanosecondsPerOp = 0.0;
+    double BytesPerSecond = 0.0;
+    bool Success = true;
+};
+
+class BenchmarkRunner
+{
+public:
+
+    BenchmarkRunner(double MinSecondsPerCase, const std::string& Filter);
+
+    // Times the given body. The body should do a single operation and return
+    // false if it failed, in which case the case is marked as failed and
+    // timing stops.
+    void Run(const std::string& Name, const std::string& PayloadName, size_t PayloadSize, const std::function<bool()>& Body);
+
+    // Runs the given body once rather than in timed batches, for cases that check behaviour
+    // rather than speed. Returning false marks the case as failed the same as Run.
+    void Check(const std::string& Name, const std::string& PayloadName, const std::function<bool()>& Body);
+
+    const std::vector<BenchmarkResult>& GetResults() const { return Results; }
+
+    bool HasFailures() const;
+
+private:
+    double MinSecondsPerCase;
+    std::string Filter;
+
+    std::vector<BenchmarkResult> Results;
+
+};
+
+// Output formats. Text is for people, csv/json are for diffing between builds.
+void WriteResultsAsText(const std::vector<BenchmarkResult>& Results);
+void WriteResultsAsCsv(const std::vector<BenchmarkResult>& Results);
+void WriteResultsAsJson(const std::vector<BenchmarkResult>& Results);
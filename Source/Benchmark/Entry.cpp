@@ -0,0 +1,1324 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+// Standalone benchmark of the primitives on the packet hot path, and of the 
+// game services client lookups, area pools and database thread. Doesn't need steam or any networking so it 
+// can run on a plain build box. Also checks the area pools against a model, and that their random sets
+// are uniform, since those are cheap to run here and fail the run the same way.
+//
+// Usage: Benchmark [-format=text|csv|json] [-filter=<substring>] [-min_time=<seconds>]
+//
+// Building on linux (from Source/):
+//   gcc -O2 -c -IThirdParty/aes ThirdParty/aes/aescrypt.c ThirdParty/aes/aeskey.c ThirdParty/aes/aestab.c ThirdParty/aes_modes/cwc.c ThirdParty/zlib/*.c
+//   g++ -std=c++20 -O2 -Wall -Wextra -I. -IServer -IBenchmark -IThirdParty/aes -IThirdParty/aes_modes -IThirdParty/zlib
+//       -IThirdParty/protobuf-2.6.1rc1/src
+//       Benchmark/*.cpp Server/Platform/Linux/LinuxPlatform.cpp Server/Core/Crypto/Cipher.cpp
+//       Server/Core/Crypto/CipherWorkerPool.cpp Server/Core/Crypto/CWC*.cpp Server/Core/Crypto/RSA*.cpp Server/Core/Utils/Compression.cpp
+//       Server/Core/Utils/Random.cpp Server/Core/Utils/Logging.cpp Server/Core/Utils/Strings.cpp Server/Core/Utils/WorkerGroup.cpp
+//       Server/Core/Utils/Debug*.cpp Server/Server/Streams/Frpg2UdpPacketStream.cpp
+//       Server/Server/Database/ServerDatabase.cpp Server/Server/Database/DatabaseExecutor.cpp
+//       *.o -lcrypto -lsqlite3 -lpthread -o benchmark
+// With OpenSSL 3 add -Wno-deprecated-declarations, the RSA_* calls in RSACipher are deprecated there.
+
+#include "Benchmark.h"
+
+#include "Core/Crypto/CipherWorkerPool.h"
+#include "Core/Crypto/CWCCipher.h"
+#include "Core/Crypto/CWCServerUDPCipher.h"
+#include "Core/Crypto/CWCClientUDPCipher.h"
+#include "Core/Crypto/CWCKeySchedule.h"
+#include "Core/Crypto/RSACipher.h"
+#include "Core/Crypto/RSAKeyPair.h"
+#include "Core/Utils/Compression.h"
+#include "Core/Utils/Logging.h"
+#include "Core/Utils/Random.h"
+#include "Core/Utils/Strings.h"
+#include "Core/Utils/WorkerGroup.h"
+#include "Core/Network/NetConnection.h"
+#include "Platform/Platform.h"
+
+#include "Server/Streams/Frpg2UdpPacketStream.h"
+
+#include "Server/GameService/Utils/ClientIndex.h"
+#include "Server/GameService/Utils/ClientScheduler.h"
+#include "Server/GameService/Utils/OnlineAreaPool.h"
+
+#include "Server/Database/ServerDatabase.h"
+#include "Server/Database/DatabaseExecutor.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <filesystem>
+#include <unordered_set>
+#include <deque>
+#include <iterator>
+
+namespace 
+{
+    struct PayloadSize
+    {
+        const char* Name;
+        size_t Size;
+    };
+
+    // Roughly the distribution of packets we see in game: a flood of 
+    // tiny acks, a steady stream of status updates and the occasional 
+    // large blob (ghost data, bloodmessages, etc).
+    static inline const PayloadSize PAYLOAD_SIZES[] = {
+        { "Ack",    16 },
+        { "Status", 1024 },
+        { "Ghost",  8 * 1024 },
+    };
+
+    static inline const uint64_t AUTH_TOKEN = 0x0123456789abcdefull;
+
+    // Generates a deterministic payload that compresses roughly as well as
+    // real packets do; protobuf encoded fields with lots of small values 
+    // and the odd blob of high entropy data.
+    std::vector<uint8_t> MakePayload(size_t Size)
+    {
+        std::vector<uint8_t> Result(Size);
+        uint32_t State = 0x12345678u;
+        for (size_t i = 0; i < Size; i++)
+        {
+            State = State * 1664525u + 1013904223u;
+            uint8_t Value = (uint8_t)(State >> 24);
+            Result[i] = (i % 64) < 48 ? (uint8_t)(Value & 0x07) : Value;
+        }
+        return Result;
+    }
+
+    // Encrypt/decrypt of a single packet through the in place path, the same
+    // way the streams use it.
+    void RunCipherBenchmarks(BenchmarkRunner& Runner, const std::string& Name, Cipher& EncryptCipher, Cipher& DecryptCipher)
+    {
+        for (const PayloadSize& Payload : PAYLOAD_SIZES)
+        {
+            std::vector<uint8_t> Plaintext = MakePayload(Payload.Size);
+
+            size_t Prefix = EncryptCipher.GetPrefixSize();
+            std::vector<uint8_t> Buffer(Prefix + Plaintext.size() + EncryptCipher.GetSuffixSize());
+            memcpy(Buffer.data() + Prefix, Plaintext.data(), Plaintext.size());
+
+            Runner.Run(Name + ".Encrypt", Payload.Name, Payload.Size, [&]() {
+                CipherSpan Span = { Buffer.data(), Buffer.size(), Prefix, Plaintext.size() };
+                return EncryptCipher.Encrypt(Span);
+            });
+
+            // Decrypting is destructive, so each iteration has to restore the 
+            // ciphertext. That copy is included in the timing.
+            std::vector<uint8_t> Ciphertext = Plaintext;
+            if (!EncryptCipher.Encrypt(Ciphertext))
+            {
+                Error("Failed to encrypt payload for %s.", Name.c_str());
+                continue;
+            }
+
+            std::vector<uint8_t> DecryptBuffer(Ciphertext.size());
+            Runner.Run(Name + ".Decrypt", Payload.Name, Payload.Size, [&]() {
+                memcpy(DecryptBuffer.data(), Ciphertext.data(), Ciphertext.size());
+                CipherSpan Span = { DecryptBuffer.data(), DecryptBuffer.size(), 0, Ciphertext.size() };
+                return DecryptCipher.Decrypt(Span);
+            });
+        }
+    }
+
+    void RunCWCBenchmarks(BenchmarkRunner& Runner)
+    {
+        std::vector<uint8_t> Key = MakePayload(16);
+        std::shared_ptr<CWCKeySchedule> KeySchedule = std::make_shared<CWCKeySchedule>(Key);
+
+        CWCCipher TcpEncrypt(KeySchedule);
+        CWCCipher TcpDecrypt(KeySchedule);
+        RunCipherBenchmarks(Runner, "CWCCipher", TcpEncrypt, TcpDecrypt);
+
+        // Server sends with the server cipher, and the client cipher is used by
+        // the server to decrypt what clients send, so pair each with itself.
+        CWCServerUDPCipher ServerUdpEncrypt(KeySchedule, AUTH_TOKEN);
+        CWCServerUDPCipher ServerUdpDecrypt(KeySchedule, AUTH_TOKEN);
+        RunCipherBenchmarks(Runner, "CWCServerUDPCipher", ServerUdpEncrypt, ServerUdpDecrypt);
+
+        CWCClientUDPCipher ClientUdpEncrypt(KeySchedule, AUTH_TOKEN);
+        CWCClientUDPCipher ClientUdpDecrypt(KeySchedule, AUTH_TOKEN);
+        RunCipherBenchmarks(Runner, "CWCClientUDPCipher", ClientUdpEncrypt, ClientUdpDecrypt);
+
+        Runner.Run("CWCKeySchedule.Create", "Key", Key.size(), [&]() {
+            CWCKeySchedule Schedule(Key);
+            return true;
+        });
+    }
+
+    std::vector<uint8_t> HexToBytes(const std::string& Hex)
+    {
+        std::vector<uint8_t> Result;
+        for (size_t i = 0; i + 1 < Hex.size(); i += 2)
+        {
+            Result.push_back((uint8_t)strtoul(Hex.substr(i, 2).c_str(), nullptr, 16));
+        }
+        return Result;
+    }
+
+    // Encrypts a spread of message, header and key lengths with fixed contents and folds every 
+    // ciphertext and tag into one FNV-1a digest.
+    uint64_t DigestCwcMessages()
+    {
+        uint64_t Digest = 0xcbf29ce484222325ull;
+        auto Fold = [&Digest](const uint8_t* Data, size_t Length) {
+            for (size_t i = 0; i < Length; i++)
+            {
+                Digest = (Digest ^ Data[i]) * 0x100000001b3ull;
+            }
+        };
+
+        for (uint32_t Length = 0; Length < 300; Length++)
+        {
+            uint32_t State = Length * 2654435761u + 1;
+            auto NextByte = [&State]() {
+                State = State * 1664525u + 1013904223u;
+                return (uint8_t)(State >> 24);
+            };
+
+            std::vector<uint8_t> Key(16 + (Length % 3) * 8);
+            std::vector<uint8_t> IV(11);
+            std::vector<uint8_t> Header(Length % 37);
+            std::vector<uint8_t> Message(Length);
+            for (std::vector<uint8_t>* Buffer : { &Key, &IV, &Header, &Message })
+            {
+                for (uint8_t& Value : *Buffer)
+                {
+                    Value = NextByte();
+                }
+            }
+
+            uint8_t Tag[16];
+            cwc_ctx Context;
+            cwc_init_and_key(Key.data(), (unsigned long)Key.size(), &Context);
+            cwc_encrypt_message(IV.data(), (unsigned long)IV.size(), Header.data(), (unsigned long)Header.size(), Message.data(), (unsigned long)Message.size(), Tag, sizeof(Tag), &Context);
+            cwc_end(&Context);
+
+            Fold(Message.data(), Message.size());
+            Fold(Tag, sizeof(Tag));
+        }
+
+        return Digest;
+    }
+
+    // Guards the CWC hash, which is computed on 64-bit limbs where the compiler has a 64x64 multiply
+    // and 32-bit words otherwise. Inputs and ciphertexts are the ones shipped with the cwc library 
+    // (testvals/cwc.1), but the tags in there don't match the variant of cwc.c in this tree, so the 
+    // tags here, and the digest, were taken from the 32-bit implementation before the 64-bit one was added.
+    void RunCWCChecks(BenchmarkRunner& Runner)
+    {
+        struct CwcVector
+        {
+            size_t KeyLength;
+            bool HasHeader;
+            size_t MessageLength;
+            const char* Ciphertext;
+            const char* Tag;
+        };
+
+        // Every vector uses a prefix of the same key and message, and the same iv and header.
+        static const CwcVector Vectors[] = {
+            { 16, false,  8, "88b8df0628fd51cc", "1964300f8f6b7aedec23bebed04cabf2" },
+            { 24, false,  8, "f0dba974123001b0", "45a097b3df393533d43e90b2254a303b" },
+            { 32, false,  8, "7bcf73be469c460b", "b1b2d8c69ab741b13aada4c72ff7a93e" },
+            { 16, true ,  8, "88b8df0628fd51cc", "49beccf14bfe9f71e342e886ce09397b" },
+            { 24, true ,  8, "f0dba974123001b0", "be1330bb5147c006a8c8eac39a983dea" },
+            { 32, true ,  8, "7bcf73be469c460b", "a682e782353235c222c11a21062082ba" },
+            { 16, false, 15, "88b8df0628fd51cc31e66e570b0f77", "d098d680251818c2a453cf3f7c7aea80" },
+            { 24, false, 15, "f0dba974123001b0e142b75887c900", "49420769be791b3ce032acdfb0554073" },
+            { 32, false, 15, "7bcf73be469c460b9bc62dde26dd47", "e3baaf8cdefada4d761a39b8d950437a" },
+            { 16, true , 15, "88b8df0628fd51cc31e66e570b0f77", "b167059758da79976f7acfb6447ca36b" },
+            { 24, true , 15, "f0dba974123001b0e142b75887c900", "8fa8fa3e8a367b26ff25156eeb8e48d2" },
+            { 32, true , 15, "7bcf73be469c460b9bc62dde26dd47", "74a3c03c9b72a4fbd41b0dc30a8732f9" },
+            { 16, false, 32, "88b8df0628fd51cc31e66e570b0f770f485b82646ecfb9f9a0b0754fd594365a", "23eb5108f1d516e11736ce95435d7897" },
+            { 24, false, 32, "f0dba974123001b0e142b75887c900a3a4c4706d4041f4f958e13fd0d7604d1e", "e99f035182db5c901ae6643d1349beaa" },
+            { 32, false, 32, "7bcf73be469c460b9bc62dde26dd47b5d24106ca5deb80a7b5710a38a4398dba", "47428566be88ad072f7ac6a9a989b1f3" },
+            { 16, true , 32, "88b8df0628fd51cc31e66e570b0f770f485b82646ecfb9f9a0b0754fd594365a", "93bb44a2b3783f95afad403be32f5078" },
+            { 24, true , 32, "f0dba974123001b0e142b75887c900a3a4c4706d4041f4f958e13fd0d7604d1e", "8da9159cd3a6dc2822c29d9ee87f29f9" },
+            { 32, true , 32, "7bcf73be469c460b9bc62dde26dd47b5d24106ca5deb80a7b5710a38a4398dba", "eb6e83805920174e825364d9ba5eb312" },
+        };
+
+        Runner.Check("CWC.KnownAnswer", "Vectors", [&]() {
+            std::vector<uint8_t> Key = HexToBytes("000102030405060708090a0b0c0d0e0ff0e0d0c0b0a090807060504030201000");
+            std::vector<uint8_t> IV = HexToBytes("ffeeddccbbaa9988776655");
+            std::vector<uint8_t> Header = HexToBytes("54686973206973206120706c61696e74657874206865616465722e00");
+            std::vector<uint8_t> Plaintext = HexToBytes("000102030405060708090a0b0c0d0e0f808182838485868788898a8b8c8d8e8f");
+
+            for (size_t i = 0; i < std::size(Vectors); i++)
+            {
+                const CwcVector& Vector = Vectors[i];
+                std::vector<uint8_t> Message(Plaintext.begin(), Plaintext.begin() + Vector.MessageLength);
+                std::vector<uint8_t> Tag(16);
+
+                cwc_ctx Context;
+                cwc_init_and_key(Key.data(), (unsigned long)Vector.KeyLength, &Context);
+                cwc_encrypt_message(IV.data(), (unsigned long)IV.size(), Header.data(), Vector.HasHeader ? (unsigned long)Header.size() : 0, Message.data(), (unsigned long)Message.size(), Tag.data(), (unsigned long)Tag.size(), &Context);
+                cwc_end(&Context);
+
+                if (Message != HexToBytes(Vector.Ciphertext) || Tag != HexToBytes(Vector.Tag))
+                {
+                    Error("CWC vector %zu doesn't match, got ciphertext %s tag %s.", i + 1, BytesToHex(Message).c_str(), BytesToHex(Tag).c_str());
+                    return false;
+                }
+            }
+            return true;
+        });
+
+        Runner.Check("CWC.Equivalence", "300", [&]() {
+            const uint64_t ExpectedDigest = 0x30c2b222f2b566a8ull;
+
+            uint64_t Digest = DigestCwcMessages();
+            if (Digest != ExpectedDigest)
+            {
+                Error("CWC digest is 0x%016llx, expected 0x%016llx.", (unsigned long long)Digest, (unsigned long long)ExpectedDigest);
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // Throughput of the per-thread ChaCha20 generator, at the sizes it's asked for in practice:
+    // an iv per packet, auth tokens and session keys, and the odd large fill.
+    void RunRandomBenchmarks(BenchmarkRunner& Runner)
+    {
+        for (const PayloadSize& Payload : PAYLOAD_SIZES)
+        {
+            std::vector<uint8_t> Buffer(Payload.Size);
+            Runner.Run("Random.FillBytes", Payload.Name, Payload.Size, [&]() {
+                FillRandomBytes(Buffer);
+                return true;
+            });
+        }
+
+        Runner.Run("Random.FRandRange", "Double", sizeof(double), [&]() {
+            double Value = FRandRange(1.0, 2.0);
+            return Value >= 1.0 && Value < 2.0;
+        });
+    }
+
+    // Checks the ChaCha20 block function against the RFC 8439 test vector (section 2.3.2), 
+    // then that the generators output is balanced; each bit set about half the time and every 
+    // byte value about as common as the others. The output isn't seeded, so the thresholds are 
+    // set far enough out (around one in a million for a good generator) that they only trip
+    // on a real fault.
+    void RunRandomChecks(BenchmarkRunner& Runner)
+    {
+        Runner.Check("ChaCha20.KnownAnswer", "RFC8439", [&]() {
+            const uint32_t Key[8] = { 0x03020100, 0x07060504, 0x0b0a0908, 0x0f0e0d0c, 0x13121110, 0x17161514, 0x1b1a1918, 0x1f1e1d1c };
+            const uint32_t Nonce[3] = { 0x09000000, 0x4a000000, 0x00000000 };
+            const uint32_t Counter = 1;
+
+            std::vector<uint8_t> Expected = HexToBytes(
+                "10f1e7e4d13b5915500fdd1fa32071c4c7d1f4c733c068030422aa9ac3d46c4e"
+                "d2826446079faa0914c2d705d98b02a2b5129cd1de164eb9cbd083e8a2503c4e"
+            );
+
+            std::vector<uint8_t> Output(64);
+            ChaCha20Block(Key, Counter, Nonce, Output.data());
+            if (Output != Expected)
+            {
+                Error("ChaCha20 block doesn't match the RFC 8439 vector, got %s.", BytesToHex(Output).c_str());
+                return false;
+            }
+            return true;
+        });
+
+        Runner.Check("Random.Balance", "1MB", [&]() {
+            const size_t ByteCount = 1024 * 1024;
+            const double MaxBitDeviations = 6.0;
+
+            // Critical value for 255 degrees of freedom at p = 0.000001.
+            const double ChiSquareThreshold = 377.2;
+
+            std::vector<uint8_t> Buffer(ByteCount);
+
+            // Fill a piece at a time in awkward sizes so both the buffered and direct block paths are used.
+            size_t Offset = 0;
+            for (size_t Step = 1; Offset < ByteCount; Step = (Step * 7 + 3) % 2048)
+            {
+                size_t Count = std::min(Step + 1, ByteCount - Offset);
+                FillRandomBytes(Buffer.data() + Offset, (int)Count);
+                Offset += Count;
+            }
+
+            std::vector<size_t> ValueCounts(256, 0);
+            size_t BitCounts[8] = {};
+            for (uint8_t Value : Buffer)
+            {
+                ValueCounts[Value]++;
+                for (int Bit = 0; Bit < 8; Bit++)
+                {
+                    BitCounts[Bit] += (Value >> Bit) & 1;
+                }
+            }
+
+            // Each bit position is a binomial with p = 0.5.
+            double ExpectedBits = ByteCount / 2.0;
+            double BitDeviation = sqrt(ByteCount * 0.25);
+            for (int Bit = 0; Bit < 8; Bit++)
+            {
+                double Deviations = fabs((double)BitCounts[Bit] - ExpectedBits) / BitDeviation;
+                if (Deviations > MaxBitDeviations)
+                {
+                    Error("Random bit %d was set %zu times out of %zu, %.1f deviations from expected.", Bit, BitCounts[Bit], ByteCount, Deviations);
+                    return false;
+                }
+            }
+
+            double ExpectedCount = ByteCount / 256.0;
+            double ChiSquare = 0.0;
+            for (size_t Count : ValueCounts)
+            {
+                double Difference = (double)Count - ExpectedCount;
+                ChiSquare += (Difference * Difference) / ExpectedCount;
+            }
+
+            Log("Random byte value chi-square: %.2f, threshold %.2f.", ChiSquare, ChiSquareThreshold);
+            return ChiSquare <= ChiSquareThreshold;
+        });
+    }
+
+    // A ticks worth of outgoing game packets being encrypted, the same way GameService::FlushBatchedSends
+    // does it. Each stream has its own cipher and its whole batch is encrypted by one thread. Run with 
+    // different numbers of threads to see how it scales, the calling thread counts as one of them.
+    void RunBatchedEncryptBenchmarks(BenchmarkRunner& Runner)
+    {
+        const size_t StreamCount = 256;
+        const size_t PacketsPerStream = 8;
+        const PayloadSize& Payload = PAYLOAD_SIZES[1];
+
+        std::vector<uint8_t> Key = MakePayload(16);
+        std::shared_ptr<CWCKeySchedule> KeySchedule = std::make_shared<CWCKeySchedule>(Key);
+        std::vector<uint8_t> Plaintext = MakePayload(Payload.Size);
+
+        struct BatchedStream
+        {
+            std::unique_ptr<CWCClientUDPCipher> EncryptionCipher;
+            std::vector<std::vector<uint8_t>> Packets;
+            bool Encrypted = true;
+        };
+
+        std::vector<BatchedStream> Streams(StreamCount);
+        size_t Prefix = 0;
+        for (BatchedStream& Stream : Streams)
+        {
+            Stream.EncryptionCipher = std::make_unique<CWCClientUDPCipher>(KeySchedule, AUTH_TOKEN);
+            Prefix = Stream.EncryptionCipher->GetPrefixSize();
+
+            Stream.Packets.resize(PacketsPerStream);
+            for (std::vector<uint8_t>& Packet : Stream.Packets)
+            {
+                Packet.resize(Prefix + Plaintext.size() + Stream.EncryptionCipher->GetSuffixSize());
+                memcpy(Packet.data() + Prefix, Plaintext.data(), Plaintext.size());
+            }
+        }
+
+        // Encrypting overwrites the payload, which doesn't matter for timing; the size is all that counts.
+        auto EncryptStream = [&](size_t Index) {
+            BatchedStream& Stream = Streams[Index];
+            Stream.Encrypted = true;
+            for (std::vector<uint8_t>& Packet : Stream.Packets)
+            {
+                CipherSpan Span = { Packet.data(), Packet.size(), Prefix, Plaintext.size() };
+                Stream.Encrypted &= Stream.EncryptionCipher->Encrypt(Span);
+            }
+        };
+
+        std::vector<size_t> ThreadCounts = { 1, 2, 4 };
+        size_t HardwareThreads = std::thread::hardware_concurrency();
+        if (HardwareThreads > ThreadCounts.back())
+        {
+            ThreadCounts.push_back(HardwareThreads);
+        }
+
+        std::string BatchName = StringFormat("%zux%zu", StreamCount, PacketsPerStream);
+        for (size_t ThreadCount : ThreadCounts)
+        {
+            WorkerGroup Workers(ThreadCount - 1);
+
+            Runner.Run("BatchedEncrypt", StringFormat("%s/%zut", BatchName.c_str(), ThreadCount), StreamCount * PacketsPerStream * Payload.Size, [&]() {
+                Workers.ParallelFor(Streams.size(), EncryptStream);
+
+                for (BatchedStream& Stream : Streams)
+                {
+                    if (!Stream.Encrypted)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            });
+        }
+    }
+
+    // Connection that hands out the same set of datagrams every time it's rewound, stands 
+    // in for a clients udp connection so the packet streams can be pumped without a socket.
+    class LoopbackConnection : public NetConnection
+    {
+    public:
+        LoopbackConnection(const std::vector<std::vector<uint8_t>>& InDatagrams)
+            : Datagrams(InDatagrams)
+        {
+        }
+
+        void Rewind() { NextDatagram = 0; }
+
+        virtual bool Listen(int /* Port */) override { return false; }
+        virtual std::shared_ptr<NetConnection> Accept() override { return nullptr; }
+        virtual bool Connect(std::string /* Hostname */, int /* Port */, bool /* ForceLastIpEntry */) override { return false; }
+        virtual bool Pump() override { return false; }
+        virtual bool HasPendingData() override { return NextDatagram < Datagrams.size(); }
+
+        virtual bool Peek(std::vector<uint8_t>& /* Buffer */, int /* Offset */, int /* Count */, int& BytesRecieved) override 
+        { 
+            BytesRecieved = 0;
+            return false; 
+        }
+
+        virtual bool Recieve(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) override
+        {
+            BytesRecieved = 0;
+            if (NextDatagram < Datagrams.size())
+            {
+                const std::vector<uint8_t>& Datagram = Datagrams[NextDatagram++];
+                if (Datagram.size() > (size_t)Count)
+                {
+                    return false;
+                }
+                memcpy(Buffer.data() + Offset, Datagram.data(), Datagram.size());
+                BytesRecieved = (int)Datagram.size();
+            }
+            return true;
+        }
+
+        virtual bool Send(const std::vector<uint8_t>& /* Buffer */, int /* Offset */, int /* Count */) override { return true; }
+        virtual bool Disconnect() override { return true; }
+        virtual bool IsConnected() override { return true; }
+        virtual NetIPAddress GetAddress() override { return NetIPAddress(); }
+        virtual std::string GetName() override { return "Loopback"; }
+        virtual void Rename(const std::string& /* Name */) override { }
+
+    private:
+        const std::vector<std::vector<uint8_t>>& Datagrams;
+        size_t NextDatagram = 0;
+
+    };
+
+    // Load test of the recieve half of a game service tick, the same way GameService::PumpClientNetworks
+    // does it. Every client has a few packets waiting which are pumped (recieved and decrypted) through 
+    // its own packet stream, with each client handled entirely by one thread. Run with different numbers 
+    // of threads to see how it scales, the calling thread counts as one of them.
+    void RunRecieveBenchmarks(BenchmarkRunner& Runner)
+    {
+        const size_t ClientCount = 256;
+        const size_t PacketsPerClient = 8;
+        const PayloadSize& Payload = PAYLOAD_SIZES[1];
+
+        std::vector<uint8_t> Key = MakePayload(16);
+        std::shared_ptr<CWCKeySchedule> KeySchedule = std::make_shared<CWCKeySchedule>(Key);
+
+        // The server decrypts with the client cipher, so thats what the clients packets are encrypted with.
+        std::shared_ptr<Cipher> ClientEncrypt = std::make_shared<CWCClientUDPCipher>(KeySchedule, AUTH_TOKEN);
+        std::vector<std::vector<uint8_t>> Datagrams(PacketsPerClient);
+        for (std::vector<uint8_t>& Datagram : Datagrams)
+        {
+            Datagram = MakePayload(Payload.Size);
+            if (!ClientEncrypt->Encrypt(Datagram))
+            {
+                Error("Failed to encrypt datagram for recieve benchmark.");
+                return;
+            }
+        }
+
+        struct RecievingClient
+        {
+            std::shared_ptr<LoopbackConnection> Connection;
+            std::unique_ptr<Frpg2UdpPacketStream> Stream;
+            bool Success = true;
+        };
+
+        std::vector<RecievingClient> Clients(ClientCount);
+        for (RecievingClient& Client : Clients)
+        {
+            Client.Connection = std::make_shared<LoopbackConnection>(Datagrams);
+            Client.Stream = std::make_unique<Frpg2UdpPacketStream>(Client.Connection, Key, AUTH_TOKEN);
+        }
+
+        auto PumpClient = [&](size_t Index) {
+            RecievingClient& Client = Clients[Index];
+            Client.Connection->Rewind();
+            Client.Success = !Client.Stream->Pump();
+
+            size_t Recieved = 0;
+            Frpg2UdpPacket Packet;
+            while (Client.Stream->Recieve(&Packet))
+            {
+                Client.Success &= (Packet.Payload.size() == Payload.Size);
+                Recieved++;
+            }
+            Client.Success &= (Recieved == PacketsPerClient);
+        };
+
+        std::vector<size_t> ThreadCounts = { 1, 2, 4 };
+        size_t HardwareThreads = std::thread::hardware_concurrency();
+        if (HardwareThreads > ThreadCounts.back())
+        {
+            ThreadCounts.push_back(HardwareThreads);
+        }
+
+        std::string TickName = StringFormat("%zux%zu", ClientCount, PacketsPerClient);
+        for (size_t ThreadCount : ThreadCounts)
+        {
+            WorkerGroup Workers(ThreadCount - 1);
+
+            Runner.Run("PumpClients", StringFormat("%s/%zut", TickName.c_str(), ThreadCount), ClientCount * PacketsPerClient * Payload.Size, [&]() {
+                Workers.ParallelFor(Clients.size(), PumpClient);
+
+                for (RecievingClient& Client : Clients)
+                {
+                    if (!Client.Success)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            });
+        }
+    }
+
+    void RunRSABenchmarks(BenchmarkRunner& Runner)
+    {
+        RSAKeyPair Key;
+        if (!Key.Generate())
+        {
+            Error("Failed to generate rsa key.");
+            return;
+        }
+
+        // Matches how the login/auth handshakes use it. The server encrypts 
+        // with the private key and decrypts what the client sent with the 
+        // private key.
+        std::shared_ptr<Cipher> ServerEncrypt = std::make_shared<RSACipher>(&Key, RSAPaddingMode::X931, false);
+        std::shared_ptr<Cipher> ServerDecrypt = std::make_shared<RSACipher>(&Key, RSAPaddingMode::PKS1_OAEP, false);
+        std::shared_ptr<Cipher> ClientEncrypt = std::make_shared<RSACipher>(&Key, RSAPaddingMode::PKS1_OAEP, true);
+
+        // RSA only works on a single block, so only the sizes that fit 
+        // with OAEP padding overhead are run.
+        size_t MaxPayloadSize = ServerEncrypt->GetSuffixSize() - 42;
+
+        for (const PayloadSize& Payload : PAYLOAD_SIZES)
+        {
+            if (Payload.Size > MaxPayloadSize)
+            {
+                continue;
+            }
+
+            std::vector<uint8_t> Plaintext = MakePayload(Payload.Size);
+            std::vector<uint8_t> Buffer(Plaintext.size() + ServerEncrypt->GetSuffixSize());
+
+            Runner.Run("RSACipher.Encrypt", Payload.Name, Payload.Size, [&]() {
+                memcpy(Buffer.data(), Plaintext.data(), Plaintext.size());
+                CipherSpan Span = { Buffer.data(), Buffer.size(), 0, Plaintext.size() };
+                return ServerEncrypt->Encrypt(Span);
+            });
+
+            std::vector<uint8_t> Ciphertext = Plaintext;
+            if (!ClientEncrypt->Encrypt(Ciphertext))
+            {
+                Error("Failed to encrypt payload for rsa decrypt benchmark.");
+                continue;
+            }
+
+            std::vector<uint8_t> DecryptBuffer(Ciphertext.size());
+            Runner.Run("RSACipher.Decrypt", Payload.Name, Payload.Size, [&]() {
+                memcpy(DecryptBuffer.data(), Ciphertext.data(), Ciphertext.size());
+                CipherSpan Span = { DecryptBuffer.data(), DecryptBuffer.size(), 0, Ciphertext.size() };
+                return ServerDecrypt->Decrypt(Span);
+            });
+        }
+    }
+
+    // A burst of clients all doing the login/auth handshake at the same time. Each handshake 
+    // decrypts the clients request and encrypts the reply with the servers private key, 
+    // either inline on one thread or through a CipherWorkerPool, polled the same way the 
+    // message streams do it. Time reported is for the whole storm, not a single handshake.
+    void RunLoginStormBenchmarks(BenchmarkRunner& Runner)
+    {
+        const size_t HandshakeCount = 64;
+
+        RSAKeyPair Key;
+        if (!Key.Generate())
+        {
+            Error("Failed to generate rsa key.");
+            return;
+        }
+
+        struct Handshake
+        {
+            std::shared_ptr<Cipher> EncryptCipher;
+            std::shared_ptr<Cipher> DecryptCipher;
+            std::shared_ptr<CipherJob> Job;
+            bool Replied = false;
+        };
+
+        // Each stream has its own ciphers sharing the servers key.
+        std::vector<Handshake> Handshakes(HandshakeCount);
+        for (Handshake& Instance : Handshakes)
+        {
+            Instance.EncryptCipher = std::make_shared<RSACipher>(&Key, RSAPaddingMode::X931, false);
+            Instance.DecryptCipher = std::make_shared<RSACipher>(&Key, RSAPaddingMode::PKS1_OAEP, false);
+        }
+
+        std::shared_ptr<Cipher> ClientEncrypt = std::make_shared<RSACipher>(&Key, RSAPaddingMode::PKS1_OAEP, true);
+
+        std::vector<uint8_t> Request = MakePayload(64);
+        if (!ClientEncrypt->Encrypt(Request))
+        {
+            Error("Failed to encrypt request for login storm benchmark.");
+            return;
+        }
+
+        std::vector<uint8_t> Reply = MakePayload(64);
+        std::string StormName = StringFormat("%zu", HandshakeCount);
+
+        Runner.Run("LoginStorm.Inline", StormName, 0, [&]() {
+            for (Handshake& Instance : Handshakes)
+            {
+                std::vector<uint8_t> Data = Request;
+                if (!Instance.DecryptCipher->Decrypt(Data))
+                {
+                    return false;
+                }
+
+                Data = Reply;
+                if (!Instance.EncryptCipher->Encrypt(Data))
+                {
+                    return false;
+                }
+            }
+            return true;
+        });
+
+        std::vector<size_t> WorkerCounts = { 1, 2, 4 };
+        size_t HardwareThreads = std::thread::hardware_concurrency();
+        if (HardwareThreads > WorkerCounts.back())
+        {
+            WorkerCounts.push_back(HardwareThreads);
+        }
+
+        for (size_t WorkerCount : WorkerCounts)
+        {
+            CipherWorkerPool Pool(WorkerCount, HandshakeCount);
+
+            Runner.Run("LoginStorm.Pool", StringFormat("%s/%zuw", StormName.c_str(), WorkerCount), 0, [&]() {
+                for (Handshake& Instance : Handshakes)
+                {
+                    Instance.Replied = false;
+                    Instance.Job = Pool.Submit(Instance.DecryptCipher, false, std::vector<uint8_t>(Request));
+                    if (!Instance.Job)
+                    {
+                        return false;
+                    }
+                }
+
+                // Reply to each request as soon as its decrypted, like the streams do from their pump.
+                size_t Remaining = Handshakes.size();
+                while (Remaining > 0)
+                {
+                    for (Handshake& Instance : Handshakes)
+                    {
+                        if (!Instance.Job || !Instance.Job->Complete)
+                        {
+                            continue;
+                        }
+                        if (!Instance.Job->Success)
+                        {
+                            return false;
+                        }
+
+                        if (!Instance.Replied)
+                        {
+                            Instance.Replied = true;
+                            Instance.Job = Pool.Submit(Instance.EncryptCipher, true, std::vector<uint8_t>(Reply));
+                            if (!Instance.Job)
+                            {
+                                return false;
+                            }
+                        }
+                        else
+                        {
+                            Instance.Job = nullptr;
+                            Remaining--;
+                        }
+                    }
+
+                    std::this_thread::yield();
+                }
+                return true;
+            });
+        }
+    }
+
+    void RunCompressionBenchmarks(BenchmarkRunner& Runner)
+    {
+        for (const PayloadSize& Payload : PAYLOAD_SIZES)
+        {
+            std::vector<uint8_t> Plaintext = MakePayload(Payload.Size);
+            std::vector<uint8_t> Compressed;
+            std::vector<uint8_t> Decompressed;
+
+            Runner.Run("Compress", Payload.Name, Payload.Size, [&]() {
+                return Compress(Plaintext, Compressed);
+            });
+
+            if (!Compress(Plaintext, Compressed))
+            {
+                Error("Failed to compress payload for decompress benchmark.");
+                continue;
+            }
+
+            Runner.Run("Decompress", Payload.Name, Payload.Size, [&]() {
+                return Decompress(Compressed, Decompressed, (uint32_t)Plaintext.size());
+            });
+        }
+    }
+
+    // Stand-in for a connected game client, only has the ids the lookups use.
+    struct BenchmarkClient
+    {
+        uint32_t PlayerId;
+        std::string SteamId;
+    };
+
+    // Finding clients by player/steam id, a linear scan over every connected client
+    // compared with the indexes the game service keeps.
+    void RunClientLookupBenchmarks(BenchmarkRunner& Runner)
+    {
+        const size_t ClientCount = 10000;
+
+        std::vector<std::shared_ptr<BenchmarkClient>> Clients;
+        ClientIndex<uint32_t, std::shared_ptr<BenchmarkClient>> ClientsByPlayerId;
+        ClientIndex<std::string, std::shared_ptr<BenchmarkClient>> ClientsBySteamId;
+
+        for (size_t i = 0; i < ClientCount; i++)
+        {
+            std::shared_ptr<BenchmarkClient> Client = std::make_shared<BenchmarkClient>();
+            Client->PlayerId = (uint32_t)(i + 1);
+            Client->SteamId = StringFormat("%016llx", 0x0110000100000000ull + i);
+
+            Clients.push_back(Client);
+            ClientsByPlayerId.Add(Client->PlayerId, Client);
+            ClientsBySteamId.Add(Client->SteamId, Client);
+        }
+
+        // Step through the clients in a scattered order so the scans average out to half the list.
+        size_t Next = 0;
+        auto NextTarget = [&]() -> BenchmarkClient& {
+            Next = (Next + 7919) % ClientCount;
+            return *Clients[Next];
+        };
+
+        Runner.Run("ClientsByPlayerId.Scan", "10k", 0, [&]() {
+            uint32_t PlayerId = NextTarget().PlayerId;
+            for (std::shared_ptr<BenchmarkClient>& Client : Clients)
+            {
+                if (Client->PlayerId == PlayerId)
+                {
+                    return true;
+                }
+            }
+            return false;
+        });
+
+        Runner.Run("ClientsByPlayerId.Index", "10k", 0, [&]() {
+            return ClientsByPlayerId.Find(NextTarget().PlayerId) != nullptr;
+        });
+
+        Runner.Run("ClientsBySteamId.Scan", "10k", 0, [&]() {
+            const std::string& SteamId = NextTarget().SteamId;
+            for (std::shared_ptr<BenchmarkClient>& Client : Clients)
+            {
+                if (Client->SteamId == SteamId)
+                {
+                    return true;
+                }
+            }
+            return false;
+        });
+
+        Runner.Run("ClientsBySteamId.Index", "10k", 0, [&]() {
+            return ClientsBySteamId.Find(NextTarget().SteamId) != nullptr;
+        });
+    }
+
+    // Stand-in for a connected game client that has nothing to do, other than being
+    // polled once every idle interval to check for timeouts.
+    struct IdleClient
+    {
+        double NextPollTime = 0.0;
+        bool HasPendingData = false;
+        bool HasPendingWork = false;
+    };
+
+    // The cost of a game service tick when thousands of clients are connected but idle. Checking
+    // every client each tick compared with the scheduler, which only visits the ones that are due.
+    // Time is simulated so each iteration is one 1ms tick, either way about 10 clients get polled.
+    void RunIdleClientBenchmarks(BenchmarkRunner& Runner)
+    {
+        const size_t ClientCount = 10000;
+        const double TickInterval = 0.001;
+        const double IdlePollInterval = 1.0;
+
+        std::vector<std::shared_ptr<IdleClient>> Clients;
+        ClientScheduler<IdleClient> Scheduler;
+        std::vector<std::shared_ptr<IdleClient>> ActiveClients;
+
+        for (size_t i = 0; i < ClientCount; i++)
+        {
+            std::shared_ptr<IdleClient> Client = std::make_shared<IdleClient>();
+            Clients.push_back(Client);
+            Scheduler.Add(Client);
+        }
+
+        // Spread the idle polls evenly over the interval, as they would be once clients 
+        // have been connecting and disconnecting for a while.
+        double CurrentTime = 0.0;
+        Scheduler.BeginTick(CurrentTime, ActiveClients);
+        for (size_t i = 0; i < ActiveClients.size(); i++)
+        {
+            ActiveClients[i]->NextPollTime = CurrentTime + (IdlePollInterval * i) / ClientCount;
+            Scheduler.EndPoll(ActiveClients[i].get(), false, ActiveClients[i]->NextPollTime);
+        }
+
+        Runner.Run("IdleClients.Scan", "10k", 0, [&]() {
+            CurrentTime += TickInterval;
+            for (std::shared_ptr<IdleClient>& Client : Clients)
+            {
+                if (CurrentTime >= Client->NextPollTime || Client->HasPendingData || Client->HasPendingWork)
+                {
+                    Client->NextPollTime = CurrentTime + IdlePollInterval;
+                }
+            }
+            return true;
+        });
+
+        CurrentTime = 0.0;
+        Runner.Run("IdleClients.Scheduler", "10k", 0, [&]() {
+            CurrentTime += TickInterval;
+            Scheduler.BeginTick(CurrentTime, ActiveClients);
+            for (std::shared_ptr<IdleClient>& Client : ActiveClients)
+            {
+                Client->NextPollTime = CurrentTime + IdlePollInterval;
+                Scheduler.EndPoll(Client.get(), Client->HasPendingData || Client->HasPendingWork, Client->NextPollTime);
+            }
+            return ActiveClients.size() < ClientCount;
+        });
+    }
+
+    // Picking a random handful of entries out of a busy area, the way blood messages, bloodstains 
+    // and ghosts are sent out. Shuffling every id in the area compared with the pools partial shuffle.
+    void RunAreaPoolBenchmarks(BenchmarkRunner& Runner)
+    {
+        const uint32_t EntryCount = 10000;
+        const size_t SetSize = 10;
+        const OnlineAreaId AreaId = (OnlineAreaId)1;
+
+        std::unordered_map<uint32_t, std::shared_ptr<uint32_t>> Entries;
+        OnlineAreaPool<uint32_t> Pool;
+        Pool.SetMaxEntriesPerArea(INT_MAX);
+
+        for (uint32_t i = 0; i < EntryCount; i++)
+        {
+            std::shared_ptr<uint32_t> Value = std::make_shared<uint32_t>(i);
+            Entries.insert({ i, Value });
+            Pool.Add(AreaId, i, Value);
+        }
+
+        std::mt19937 RandomGenerator(0);
+
+        Runner.Run("AreaPool.ShuffleAll", "10k", 0, [&]() {
+            std::vector<uint32_t> EntryIds;
+            EntryIds.reserve(Entries.size());
+            for (auto& KeyPair : Entries)
+            {
+                EntryIds.push_back(KeyPair.first);
+            }
+
+            std::shuffle(EntryIds.begin(), EntryIds.end(), RandomGenerator);
+
+            std::vector<std::shared_ptr<uint32_t>> Result;
+            for (size_t i = 0; i < SetSize; i++)
+            {
+                Result.push_back(Entries[EntryIds[i]]);
+            }
+            return Result.size() == SetSize;
+        });
+
+        Runner.Run("AreaPool.RandomSet", "10k", 0, [&]() {
+            return Pool.GetRandomSet(AreaId, (int)SetSize).size() == SetSize;
+        });
+    }
+
+    // Runs a long random sequence of adds, removes and lookups against both the pool and a
+    // simple model of it, a list of live ids per area in the order they were added with the 
+    // oldest dropped past the limit. Every result the pool gives has to agree with the model.
+    void RunAreaPoolModelCheck(BenchmarkRunner& Runner)
+    {
+        const size_t OperationCount = 300000;
+        const size_t MaxEntries = 50;
+        const uint32_t AreaCount = 3;
+        const uint32_t IdCount = 200;
+
+        Runner.Check("AreaPool.ModelCheck", "300k", [&]() {
+            OnlineAreaPool<uint32_t> Pool;
+            Pool.SetMaxEntriesPerArea((int)MaxEntries);
+            Pool.SetRandomSeed(1);
+
+            std::unordered_map<OnlineAreaId, std::deque<uint32_t>> Model;
+            std::mt19937 RandomGenerator(3);
+            size_t Mismatches = 0;
+
+            // Entries dropped for being over the limit should be reported, removed ones shouldn't.
+            std::vector<uint32_t> Trimmed;
+            Pool.SetTrimCallback([&Trimmed](const std::shared_ptr<uint32_t>& Value) {
+                Trimmed.push_back(*Value);
+            });
+
+            for (size_t Operation = 0; Operation < OperationCount; Operation++)
+            {
+                OnlineAreaId AreaId = (OnlineAreaId)(RandomGenerator() % AreaCount + 1);
+                uint32_t Id = RandomGenerator() % IdCount;
+                uint32_t Action = RandomGenerator() % 10;
+
+                std::deque<uint32_t>& Expected = Model[AreaId];
+                auto ExpectedIter = std::find(Expected.begin(), Expected.end(), Id);
+
+                if (Action < 5)
+                {
+                    bool ShouldAdd = (ExpectedIter == Expected.end());
+                    if (Pool.Add(AreaId, Id, std::make_shared<uint32_t>(Id)) != ShouldAdd)
+                    {
+                        Mismatches++;
+                    }
+
+                    std::vector<uint32_t> ExpectedTrimmed;
+                    if (ShouldAdd)
+                    {
+                        Expected.push_back(Id);
+                        if (Expected.size() > MaxEntries)
+                        {
+                            ExpectedTrimmed.push_back(Expected.front());
+                            Expected.pop_front();
+                        }
+                    }
+
+                    if (Trimmed != ExpectedTrimmed)
+                    {
+                        Mismatches++;
+                    }
+                    Trimmed.clear();
+                }
+                else if (Action < 8)
+                {
+                    bool ShouldRemove = (ExpectedIter != Expected.end());
+                    if (Pool.Remove(AreaId, Id) != ShouldRemove || !Trimmed.empty())
+                    {
+                        Mismatches++;
+                    }
+
+                    if (ShouldRemove)
+                    {
+                        Expected.erase(ExpectedIter);
+                    }
+                }
+                else
+                {
+                    // Random sets should be the right size, made of live entries, with no repeats.
+                    size_t MaxCount = RandomGenerator() % 8;
+                    std::vector<std::shared_ptr<uint32_t>> Set = Pool.GetRandomSet(AreaId, (int)MaxCount);
+                    if (Set.size() != std::min(MaxCount, Expected.size()))
+                    {
+                        Mismatches++;
+                    }
+
+                    std::unordered_set<uint32_t> SeenIds;
+                    for (std::shared_ptr<uint32_t>& Value : Set)
+                    {
+                        if (!SeenIds.insert(*Value).second || std::find(Expected.begin(), Expected.end(), *Value) == Expected.end())
+                        {
+                            Mismatches++;
+                        }
+                    }
+
+                    // Recent sets should be every live entry, oldest first.
+                    std::vector<std::shared_ptr<uint32_t>> Recent = Pool.GetRecentSet(AreaId, INT_MAX, [](std::shared_ptr<uint32_t>) { return true; });
+                    if (Recent.size() != Expected.size())
+                    {
+                        Mismatches++;
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i < Recent.size(); i++)
+                        {
+                            if (*Recent[i] != Expected[i])
+                            {
+                                Mismatches++;
+                            }
+                        }
+                    }
+                }
+
+                size_t ExpectedTotal = 0;
+                for (auto& Pair : Model)
+                {
+                    ExpectedTotal += Pair.second.size();
+                }
+                if (Pool.GetTotalEntries() != ExpectedTotal)
+                {
+                    Mismatches++;
+                }
+            }
+
+            if (Mismatches > 0)
+            {
+                Error("Area pool disagreed with the model %zu times.", Mismatches);
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // Checks GetRandomSet picks every entry equally often, both anywhere in the set and as the
+    // first entry, with a chi-square test over a fixed seed. Some entries are removed first so 
+    // the swap-removal has shuffled the order they're stored in.
+    void RunAreaPoolUniformityCheck(BenchmarkRunner& Runner)
+    {
+        const uint32_t AddedCount = 20;
+        const size_t SetSize = 5;
+        const size_t DrawCount = 300000;
+        const OnlineAreaId AreaId = (OnlineAreaId)1;
+
+        // Critical value for 14 degrees of freedom (15 live entries) at p = 0.01.
+        const double ChiSquareThreshold = 29.14;
+
+        auto ChiSquare = [](const std::vector<size_t>& Counts, double Expected) {
+            double Result = 0.0;
+            for (size_t Count : Counts)
+            {
+                double Difference = (double)Count - Expected;
+                Result += (Difference * Difference) / Expected;
+            }
+            return Result;
+        };
+
+        Runner.Check("AreaPool.Uniformity", "15x5", [&]() {
+            OnlineAreaPool<uint32_t> Pool;
+            Pool.SetMaxEntriesPerArea(INT_MAX);
+            Pool.SetRandomSeed(7);
+
+            for (uint32_t i = 0; i < AddedCount; i++)
+            {
+                Pool.Add(AreaId, i, std::make_shared<uint32_t>(i));
+            }
+            for (uint32_t i = 0; i < 10; i += 2)
+            {
+                Pool.Remove(AreaId, i);
+            }
+
+            size_t LiveCount = Pool.GetTotalEntries();
+            std::vector<size_t> PickCounts(AddedCount, 0);
+            std::vector<size_t> FirstCounts(AddedCount, 0);
+
+            for (size_t Draw = 0; Draw < DrawCount; Draw++)
+            {
+                std::vector<std::shared_ptr<uint32_t>> Set = Pool.GetRandomSet(AreaId, (int)SetSize);
+                if (Set.size() != SetSize)
+                {
+                    Error("Random set had %zu entries, expected %zu.", Set.size(), SetSize);
+                    return false;
+                }
+
+                FirstCounts[*Set[0]]++;
+                for (std::shared_ptr<uint32_t>& Value : Set)
+                {
+                    PickCounts[*Value]++;
+                }
+            }
+
+            // Drop the removed ids, they should never have been picked.
+            std::vector<size_t> LivePickCounts;
+            std::vector<size_t> LiveFirstCounts;
+            for (uint32_t i = 0; i < AddedCount; i++)
+            {
+                if (Pool.Contains(AreaId, i))
+                {
+                    LivePickCounts.push_back(PickCounts[i]);
+                    LiveFirstCounts.push_back(FirstCounts[i]);
+                }
+                else if (PickCounts[i] > 0)
+                {
+                    Error("Removed entry %u was picked %zu times.", i, PickCounts[i]);
+                    return false;
+                }
+            }
+
+            double PickChiSquare = ChiSquare(LivePickCounts, (double)(DrawCount * SetSize) / LiveCount);
+            double FirstChiSquare = ChiSquare(LiveFirstCounts, (double)DrawCount / LiveCount);
+            Log("Area pool random set chi-square: %.2f any slot, %.2f first slot, threshold %.2f.", PickChiSquare, FirstChiSquare, ChiSquareThreshold);
+
+            return PickChiSquare <= ChiSquareThreshold && FirstChiSquare <= ChiSquareThreshold;
+        });
+    }
+
+    // Runs a login query from a game tick with the database thread stalling every query to emulate 
+    // a slow disk. Blocking waits for the result in the tick, as the handlers used to, while deferred
+    // only queues it and picks up the result from a later tick, so should stay flat.
+    void RunSlowDatabaseBenchmarks(BenchmarkRunner& Runner)
+    {
+        const double SlowQueryTime = 20.0;
+
+        std::filesystem::path DatabasePath = std::filesystem::temp_directory_path() / "ds3os_benchmark.sqlite";
+        std::filesystem::remove(DatabasePath);
+
+        ServerDatabase Database;
+        if (!Database.Open(DatabasePath))
+        {
+            Error("Failed to open benchmark database.");
+            return;
+        }
+
+        {
+            DatabaseExecutor Executor(Database);
+            Executor.SetEmulatedQueryTime(SlowQueryTime);
+
+            auto QueueLogin = [&Executor](bool& InFlight) {
+                InFlight = true;
+                Executor.Run(
+                    [](ServerDatabase& Database) {
+                        uint32_t PlayerId = 0;
+                        Database.FindOrCreatePlayer("Benchmark", PlayerId);
+                        return PlayerId;
+                    },
+                    [&InFlight](uint32_t) {
+                        InFlight = false;
+                    }
+                );
+            };
+
+            Runner.Run("SlowDatabase.Blocking", "20ms", 0, [&]() {
+                bool InFlight = false;
+                QueueLogin(InFlight);
+                while (InFlight)
+                {
+                    Executor.Poll();
+                    std::this_thread::yield();
+                }
+                return true;
+            });
+
+            // Only one query is kept in flight, otherwise thousands of ticks worth would be
+            // left queued for the worker to drain when the executor is destroyed.
+            bool InFlight = false;
+            Runner.Run("SlowDatabase.Deferred", "20ms", 0, [&]() {
+                if (!InFlight)
+                {
+                    QueueLogin(InFlight);
+                }
+                Executor.Poll();
+                return true;
+            });
+
+            while (InFlight)
+            {
+                Executor.Poll();
+                std::this_thread::yield();
+            }
+        }
+
+        Database.Close();
+        std::filesystem::remove(DatabasePath);
+    }
+
+    // Gets the value of an argument in the form -name=value, or the default if not provided.
+    std::string GetArgument(int argc, char* argv[], const std::string& Name, const std::string& Default)
+    {
+        std::string Prefix = "-" + Name + "=";
+        for (int i = 1; i < argc; i++)
+        {
+            if (strncmp(argv[i], Prefix.c_str(), Prefix.size()) == 0)
+            {
+                return argv[i] + Prefix.size();
+            }
+        }
+        return Default;
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    std::string Format = GetArgument(argc, argv, "format", "text");
+    std::string Filter = GetArgument(argc, argv, "filter", "");
+    double MinSecondsPerCase = atof(GetArgument(argc, argv, "min_time", "0.5").c_str());
+
+    if (Format != "text" && Format != "csv" && Format != "json")
+    {
+        Error("Unknown output format '%s', expected text, csv or json.", Format.c_str());
+        return 1;
+    }
+
+    if (!PlatformInit())
+    {
+        Error("Failed to initialize platform specific functionality.");
+        return 1;
+    }
+
+    BenchmarkRunner Runner(MinSecondsPerCase, Filter);
+    RunCWCBenchmarks(Runner);
+    RunCWCChecks(Runner);
+    RunRandomBenchmarks(Runner);
+    RunRandomChecks(Runner);
+    RunBatchedEncryptBenchmarks(Runner);
+    RunRecieveBenchmarks(Runner);
+    RunRSABenchmarks(Runner);
+    RunLoginStormBenchmarks(Runner);
+    RunCompressionBenchmarks(Runner);
+    RunClientLookupBenchmarks(Runner);
+    RunIdleClientBenchmarks(Runner);
+    RunAreaPoolBenchmarks(Runner);
+    RunAreaPoolModelCheck(Runner);
+    RunAreaPoolUniformityCheck(Runner);
+    RunSlowDatabaseBenchmarks(Runner);
+
+    if (Format == "csv")
+    {
+        WriteResultsAsCsv(Runner.GetResults());
+    }
+    else if (Format == "json")
+    {
+        WriteResultsAsJson(Runner.GetResults());
+    }
+    else
+    {
+        WriteResultsAsText(Runner.GetResults());
+    }
+
+    if (!PlatformTerm())
+    {
+        Error("Failed to tidy up platform specific functionality.");
+        return 1;
+    }
+
+    return Runner.HasFailures() ? 1 : 0;
+}
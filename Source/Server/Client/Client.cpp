@@ -340,7 +340,8 @@ void Client::Handle_AuthServer_RequestHandshake()
     WaitForNextMessage(AuthServerConnection, AuthServerMessageStream, KeyExchangeResponse);
     Ensure(KeyExchangeResponse.Payload.size() == 27);
 
-    AuthServerMessageStream->SetCipher(std::make_shared<CWCCipher>(CwcKey), std::make_shared<CWCCipher>(CwcKey));
+    std::shared_ptr<CWCKeySchedule> KeySchedule = std::make_shared<CWCKeySchedule>(CwcKey);
+    AuthServerMessageStream->SetCipher(std::make_shared<CWCCipher>(KeySchedule), std::make_shared<CWCCipher>(KeySchedule));
 
     ChangeState(ClientState::AuthServer_RequestServiceStatus);
 
@@ -25,12 +25,60 @@ public:
     // How many seconds without messages causes a client to timeout.
     inline static const double CLIENT_TIMEOUT = 60.0;
 
+    // How often clients that have nothing to do are polled anyway, to check 
+    // timeouts and the like.
+    inline static const double IDLE_CLIENT_POLL_INTERVAL = 1.0;
+
     // How many seconds without refresh before an authentication ticket expires.
     inline static const double AUTH_TICKET_TIMEOUT = 30.0;
 
+    // How often expired authentication tickets are cleaned up, in seconds.
+    inline static const double AUTH_TICKET_EXPIRY_INTERVAL = 1.0;
+
     // Maximum length of a packet in an Frpg2PacketStream.
     inline static const int MAX_PACKET_LENGTH = 8192;
 
+    // Number of threads used to run the rsa operations for login and auth handshakes.
+    inline static const size_t HANDSHAKE_WORKER_COUNT = 2;
+
+    // Maximum number of handshake rsa operations that can be queued before new 
+    // handshakes are shed (disconnected) rather than stalling everyone else.
+    inline static const size_t MAX_QUEUED_HANDSHAKE_OPERATIONS = 64;
+
+    // Number of extra threads the game service uses for the per-client network work
+    // each tick; recieving and decrypting incoming packets and encrypting outgoing 
+    // ones (the main thread also does its share).
+    inline static const size_t NETWORK_WORKER_COUNT = 3;
+
+
+    // Number of datagrams that can be queued in each direction between the udp io
+    // thread and the game thread. Anything over this is dropped.
+    inline static const size_t UDP_IO_QUEUE_CAPACITY = 16 * 1024;
+
+    // How long the udp io thread waits in select for a datagram to arrive before checking 
+    // its queues again, in microseconds. Queued sends wake it early, so this only adds
+    // send latency if the loopback wake socket couldn't be created.
+    inline static const int UDP_IO_WAIT_INTERVAL_US = 1000;
+
+    // Minimum time between warnings about the udp recieve queue filling up.
+    inline static const double UDP_IO_QUEUE_WARNING_INTERVAL = 10.0;
+
+    // Minimum number of connected clients before pumping their connections is spread
+    // across the network workers rather than done inline.
+    inline static const size_t MIN_CLIENTS_FOR_PARALLEL_RECIEVE = 8;
+
+    // Minimum number of clients with packets to send in a tick before their 
+    // encryption is spread across the send workers rather than done inline.
+    inline static const size_t MIN_STREAMS_FOR_PARALLEL_ENCRYPTION = 8;
+
+    // How many bytes each threads random generator produces before it mixes in
+    // fresh entropy from the system.
+    inline static const size_t RANDOM_RESEED_INTERVAL = 1024 * 1024;
+
+    // How many soul levels each bucket covers in the indexes used to find invasion 
+    // and visitor targets. Searches visit the nearest buckets first.
+    inline static const int MATCHMAKING_SOUL_LEVEL_BUCKET_SIZE = 10;
+
     // Maximum backlog of data in a packet streams send queue. Sending
     // packets beyond this will result in disconnect.
     inline static const int MAX_SEND_QUEUE_SIZE = 256 * 1024;
@@ -75,6 +123,13 @@ public:
     inline static const double SPIKE_LENGTH_MIN = 1000.0 * 5.0;
     inline static const double SPIKE_LENGTH_MAX = 1000.0 * 20.0;
 
+    // Emulates a slow disk by stalling every query on the database thread, to check the
+    // server loop isn't waiting on any of them. The stall happens before the database is
+    // locked, so anything else using it isn't held up.
+    inline static const bool EMULATE_SLOW_DATABASE = false;
+
+    inline static const double SLOW_DATABASE_QUERY_TIME = 50.0;
+
     // Emulates dropped udp packets.
     inline static const bool EMULATE_DROPPED_PACKETS = false;
 
@@ -15,54 +15,60 @@
 #include "Core/Utils/Strings.h"
 
 CWCCipher::CWCCipher(const std::vector<uint8_t>& InKey)
-    : Key(InKey)
+    : CWCCipher(std::make_shared<CWCKeySchedule>(InKey))
 {
-    cwc_init_and_key(InKey.data(), (unsigned long)InKey.size(), &CwcContext);
 }
 
-bool CWCCipher::Encrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+CWCCipher::CWCCipher(std::shared_ptr<const CWCKeySchedule> InKeySchedule)
+    : KeySchedule(InKeySchedule)
 {
-    std::vector<uint8_t> IV(11, 0);
-    std::vector<uint8_t> Tag(16, 0);
-    std::vector<uint8_t> Payload = Input;
-
-    FillRandomBytes(IV);
+    KeySchedule->InitContext(CwcContext);
+}
 
-    if (cwc_encrypt_message(IV.data(), 11, IV.data(), 11, (unsigned char*)Payload.data(), (unsigned long)Payload.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+bool CWCCipher::Encrypt(CipherSpan& Span)
+{
+    if (Span.Offset < GetPrefixSize())
     {
         return false;
     }
 
-    Output.resize(Payload.size() + 11 + 16);
+    uint8_t* Payload = Span.Data();
+    uint8_t* Tag = Payload - TAG_LENGTH;
+    uint8_t* IV = Tag - IV_LENGTH;
+
+    FillRandomBytes(IV, (int)IV_LENGTH);
+
+    if (cwc_encrypt_message(IV, IV_LENGTH, IV, IV_LENGTH, Payload, (unsigned long)Span.Length, Tag, TAG_LENGTH, &CwcContext) == RETURN_ERROR)
+    {
+        return false;
+    }
 
-    memcpy(Output.data(), IV.data(), 11);
-    memcpy(Output.data() + 11, Tag.data(), 16);
-    memcpy(Output.data() + 11 + 16, Payload.data(), Payload.size());
+    Span.Offset -= GetPrefixSize();
+    Span.Length += GetPrefixSize();
 
     return true;
 }
 
-bool CWCCipher::Decrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+bool CWCCipher::Decrypt(CipherSpan& Span)
 {
-    std::vector<uint8_t> IV(11);
-    std::vector<uint8_t> Tag(16);
-    
     // Actually enough data for any data?
-    if (Input.size() < 11 + 16 + 1)
+    if (Span.Length < IV_LENGTH + TAG_LENGTH + 1)
     {
         return false;
     }
 
-    Output.resize(Input.size() - 11 - 16);
+    uint8_t* IV = Span.Data();
+    uint8_t* Tag = IV + IV_LENGTH;
+    uint8_t* Payload = Tag + TAG_LENGTH;
+    size_t PayloadLength = Span.Length - GetPrefixSize();
 
-    memcpy(IV.data(), Input.data(), 11);
-    memcpy(Tag.data(), Input.data() + 11, 16);
-    memcpy(Output.data(), Input.data() + 11 + 16, Output.size());
-
-    if (cwc_decrypt_message(IV.data(), 11, IV.data(), 11, (unsigned char*)Output.data(), (unsigned long)Output.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+    if (cwc_decrypt_message(IV, IV_LENGTH, IV, IV_LENGTH, Payload, (unsigned long)PayloadLength, Tag, TAG_LENGTH, &CwcContext) == RETURN_ERROR)
     {
         return false;
     }
 
+    Span.Offset += GetPrefixSize();
+    Span.Length = PayloadLength;
+
     return true;
 }
@@ -14,88 +14,92 @@
 #include "Core/Utils/Endian.h"
 #include "Core/Utils/Strings.h"
 
+#include <cstring>
+
 // Basically the same as CWCCipher except we include a packet-type and auth token.
 
 CWCClientUDPCipher::CWCClientUDPCipher(const std::vector<uint8_t>& InKey, uint64_t InAuthToken)
-    : Key(InKey)
+    : CWCClientUDPCipher(std::make_shared<CWCKeySchedule>(InKey), InAuthToken)
+{
+}
+
+CWCClientUDPCipher::CWCClientUDPCipher(std::shared_ptr<const CWCKeySchedule> InKeySchedule, uint64_t InAuthToken)
+    : KeySchedule(InKeySchedule)
     , AuthToken(InAuthToken)
 {
-    cwc_init_and_key(InKey.data(), (unsigned long)InKey.size(), &CwcContext);
+    KeySchedule->InitContext(CwcContext);
 
     // Auth token bytes to encode in the header are the reversed auth token.
     uint8_t* InAuthTokenBytes = reinterpret_cast<uint8_t*>(&InAuthToken);
     AuthTokenHeaderBytes.assign(InAuthTokenBytes, InAuthTokenBytes + 8);
 }
 
-bool CWCClientUDPCipher::Encrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+bool CWCClientUDPCipher::Encrypt(CipherSpan& Span)
 {
-    std::vector<uint8_t> AuthToken = AuthTokenHeaderBytes;
-    std::vector<uint8_t> IV(11, 0);
-    std::vector<uint8_t> Tag(16, 0);
-    std::vector<uint8_t> Payload = Input;
-    std::vector<uint8_t> PacketType = { (uint8_t)PacketsHaveConnectionPrefix };
+    if (Span.Offset < GetPrefixSize())
+    {
+        return false;
+    }
+
+    uint8_t* Payload = Span.Data();
+    uint8_t* PacketType = Payload - PACKET_TYPE_LENGTH;
+    uint8_t* Tag = PacketType - TAG_LENGTH;
+    uint8_t* IV = Tag - IV_LENGTH;
+    uint8_t* AuthTokenBytes = IV - AUTH_TOKEN_LENGTH;
 
-    FillRandomBytes(IV);
+    memcpy(AuthTokenBytes, AuthTokenHeaderBytes.data(), AUTH_TOKEN_LENGTH);
+    FillRandomBytes(IV, (int)IV_LENGTH);
+    *PacketType = (uint8_t)PacketsHaveConnectionPrefix;
 
     // TODO: I have the distinct feeling this is different when replying as the packet type
     //       doesn't get sent when going server->client ...
-    std::vector<uint8_t> Header;
-    Header.resize(20);
-    memcpy(Header.data(), IV.data(), 11);
-    memcpy(Header.data() + 11, AuthToken.data(), 8);
-    memcpy(Header.data() + 19, PacketType.data(), 1);
+    uint8_t Header[HEADER_LENGTH];
+    memcpy(Header, IV, IV_LENGTH);
+    memcpy(Header + IV_LENGTH, AuthTokenBytes, AUTH_TOKEN_LENGTH);
+    memcpy(Header + IV_LENGTH + AUTH_TOKEN_LENGTH, PacketType, PACKET_TYPE_LENGTH);
 
-    if (cwc_encrypt_message(IV.data(), 11, Header.data(), (unsigned long)Header.size(), (unsigned char*)Payload.data(), (unsigned long)Payload.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+    if (cwc_encrypt_message(IV, IV_LENGTH, Header, HEADER_LENGTH, Payload, (unsigned long)Span.Length, Tag, TAG_LENGTH, &CwcContext) == RETURN_ERROR)
     {
         return false;
     }
 
-    Output.resize(Payload.size() + 8 + 11 + 16 + 1);
-
-    memcpy(Output.data(), AuthToken.data(), 8);
-    memcpy(Output.data() + 8, IV.data(), 11);
-    memcpy(Output.data() + 8 + 11, Tag.data(), 16);
-    memcpy(Output.data() + 8 + 11 + 16, PacketType.data(), 1);
-    memcpy(Output.data() + 8 + 11 + 16 + 1, Payload.data(), Payload.size());
+    //Log("EncryptClient: PayloadSize=%i PacketType=%i", Span.Length, *PacketType);
 
-    //Log("EncryptClient: PayloadSize=%i IV=%s Tag=%s Header=%s PacketType=%i", Payload.size(), BytesToHex(IV).c_str(), BytesToHex(Tag).c_str(), BytesToHex(Header).c_str(), PacketType[0]);
+    Span.Offset -= GetPrefixSize();
+    Span.Length += GetPrefixSize();
 
     return true;
 }
 
-bool CWCClientUDPCipher::Decrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+bool CWCClientUDPCipher::Decrypt(CipherSpan& Span)
 {
-    std::vector<uint8_t> AuthToken(8);
-    std::vector<uint8_t> IV(11);
-    std::vector<uint8_t> Tag(16);
-    std::vector<uint8_t> PacketType(1);
-
     // Actually enough data for any data?
-    if (Input.size() < 8 + 11 + 16 + 1 + 1)
+    if (Span.Length < AUTH_TOKEN_LENGTH + IV_LENGTH + TAG_LENGTH + PACKET_TYPE_LENGTH + 1)
     {
         return false;
     }
 
-    Output.resize(Input.size() - 8 - 11 - 16 - 1);
-
-    memcpy(AuthToken.data(), Input.data(), 8);
-    memcpy(IV.data(), Input.data() + 8, 11);
-    memcpy(Tag.data(), Input.data() + 8 + 11, 16);
-    memcpy(PacketType.data(), Input.data() + 8 + 11 + 16, 1);
-    memcpy(Output.data(), Input.data() + 8 + 11 + 16 + 1, Output.size());
+    uint8_t* AuthTokenBytes = Span.Data();
+    uint8_t* IV = AuthTokenBytes + AUTH_TOKEN_LENGTH;
+    uint8_t* Tag = IV + IV_LENGTH;
+    uint8_t* PacketType = Tag + TAG_LENGTH;
+    uint8_t* Payload = PacketType + PACKET_TYPE_LENGTH;
+    size_t PayloadLength = Span.Length - GetPrefixSize();
 
-    std::vector<uint8_t> Header;
-    Header.resize(20);
-    memcpy(Header.data(), IV.data(), 11);
-    memcpy(Header.data() + 11, AuthToken.data(), 8);
-    memcpy(Header.data() + 19, PacketType.data(), 1);
+    uint8_t Header[HEADER_LENGTH];
+    memcpy(Header, IV, IV_LENGTH);
+    memcpy(Header + IV_LENGTH, AuthTokenBytes, AUTH_TOKEN_LENGTH);
+    memcpy(Header + IV_LENGTH + AUTH_TOKEN_LENGTH, PacketType, PACKET_TYPE_LENGTH);
 
-    //Log("DecryptClient: PayloadSize=%i IV=%s Tag=%s Header=%s PacketType=%i", Output.size(), BytesToHex(IV).c_str(), BytesToHex(Tag).c_str(), BytesToHex(Header).c_str(), PacketType[0]);
+    //Log("DecryptClient: PayloadSize=%i PacketType=%i", PayloadLength, *PacketType);
 
-    if (cwc_decrypt_message(IV.data(), 11, Header.data(), (unsigned long)Header.size(), (unsigned char*)Output.data(), (unsigned long)Output.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+    if (cwc_decrypt_message(IV, IV_LENGTH, Header, HEADER_LENGTH, Payload, (unsigned long)PayloadLength, Tag, TAG_LENGTH, &CwcContext) == RETURN_ERROR)
     {
         return false;
     }
 
+    Span.Offset += GetPrefixSize();
+    Span.Length = PayloadLength;
+
     return true;
 }
@@ -10,10 +10,14 @@
 #pragma once
 
 #include "Core/Crypto/Cipher.h"
+#include "Core/Crypto/CWCKeySchedule.h"
 
 #include "cwc.h"
 
 #include <vector>
+#include <memory>
+
+// Encrypted layout is: AuthToken (8 bytes) | IV (11 bytes) | Tag (16 bytes) | PacketType (1 byte) | Payload
 
 class CWCClientUDPCipher
     : public Cipher
@@ -21,14 +25,26 @@ class CWCClientUDPCipher
 public:
 
     CWCClientUDPCipher(const std::vector<uint8_t>& key, uint64_t AuthToken);
+    CWCClientUDPCipher(std::shared_ptr<const CWCKeySchedule> KeySchedule, uint64_t AuthToken);
+
+    size_t GetPrefixSize() override { return AUTH_TOKEN_LENGTH + IV_LENGTH + TAG_LENGTH + PACKET_TYPE_LENGTH; }
+    size_t GetSuffixSize() override { return 0; }
 
-    bool Encrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) override;
-    bool Decrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) override;
+    bool Encrypt(CipherSpan& Span) override;
+    bool Decrypt(CipherSpan& Span) override;
 
     void SetPacketsHaveConnectionPrefix(bool value) { PacketsHaveConnectionPrefix = value; }
 
 private:
-    std::vector<uint8_t> Key;
+    inline static const size_t AUTH_TOKEN_LENGTH = 8;
+    inline static const size_t IV_LENGTH = 11;
+    inline static const size_t TAG_LENGTH = 16;
+    inline static const size_t PACKET_TYPE_LENGTH = 1;
+
+    // Authenticated header is: IV | AuthToken | PacketType
+    inline static const size_t HEADER_LENGTH = IV_LENGTH + AUTH_TOKEN_LENGTH + PACKET_TYPE_LENGTH;
+
+    std::shared_ptr<const CWCKeySchedule> KeySchedule;
 
     cwc_ctx CwcContext;
     
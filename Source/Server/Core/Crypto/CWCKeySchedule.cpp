@@ -0,0 +1,23 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Crypto/CWCKeySchedule.h"
+
+#include <cstring>
+
+CWCKeySchedule::CWCKeySchedule(const std::vector<uint8_t>& InKey)
+    : Key(InKey)
+{
+    cwc_init_and_key(Key.data(), (unsigned long)Key.size(), &KeyedContext);
+}
+
+void CWCKeySchedule::InitContext(cwc_ctx& Context) const
+{
+    memcpy(&Context, &KeyedContext, sizeof(cwc_ctx));
+}
@@ -0,0 +1,39 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include "cwc.h"
+
+#include <vector>
+
+// Expanded form of a CWC key (the AES key schedule and the hash key). Expanding
+// a key is the only expensive part of setting up a CWC cipher, so it's done once 
+// and shared between every cipher using the same key.
+//
+// Ciphers still keep their own context for the per-message state, so ciphers
+// sharing a schedule can be used on different threads.
+
+class CWCKeySchedule
+{
+public:
+    CWCKeySchedule(const std::vector<uint8_t>& Key);
+
+    // Sets up a context ready to encrypt/decrypt with this key. This is just
+    // a copy of the precomputed state.
+    void InitContext(cwc_ctx& Context) const;
+
+    const std::vector<uint8_t>& GetKey() const { return Key; }
+
+private:
+    std::vector<uint8_t> Key;
+
+    cwc_ctx KeyedContext;
+
+};
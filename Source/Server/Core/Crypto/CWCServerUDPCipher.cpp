@@ -14,74 +14,75 @@
 #include "Core/Utils/Endian.h"
 #include "Core/Utils/Strings.h"
 
+#include <cstring>
+
 // Basically the same as CWCCipher except for different header verification.
 
 CWCServerUDPCipher::CWCServerUDPCipher(const std::vector<uint8_t>& InKey, uint64_t InAuthToken)
-    : Key(InKey)
+    : CWCServerUDPCipher(std::make_shared<CWCKeySchedule>(InKey), InAuthToken)
+{
+}
+
+CWCServerUDPCipher::CWCServerUDPCipher(std::shared_ptr<const CWCKeySchedule> InKeySchedule, uint64_t InAuthToken)
+    : KeySchedule(InKeySchedule)
     , AuthToken(InAuthToken)
 {
-    cwc_init_and_key(InKey.data(), (unsigned long)InKey.size(), &CwcContext);
+    KeySchedule->InitContext(CwcContext);
 
     // Auth token bytes to encode in the header are the reversed auth token.
     uint8_t* InAuthTokenBytes = reinterpret_cast<uint8_t*>(&InAuthToken);
     AuthTokenHeaderBytes.assign(InAuthTokenBytes, InAuthTokenBytes + 8);
 }
 
-bool CWCServerUDPCipher::Encrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+bool CWCServerUDPCipher::Encrypt(CipherSpan& Span)
 {
-    std::vector<uint8_t> IV(11, 0);
-    std::vector<uint8_t> Tag(16, 0);
-    std::vector<uint8_t> Payload = Input;
+    if (Span.Offset < GetPrefixSize())
+    {
+        return false;
+    }
 
-    FillRandomBytes(IV);
+    uint8_t* Payload = Span.Data();
+    uint8_t* Tag = Payload - TAG_LENGTH;
+    uint8_t* IV = Tag - IV_LENGTH;
 
-    std::vector<uint8_t> Header;
-    Header.resize(11);
-    memcpy(Header.data(), IV.data(), 11);
+    FillRandomBytes(IV, (int)IV_LENGTH);
 
-    if (cwc_encrypt_message(IV.data(), 11, Header.data(), (unsigned long)Header.size(), (unsigned char*)Payload.data(), (unsigned long)Payload.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+    // The header is just the IV, so it can be authenticated straight out of the buffer.
+    if (cwc_encrypt_message(IV, IV_LENGTH, IV, IV_LENGTH, Payload, (unsigned long)Span.Length, Tag, TAG_LENGTH, &CwcContext) == RETURN_ERROR)
     {
         return false;
     }
 
-    Output.resize(Payload.size() + 11 + 16);
-
-    memcpy(Output.data(), IV.data(), 11);
-    memcpy(Output.data() + 11, Tag.data(), 16);
-    memcpy(Output.data() + 11 + 16, Payload.data(), Payload.size());
+    //Log("EncryptServer: PayloadSize=%i", Span.Length);
 
-    //Log("EncryptServer: PayloadSize=%i IV=%s Tag=%s Header=%s", Payload.size(), BytesToHex(IV).c_str(), BytesToHex(Tag).c_str(), BytesToHex(Header).c_str());
+    Span.Offset -= GetPrefixSize();
+    Span.Length += GetPrefixSize();
 
     return true;
 }
 
-bool CWCServerUDPCipher::Decrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+bool CWCServerUDPCipher::Decrypt(CipherSpan& Span)
 {
-    std::vector<uint8_t> IV(11);
-    std::vector<uint8_t> Tag(16);
-
     // Actually enough data for any data?
-    if (Input.size() < 11 + 16 + 1)
+    if (Span.Length < IV_LENGTH + TAG_LENGTH + 1)
     {
         return false;
     }
 
-    Output.resize(Input.size() - 11 - 16);
+    uint8_t* IV = Span.Data();
+    uint8_t* Tag = IV + IV_LENGTH;
+    uint8_t* Payload = Tag + TAG_LENGTH;
+    size_t PayloadLength = Span.Length - GetPrefixSize();
 
-    memcpy(IV.data(), Input.data(), 11);
-    memcpy(Tag.data(), Input.data() + 11, 16);
-    memcpy(Output.data(), Input.data() + 11 + 16, Output.size());
+    //Log("DecryptServer: PayloadSize=%i", PayloadLength);
 
-    std::vector<uint8_t> Header;
-    Header.resize(11);
-    memcpy(Header.data(), IV.data(), 11);
-
-    //Log("DecryptServer: PayloadSize=%i IV=%s Tag=%s Header=%s", Output.size(), BytesToHex(IV).c_str(), BytesToHex(Tag).c_str(), BytesToHex(Header).c_str());
-
-    if (cwc_decrypt_message(IV.data(), 11, Header.data(), (unsigned long)Header.size(), (unsigned char*)Output.data(), (unsigned long)Output.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+    if (cwc_decrypt_message(IV, IV_LENGTH, IV, IV_LENGTH, Payload, (unsigned long)PayloadLength, Tag, TAG_LENGTH, &CwcContext) == RETURN_ERROR)
     {
         return false;
     }
 
+    Span.Offset += GetPrefixSize();
+    Span.Length = PayloadLength;
+
     return true;
 }
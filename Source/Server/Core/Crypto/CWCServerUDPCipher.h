@@ -10,10 +10,14 @@
 #pragma once
 
 #include "Core/Crypto/Cipher.h"
+#include "Core/Crypto/CWCKeySchedule.h"
 
 #include "cwc.h"
 
 #include <vector>
+#include <memory>
+
+// Encrypted layout is: IV (11 bytes) | Tag (16 bytes) | Payload
 
 class CWCServerUDPCipher
     : public Cipher
@@ -21,12 +25,19 @@ class CWCServerUDPCipher
 public:
 
     CWCServerUDPCipher(const std::vector<uint8_t>& key, uint64_t AuthToken);
+    CWCServerUDPCipher(std::shared_ptr<const CWCKeySchedule> KeySchedule, uint64_t AuthToken);
+
+    size_t GetPrefixSize() override { return IV_LENGTH + TAG_LENGTH; }
+    size_t GetSuffixSize() override { return 0; }
 
-    bool Encrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) override;
-    bool Decrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) override;
+    bool Encrypt(CipherSpan& Span) override;
+    bool Decrypt(CipherSpan& Span) override;
 
 private:
-    std::vector<uint8_t> Key;
+    inline static const size_t IV_LENGTH = 11;
+    inline static const size_t TAG_LENGTH = 16;
+
+    std::shared_ptr<const CWCKeySchedule> KeySchedule;
 
     cwc_ctx CwcContext;
     
@@ -0,0 +1,62 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Crypto/Cipher.h"
+
+#include <cstring>
+
+bool Cipher::Encrypt(std::vector<uint8_t>& Buffer)
+{
+    size_t PrefixSize = GetPrefixSize();
+    size_t PayloadSize = Buffer.size();
+
+    Buffer.resize(PrefixSize + PayloadSize + GetSuffixSize());
+    memmove(Buffer.data() + PrefixSize, Buffer.data(), PayloadSize);
+
+    CipherSpan Span;
+    Span.Buffer = Buffer.data();
+    Span.Capacity = Buffer.size();
+    Span.Offset = PrefixSize;
+    Span.Length = PayloadSize;
+
+    if (!Encrypt(Span))
+    {
+        return false;
+    }
+
+    if (Span.Offset > 0)
+    {
+        memmove(Buffer.data(), Span.Data(), Span.Length);
+    }
+    Buffer.resize(Span.Length);
+
+    return true;
+}
+
+bool Cipher::Decrypt(std::vector<uint8_t>& Buffer)
+{
+    CipherSpan Span;
+    Span.Buffer = Buffer.data();
+    Span.Capacity = Buffer.size();
+    Span.Offset = 0;
+    Span.Length = Buffer.size();
+
+    if (!Decrypt(Span))
+    {
+        return false;
+    }
+
+    if (Span.Offset > 0)
+    {
+        memmove(Buffer.data(), Span.Data(), Span.Length);
+    }
+    Buffer.resize(Span.Length);
+
+    return true;
+}
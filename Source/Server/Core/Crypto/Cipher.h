@@ -10,6 +10,21 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Region of a caller owned buffer that a cipher transforms in place. The payload 
+// occupies [Offset, Offset + Length), the rest of the buffer up to Capacity is 
+// free room the cipher can write its framing (iv, tag, etc) into.
+struct CipherSpan
+{
+    uint8_t* Buffer = nullptr;
+    size_t Capacity = 0;
+    size_t Offset = 0;
+    size_t Length = 0;
+
+    uint8_t* Data() const { return Buffer + Offset; }
+};
 
 class Cipher
 {
@@ -17,7 +32,22 @@ public:
 
     virtual ~Cipher() { }
 
-    virtual bool Encrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) = 0;
-    virtual bool Decrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) = 0;
+    // Amount of room that needs to be reserved before and after the payload
+    // for encryption to be done in place.
+    virtual size_t GetPrefixSize() = 0;
+    virtual size_t GetSuffixSize() = 0;
+
+    // Encrypts the payload in place. On success the span is updated to cover
+    // the encrypted output including any framing the cipher added.
+    virtual bool Encrypt(CipherSpan& Span) = 0;
+
+    // Decrypts the payload in place. On success the span is updated to cover
+    // only the decrypted payload.
+    virtual bool Decrypt(CipherSpan& Span) = 0;
+
+    // Helpers that transform an entire vector in place. These only allocate if 
+    // the vector doesn't have the capacity to hold the framing.
+    bool Encrypt(std::vector<uint8_t>& Buffer);
+    bool Decrypt(std::vector<uint8_t>& Buffer);
 
 };
@@ -0,0 +1,92 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Crypto/CipherWorkerPool.h"
+#include "Core/Crypto/Cipher.h"
+
+CipherWorkerPool::CipherWorkerPool(size_t WorkerCount, size_t InMaxQueueDepth)
+    : MaxQueueDepth(InMaxQueueDepth)
+{
+    for (size_t i = 0; i < WorkerCount; i++)
+    {
+        Workers.push_back(std::thread([this]() { WorkerMain(); }));
+    }
+}
+
+CipherWorkerPool::~CipherWorkerPool()
+{
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        Quit = true;
+    }
+    QueueSignal.notify_all();
+
+    for (std::thread& Worker : Workers)
+    {
+        Worker.join();
+    }
+}
+
+std::shared_ptr<CipherJob> CipherWorkerPool::Submit(std::shared_ptr<Cipher> JobCipher, bool Encrypt, std::vector<uint8_t>&& Data)
+{
+    std::shared_ptr<CipherJob> Job = std::make_shared<CipherJob>();
+    Job->JobCipher = JobCipher;
+    Job->Encrypt = Encrypt;
+    Job->Data = std::move(Data);
+
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        if (Queue.size() >= MaxQueueDepth)
+        {
+            return nullptr;
+        }
+        Queue.push_back(Job);
+    }
+    QueueSignal.notify_one();
+
+    return Job;
+}
+
+size_t CipherWorkerPool::GetQueueDepth()
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    return Queue.size();
+}
+
+void CipherWorkerPool::WorkerMain()
+{
+    while (true)
+    {
+        std::shared_ptr<CipherJob> Job;
+
+        {
+            std::unique_lock<std::mutex> Lock(QueueMutex);
+            QueueSignal.wait(Lock, [this]() { return Quit || !Queue.empty(); });
+
+            if (Quit)
+            {
+                return;
+            }
+
+            Job = Queue.front();
+            Queue.pop_front();
+        }
+
+        if (Job->Encrypt)
+        {
+            Job->Success = Job->JobCipher->Encrypt(Job->Data);
+        }
+        else
+        {
+            Job->Success = Job->JobCipher->Decrypt(Job->Data);
+        }
+
+        Job->Complete = true;
+    }
+}
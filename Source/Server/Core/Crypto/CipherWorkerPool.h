@@ -0,0 +1,68 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+class Cipher;
+
+// A single encrypt/decrypt operation queued on a CipherWorkerPool. This is owned 
+// by both the submitter and the pool, so the submitter is free to go away
+// while the operation is still in flight.
+struct CipherJob
+{
+    std::shared_ptr<Cipher> JobCipher;
+    bool Encrypt = false;
+
+    // Input data, replaced with the output once the job is complete.
+    std::vector<uint8_t> Data;
+
+    bool Success = false;
+    std::atomic<bool> Complete = false;
+};
+
+// Small pool of threads that runs cipher operations off the main thread. Used 
+// for the rsa handshakes in the login and auth services, which are expensive 
+// enough that a storm of them would otherwise stall the game service.
+//
+// Completion is not signalled, the submitter is expected to poll the job 
+// from its own update on the main thread.
+class CipherWorkerPool
+{
+public:
+    CipherWorkerPool(size_t WorkerCount, size_t MaxQueueDepth);
+    ~CipherWorkerPool();
+
+    // Queues an operation. Returns nullptr if the queue is already at its maximum 
+    // depth, in which case the caller should shed whatever work it was doing.
+    std::shared_ptr<CipherJob> Submit(std::shared_ptr<Cipher> JobCipher, bool Encrypt, std::vector<uint8_t>&& Data);
+
+    size_t GetQueueDepth();
+
+private:
+    void WorkerMain();
+
+private:
+    std::mutex QueueMutex;
+    std::condition_variable QueueSignal;
+    std::deque<std::shared_ptr<CipherJob>> Queue;
+
+    std::vector<std::thread> Workers;
+
+    size_t MaxQueueDepth;
+    bool Quit = false;
+
+};
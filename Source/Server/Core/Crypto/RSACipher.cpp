@@ -13,6 +13,24 @@
 
 #include <openssl/err.h>
 
+#include <cstring>
+
+namespace
+{
+	// OpenSSL doesn't say whether the source and destination can overlap, so results are written
+	// here and copied back into the span. Kept per thread so the cipher workers don't allocate.
+	thread_local std::vector<uint8_t> ScratchBuffer;
+
+	uint8_t* GetScratchBuffer(size_t Size)
+	{
+		if (ScratchBuffer.size() < Size)
+		{
+			ScratchBuffer.resize(Size);
+		}
+		return ScratchBuffer.data();
+	}
+};
+
 RSACipher::RSACipher(RSAKeyPair* InKey, RSAPaddingMode InPaddingMode, bool InUsePublicKeyToEncrypt)
 	: Key(InKey)
 	, PaddingMode(InPaddingMode)
@@ -20,91 +38,101 @@ RSACipher::RSACipher(RSAKeyPair* InKey, RSAPaddingMode InPaddingMode, bool InUse
 {
 }
 
-bool RSACipher::Encrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+size_t RSACipher::GetSuffixSize()
 {
-	RSA* RsaInstance = Key->GetRSA();
-
-	Output.resize(RSA_size(RsaInstance));
+	return RSA_size(Key->GetRSA());
+}
 
-	int OpenSSLPaddingMode = RSA_PKCS1_OAEP_PADDING;
+int RSACipher::GetOpenSSLPaddingMode()
+{
 	switch (PaddingMode)
 	{
 	case RSAPaddingMode::PKS1_OAEP:
-		OpenSSLPaddingMode = RSA_PKCS1_OAEP_PADDING;
-		break;
+		return RSA_PKCS1_OAEP_PADDING;
 	case RSAPaddingMode::X931:
-		OpenSSLPaddingMode = RSA_X931_PADDING;
-		break;
+		return RSA_X931_PADDING;
 	}
+	return RSA_PKCS1_OAEP_PADDING;
+}
+
+bool RSACipher::Encrypt(CipherSpan& Span)
+{
+	RSA* RsaInstance = Key->GetRSA();
+	size_t BlockSize = (size_t)RSA_size(RsaInstance);
+
+	if (Span.Capacity - Span.Offset < BlockSize)
+	{
+		return false;
+	}
+
+	uint8_t* Output = GetScratchBuffer(BlockSize);
 
 	int EncryptedLength = 0;
 	if (UsePublicKeyToEncrypt)
 	{
-		EncryptedLength = RSA_public_encrypt((int)Input.size(), Input.data(), Output.data(), RsaInstance, OpenSSLPaddingMode);
+		EncryptedLength = RSA_public_encrypt((int)Span.Length, Span.Data(), Output, RsaInstance, GetOpenSSLPaddingMode());
 	}
 	else
 	{
-		EncryptedLength = RSA_private_encrypt((int)Input.size(), Input.data(), Output.data(), RsaInstance, OpenSSLPaddingMode);
+		EncryptedLength = RSA_private_encrypt((int)Span.Length, Span.Data(), Output, RsaInstance, GetOpenSSLPaddingMode());
 	}
 
 	if (EncryptedLength < 0)
 	{
-		std::vector<char> buffer;
-		buffer.resize(1024);
+		char buffer[1024];
 
 		ERR_load_crypto_strings();
-		ERR_error_string_n(ERR_get_error(), buffer.data(), buffer.size());
+		ERR_error_string_n(ERR_get_error(), buffer, sizeof(buffer));
 
-		Error("Failed to encrypt RSA message with error: [%lu](%s)", EncryptedLength, buffer.data());
+		Error("Failed to encrypt RSA message with error: [%lu](%s)", EncryptedLength, buffer);
 
 		return false;
 	}
 
-	Output.resize(EncryptedLength);
+	memcpy(Span.Data(), Output, EncryptedLength);
+	Span.Length = EncryptedLength;
 
 	return true;
 }
 
-bool RSACipher::Decrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+bool RSACipher::Decrypt(CipherSpan& Span)
 {
 	RSA* RsaInstance = Key->GetRSA();
+	size_t BlockSize = (size_t)RSA_size(RsaInstance);
 
-	Output.resize(RSA_size(RsaInstance));
-
-	int OpenSSLPaddingMode = RSA_PKCS1_OAEP_PADDING;
-	switch (PaddingMode)
-	{
-	case RSAPaddingMode::PKS1_OAEP:
-		OpenSSLPaddingMode = RSA_PKCS1_OAEP_PADDING;
-		break;
-	case RSAPaddingMode::X931:
-		OpenSSLPaddingMode = RSA_X931_PADDING;
-		break;
-	}
+	// OpenSSL can write up to a full block of output, which can be more than the ciphertext 
+	// we were given if a peer sent a short one. Only the plaintext is copied back into the span.
+	uint8_t* Output = GetScratchBuffer(BlockSize);
 
 	int DecryptedLength = 0;
 	if (UsePublicKeyToEncrypt)
 	{
-		DecryptedLength = RSA_public_decrypt((int)Input.size(), Input.data(), Output.data(), RsaInstance, OpenSSLPaddingMode);
+		DecryptedLength = RSA_public_decrypt((int)Span.Length, Span.Data(), Output, RsaInstance, GetOpenSSLPaddingMode());
 	}
 	else
 	{
-		DecryptedLength = RSA_private_decrypt((int)Input.size(), Input.data(), Output.data(), RsaInstance, OpenSSLPaddingMode);
+		DecryptedLength = RSA_private_decrypt((int)Span.Length, Span.Data(), Output, RsaInstance, GetOpenSSLPaddingMode());
 	}
 	if (DecryptedLength < 0)
 	{
-		std::vector<char> buffer;
-		buffer.resize(1024);
+		char buffer[1024];
 
 		ERR_load_crypto_strings();
-		ERR_error_string_n(ERR_get_error(), buffer.data(), buffer.size());
+		ERR_error_string_n(ERR_get_error(), buffer, sizeof(buffer));
 
-		Error("Failed to decrypt RSA message with error: [%lu](%s)", DecryptedLength, buffer.data());
+		Error("Failed to decrypt RSA message with error: [%lu](%s)", DecryptedLength, buffer);
 
 		return false;
 	}
 
-	Output.resize(DecryptedLength);
+	if ((size_t)DecryptedLength > Span.Capacity - Span.Offset)
+	{
+		Error("Decrypted RSA message is larger than the buffer it was recieved in.");
+		return false;
+	}
+
+	memcpy(Span.Data(), Output, DecryptedLength);
+	Span.Length = DecryptedLength;
 
 	return true;
 }
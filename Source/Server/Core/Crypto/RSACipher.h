@@ -21,8 +21,16 @@ public:
 
     RSACipher(RSAKeyPair* Key, RSAPaddingMode PaddingMode, bool UsePublicKeyToEncrypt);
 
-    bool Encrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) override;
-    bool Decrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) override;
+    // RSA output is always a full block, so enough room has to be left after
+    // the payload to hold one.
+    size_t GetPrefixSize() override { return 0; }
+    size_t GetSuffixSize() override;
+
+    bool Encrypt(CipherSpan& Span) override;
+    bool Decrypt(CipherSpan& Span) override;
+
+private:
+    int GetOpenSSLPaddingMode();
 
 private:
     RSAKeyPair* Key;
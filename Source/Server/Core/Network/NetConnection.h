@@ -11,7 +11,7 @@
 
 #include <string>
 #include <memory>
-#include <Vector>
+#include <vector>
 
 // Base class for network connections. This class handles
 // both listening and connecting. There are different
@@ -35,6 +35,10 @@ public:
 
     virtual bool Pump() = 0;
 
+    // Returns true if there may be recieved data waiting to be read. Connections
+    // that can't tell without a system call should just return true.
+    virtual bool HasPendingData() = 0;
+
     // Replace with std::span's when they are available.
     virtual bool Peek(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) = 0;
     virtual bool Recieve(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) = 0; 
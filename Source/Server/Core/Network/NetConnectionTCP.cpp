@@ -340,6 +340,12 @@ bool NetConnectionTCP::SendPartial(const std::vector<uint8_t>& Buffer, int Offse
     return true;
 }
 
+bool NetConnectionTCP::HasPendingData()
+{
+    // Data stays in the socket until Recieve is called, no cheap way to tell.
+    return true;
+}
+
 bool NetConnectionTCP::Disconnect()
 {
     if (Socket == INVALID_SOCKET_VALUE)
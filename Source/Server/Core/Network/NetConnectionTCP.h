@@ -47,6 +47,8 @@ public:
 
     virtual bool Pump() override;
 
+    virtual bool HasPendingData() override;
+
     virtual bool Connect(std::string Hostname, int Port, bool ForceLastIpEntry) override;
 
     virtual bool Peek(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) override;
@@ -108,6 +108,8 @@ bool NetConnectionUDP::Listen(int Port)
 
     bListening = true;
 
+    StartIoThread();
+
     return true;
 }
 
@@ -255,6 +257,22 @@ bool NetConnectionUDP::Recieve(std::vector<uint8_t>& Buffer, int Offset, int Cou
 
 bool NetConnectionUDP::Send(const std::vector<uint8_t>& Buffer, int Offset, int Count)
 {
+    if (IoState)
+    {
+        Datagram Outgoing;
+        Outgoing.Data.assign(Buffer.data() + Offset, Buffer.data() + Offset + Count);
+        Outgoing.Address = Destination;
+
+        // If the io thread can't keep up treat it the same as the socket buffer
+        // being full and drop it, the reliable layer will resend it.
+        if (!IoState->SendQueue.Push(std::move(Outgoing)))
+        {
+            Debug::UdpSendsDropped.Add(1);
+        }
+        WakeIoThread();
+        return true;
+    }
+
     int Result = sendto(Socket, (char*)Buffer.data() + Offset, Count, 0, (sockaddr*)&Destination, sizeof(sockaddr_in));
     if (Result < 0)
     {
@@ -297,6 +315,22 @@ bool NetConnectionUDP::Send(const std::vector<uint8_t>& Buffer, int Offset, int
     return true;
 }
 
+bool NetConnectionUDP::HasPendingData()
+{
+    return RecieveQueue.size() > 0 || PendingPackets.size() > 0;
+}
+
+void NetConnectionUDP::TakeReadyConnections(std::vector<std::shared_ptr<NetConnection>>& Output)
+{
+    Output.clear();
+    for (std::shared_ptr<NetConnectionUDP>& Connection : ReadyConnections)
+    {
+        Connection->bInReadyConnections = false;
+        Output.push_back(Connection);
+    }
+    ReadyConnections.clear();
+}
+
 bool NetConnectionUDP::Disconnect()
 {
     if (Socket == INVALID_SOCKET_VALUE)
@@ -306,6 +340,7 @@ bool NetConnectionUDP::Disconnect()
 
     if (!bChild)
     {
+        StopIoThread();
         closesocket(Socket);
     }
     Socket = INVALID_SOCKET_VALUE;
@@ -344,6 +379,12 @@ void NetConnectionUDP::ProcessPacket(const PendingPacket& Packet)
                 {
                     Connection->RecieveQueue.push_back(Packet.Data);
                     bRoutedPacket = true;
+
+                    if (!Connection->bInReadyConnections)
+                    {
+                        Connection->bInReadyConnections = true;
+                        ReadyConnections.push_back(Connection);
+                    }
                     break;
                 }
             }
@@ -363,6 +404,7 @@ void NetConnectionUDP::ProcessPacket(const PendingPacket& Packet)
                 Packet.SourceAddress.sin_addr.S_un.S_un_b.s_b4);
 
             std::shared_ptr<NetConnectionUDP> NewConnection = std::make_shared<NetConnectionUDP>(Socket, Packet.SourceAddress, ClientName.data(), NetClientAddress);
+            NewConnection->IoState = IoState;
             NewConnection->RecieveQueue.push_back(Packet.Data);
             NewConnections.push_back(NewConnection);
             ChildConnections.push_back(NewConnection);
@@ -374,6 +416,244 @@ void NetConnectionUDP::ProcessPacket(const PendingPacket& Packet)
     }
 }
 
+void NetConnectionUDP::RecieveDatagram(std::vector<uint8_t>&& Data, const sockaddr_in& SourceAddress)
+{
+    bool bDropPacket = false;
+
+    if constexpr (BuildConfig::EMULATE_DROPPED_PACKETS)
+    {
+        if (FRandRange(0.0f, 1.0f) <= BuildConfig::DROP_PACKET_PROBABILITY)
+        {
+            bDropPacket = true;
+        }
+    }
+
+    if (!bDropPacket)
+    {
+        double Latency = BuildConfig::LATENCY_MINIMUM + FRandRange(-BuildConfig::LATENCY_VARIANCE, BuildConfig::LATENCY_VARIANCE);
+
+        PendingPacket Pending;
+        Pending.Data = std::move(Data);
+        Pending.SourceAddress = SourceAddress;
+        Pending.ProcessTime = GetSeconds() + (Latency / 1000.0f);
+
+        if constexpr (BuildConfig::EMULATE_LATENCY)
+        {
+            PendingPackets.push_back(Pending);
+        }
+        else
+        {
+            ProcessPacket(Pending);
+        }
+    }
+}
+
+void NetConnectionUDP::StartIoThread()
+{
+    IoState = std::make_shared<IoThreadState>(BuildConfig::UDP_IO_QUEUE_CAPACITY);
+    IoState->WakeSocket = INVALID_SOCKET_VALUE;
+    if (!CreateWakeSocket())
+    {
+        WarningS(GetName().c_str(), "Failed to create io thread wake socket, sends may wait up to %i us to go out.", BuildConfig::UDP_IO_WAIT_INTERVAL_US);
+    }
+    IoState->Thread = std::thread([this]() {
+        IoThreadMain();
+    });
+}
+
+void NetConnectionUDP::StopIoThread()
+{
+    if (IoState && IoState->Thread.joinable())
+    {
+        IoState->Quit = true;
+        WakeIoThread();
+        IoState->Thread.join();
+    }
+
+    if (IoState && IoState->WakeSocket != INVALID_SOCKET_VALUE)
+    {
+        closesocket(IoState->WakeSocket);
+        IoState->WakeSocket = INVALID_SOCKET_VALUE;
+    }
+}
+
+bool NetConnectionUDP::CreateWakeSocket()
+{
+    SocketType WakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (WakeSocket == INVALID_SOCKET_VALUE)
+    {
+        return false;
+    }
+
+    // Bind to any free port on loopback, then read back which one we got.
+    sockaddr_in WakeAddress = {};
+    WakeAddress.sin_family = AF_INET;
+    WakeAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    WakeAddress.sin_port = 0;
+
+    socklen_t WakeAddressSize = sizeof(WakeAddress);
+    if (bind(WakeSocket, (sockaddr*)&WakeAddress, sizeof(WakeAddress)) < 0 ||
+        getsockname(WakeSocket, (sockaddr*)&WakeAddress, &WakeAddressSize) < 0)
+    {
+        closesocket(WakeSocket);
+        return false;
+    }
+
+    // The io thread drains it without blocking.
+#if defined(_WIN32)
+    unsigned long mode = 1;
+    if (ioctlsocket(WakeSocket, FIONBIO, &mode) != 0)
+#else
+    int flags = fcntl(WakeSocket, F_GETFL, 0);
+    if (flags == -1 || fcntl(WakeSocket, F_SETFL, flags | O_NONBLOCK) != 0)
+#endif
+    {
+        closesocket(WakeSocket);
+        return false;
+    }
+
+    IoState->WakeSocket = WakeSocket;
+    IoState->WakeAddress = WakeAddress;
+    return true;
+}
+
+void NetConnectionUDP::WakeIoThread()
+{
+    if (IoState->WakeSocket == INVALID_SOCKET_VALUE)
+    {
+        return;
+    }
+
+    // Only the first send after the io thread last woke needs to poke it, the rest
+    // of the tick's sends get picked up along with it.
+    if (!IoState->WakePending.exchange(true))
+    {
+        char WakeByte = 0;
+        sendto(IoState->WakeSocket, &WakeByte, 1, 0, (sockaddr*)&IoState->WakeAddress, sizeof(sockaddr_in));
+    }
+}
+
+void NetConnectionUDP::IoThreadMain()
+{
+    while (!IoState->Quit)
+    {
+        bool DidWork = false;
+
+        // Recieve any pending datagrams and pass them over to the game thread.
+        while (true)
+        {
+            socklen_t SourceAddressSize = sizeof(struct sockaddr);
+            sockaddr_in SourceAddress = { 0 };
+
+            int Result = recvfrom(Socket, (char*)RecieveBuffer.data(), (int)RecieveBuffer.size(), 0, (sockaddr*)&SourceAddress, &SourceAddressSize);
+            if (Result < 0)
+            {
+        #if defined(_WIN32)
+                int error = WSAGetLastError();
+        #else
+                int error = errno;
+        #endif
+
+                // Blocking is fine, just return.
+        #if defined(_WIN32)
+                if (error != WSAEWOULDBLOCK)
+        #else        
+                if (error != EWOULDBLOCK && error != EAGAIN)
+        #endif
+                {
+                    ErrorS(GetName().c_str(), "Failed to recieve with error 0x%08x.", error);
+                }
+                break;
+            }
+            else if (Result > 0)
+            {
+                Datagram Incoming;
+                Incoming.Data.assign(RecieveBuffer.data(), RecieveBuffer.data() + Result);
+                Incoming.Address = SourceAddress;
+
+                // Game thread has fallen behind, drop it rather than letting the queue 
+                // grow without bound. Clients will resend anything important.
+                if (!IoState->RecieveQueue.Push(std::move(Incoming)))
+                {
+                    Debug::UdpRecievesDropped.Add(1);
+                }
+
+                Debug::UdpBytesRecieved.Add(Result);
+                DidWork = true;
+            }
+        }
+
+        // Clear the wake flag before looking at the send queue, so anything pushed 
+        // after this point either gets popped below or sends another wake.
+        if (IoState->WakeSocket != INVALID_SOCKET_VALUE && IoState->WakePending)
+        {
+            char WakeBuffer[16];
+            while (recv(IoState->WakeSocket, WakeBuffer, sizeof(WakeBuffer), 0) > 0)
+            {
+            }
+            IoState->WakePending = false;
+        }
+
+        // Send anything the game thread has queued.
+        Datagram Outgoing;
+        while (IoState->SendQueue.Pop(Outgoing))
+        {
+            int Result = sendto(Socket, (char*)Outgoing.Data.data(), (int)Outgoing.Data.size(), 0, (sockaddr*)&Outgoing.Address, sizeof(sockaddr_in));
+            if (Result < 0)
+            {
+        #if defined(_WIN32)
+                int error = WSAGetLastError();
+        #else
+                int error = errno;
+        #endif
+
+        #if defined(_WIN32)
+                if (error == WSAEWOULDBLOCK)
+        #else        
+                if (error == EWOULDBLOCK || error == EAGAIN)
+        #endif
+                {
+                    Debug::UdpSendsDropped.Add(1);
+                }
+                else
+                {
+                    ErrorS(GetName().c_str(), "Failed to send with error 0x%08x.", error);
+                }
+            }
+            else
+            {
+                Debug::UdpBytesSent.Add(Result);
+            }
+            DidWork = true;
+        }
+
+        // Nothing to do, wait for something to arrive or for the game thread to 
+        // wake us up because it's queued sends.
+        if (!DidWork)
+        {
+            fd_set ReadSet;
+            FD_ZERO(&ReadSet);
+            FD_SET(Socket, &ReadSet);
+
+            SocketType MaxSocket = Socket;
+            if (IoState->WakeSocket != INVALID_SOCKET_VALUE)
+            {
+                FD_SET(IoState->WakeSocket, &ReadSet);
+                if (IoState->WakeSocket > MaxSocket)
+                {
+                    MaxSocket = IoState->WakeSocket;
+                }
+            }
+
+            timeval Timeout;
+            Timeout.tv_sec = 0;
+            Timeout.tv_usec = BuildConfig::UDP_IO_WAIT_INTERVAL_US;
+
+            select((int)MaxSocket + 1, &ReadSet, nullptr, nullptr, &Timeout);
+        }
+    }
+}
+
 bool NetConnectionUDP::Pump()
 {
     if (Socket == INVALID_SOCKET_VALUE)
@@ -381,7 +661,23 @@ bool NetConnectionUDP::Pump()
         return false;
     }
     
-    if (!bChild)
+    if (IoState && !bChild)
+    {
+        // Let someone know if the io thread is getting close to dropping packets.
+        size_t QueueDepth = IoState->RecieveQueue.Size();
+        if (QueueDepth > (IoState->RecieveQueue.Capacity() / 4) * 3 && GetSeconds() > IoState->NextQueueWarningTime)
+        {
+            WarningS(GetName().c_str(), "Recieve queue is %zu/%zu full, game thread is falling behind.", QueueDepth, IoState->RecieveQueue.Capacity());
+            IoState->NextQueueWarningTime = GetSeconds() + BuildConfig::UDP_IO_QUEUE_WARNING_INTERVAL;
+        }
+
+        Datagram Incoming;
+        while (IoState->RecieveQueue.Pop(Incoming))
+        {
+            RecieveDatagram(std::move(Incoming.Data), Incoming.Address);
+        }
+    }
+    else if (!bChild)
     {
         while (true)
         {
@@ -414,36 +710,7 @@ bool NetConnectionUDP::Pump()
             }
             else if (Result > 0)
             {
-                std::vector<uint8_t> Packet(RecieveBuffer.data(), RecieveBuffer.data() + Result);
-
-                bool bDropPacket = false;
-
-                if constexpr (BuildConfig::EMULATE_DROPPED_PACKETS)
-                {
-                    if (FRandRange(0.0f, 1.0f) <= BuildConfig::DROP_PACKET_PROBABILITY)
-                    {
-                        bDropPacket = true;
-                    }
-                }
-
-                if (!bDropPacket)
-                {
-                    double Latency = BuildConfig::LATENCY_MINIMUM + FRandRange(-BuildConfig::LATENCY_VARIANCE, BuildConfig::LATENCY_VARIANCE);
-
-                    PendingPacket Pending;
-                    Pending.Data = Packet;
-                    Pending.SourceAddress = SourceAddress;
-                    Pending.ProcessTime = GetSeconds() + (Latency / 1000.0f);
-
-                    if constexpr (BuildConfig::EMULATE_LATENCY)
-                    {
-                        PendingPackets.push_back(Pending);
-                    }
-                    else
-                    {
-                        ProcessPacket(Pending);
-                    }
-                }
+                RecieveDatagram(std::vector<uint8_t>(RecieveBuffer.data(), RecieveBuffer.data() + Result), SourceAddress);
 
                 Debug::UdpBytesRecieved.Add(Result);
 
@@ -10,8 +10,11 @@
 #pragma once
 
 #include "Core/Network/NetConnection.h"
+#include "Core/Utils/SpscRingBuffer.h"
 
 #include <stdlib.h>
+#include <thread>
+#include <atomic>
 
 #if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN 
@@ -50,6 +53,13 @@ public:
 
     virtual bool Pump() override;
 
+    virtual bool HasPendingData() override;
+
+    // Only valid on listening connections. Gets the child connections that have had
+    // datagrams routed to them since the last call, so the owner only needs to look
+    // at connections with something waiting.
+    void TakeReadyConnections(std::vector<std::shared_ptr<NetConnection>>& Output);
+
     virtual bool Connect(std::string Hostname, int Port, bool ForceLastIpEntry) override;
 
     virtual bool Peek(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) override;
@@ -74,6 +84,52 @@ protected:
 
     void ProcessPacket(const PendingPacket& Packet);
 
+    // Called for each datagram read from the socket, applies any emulated
+    // packet loss/latency before processing it.
+    void RecieveDatagram(std::vector<uint8_t>&& Data, const sockaddr_in& SourceAddress);
+
+    // Listening sockets hand all their socket calls off to an io thread, datagrams
+    // go to and from the game thread through these queues. Children of the listening
+    // socket share the same state. Only one thread (the game thread) should pump 
+    // or send on the connections.
+    struct Datagram
+    {
+        std::vector<uint8_t> Data;
+        sockaddr_in Address = {};
+    };
+
+    struct IoThreadState
+    {
+        IoThreadState(size_t QueueCapacity)
+            : RecieveQueue(QueueCapacity)
+            , SendQueue(QueueCapacity)
+        {
+        }
+
+        SpscRingBuffer<Datagram> RecieveQueue;
+        SpscRingBuffer<Datagram> SendQueue;
+
+        std::thread Thread;
+        std::atomic<bool> Quit = false;
+
+        // Loopback socket the game thread pokes when it queues sends, so the io thread 
+        // wakes straight away rather than when its select times out. WakePending stops
+        // more than one wake being in flight at a time.
+        SocketType WakeSocket;
+        sockaddr_in WakeAddress = {};
+        std::atomic<bool> WakePending = false;
+
+        // Only touched by the game thread.
+        double NextQueueWarningTime = 0.0;
+    };
+
+    void StartIoThread();
+    void StopIoThread();
+    void IoThreadMain();
+
+    bool CreateWakeSocket();
+    void WakeIoThread();
+
 private:
 
     std::string Name;
@@ -94,4 +150,9 @@ private:
     std::vector<std::shared_ptr<NetConnectionUDP>> NewConnections;
     std::vector<std::weak_ptr<NetConnectionUDP>> ChildConnections;
 
+    std::vector<std::shared_ptr<NetConnectionUDP>> ReadyConnections;
+    bool bInReadyConnections = false;
+
+    std::shared_ptr<IoThreadState> IoState;
+
 };
\ No newline at end of file
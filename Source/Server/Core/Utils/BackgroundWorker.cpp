@@ -0,0 +1,67 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Utils/BackgroundWorker.h"
+#include "Core/Utils/DebugTimer.h"
+
+BackgroundWorker::BackgroundWorker()
+{
+    Worker = std::thread([this]() { WorkerMain(); });
+}
+
+BackgroundWorker::~BackgroundWorker()
+{
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        Quit = true;
+    }
+    WakeSignal.notify_all();
+
+    Worker.join();
+}
+
+void BackgroundWorker::Submit(JobFunction Function, DebugTimer* Timer)
+{
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        Jobs.push_back({ std::move(Function), Timer });
+    }
+    WakeSignal.notify_one();
+}
+
+void BackgroundWorker::WorkerMain()
+{
+    while (true)
+    {
+        Job ToRun;
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            WakeSignal.wait(Lock, [this]() { return Quit || !Jobs.empty(); });
+
+            // Only exit once everything that was queued has been run.
+            if (Jobs.empty())
+            {
+                return;
+            }
+
+            ToRun = std::move(Jobs.front());
+            Jobs.pop_front();
+        }
+
+        if (ToRun.Timer)
+        {
+            DebugTimerScope Scope(*ToRun.Timer);
+            ToRun.Function();
+        }
+        else
+        {
+            ToRun.Function();
+        }
+    }
+}
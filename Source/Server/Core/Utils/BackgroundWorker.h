@@ -0,0 +1,55 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+class DebugTimer;
+
+// Single thread that runs queued jobs one at a time, in the order they were
+// queued. Used for slow work that doesn't need to happen on the main thread
+// and would hitch it if it did, like the master server advertisement.
+
+class BackgroundWorker
+{
+public:
+    using JobFunction = std::function<void()>;
+
+    BackgroundWorker();
+
+    // Runs anything still queued before returning.
+    ~BackgroundWorker();
+
+    // Queues a job to run on the worker. If a timer is given, the time the job
+    // takes to run is sampled into it.
+    void Submit(JobFunction Function, DebugTimer* Timer = nullptr);
+
+private:
+    struct Job
+    {
+        JobFunction Function;
+        DebugTimer* Timer = nullptr;
+    };
+
+    void WorkerMain();
+
+private:
+    std::thread Worker;
+
+    std::mutex Mutex;
+    std::condition_variable WakeSignal;
+    std::deque<Job> Jobs;
+    bool Quit = false;
+
+};
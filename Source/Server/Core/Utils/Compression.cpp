@@ -13,8 +13,6 @@
 
 bool Compress(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
 {
-    uLongf DestinationLength = (uLongf)Output.size();
-
     Output.resize(compressBound((uLong)Input.size()));
 
     z_stream defstream;
@@ -0,0 +1,67 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Utils/CoroutineFramePool.h"
+#include "Core/Utils/DebugObjects.h"
+
+#include <new>
+
+size_t CoroutineFramePool::GetSizeClass(size_t Size)
+{
+    size_t Index = 0;
+    size_t ClassSize = MIN_CLASS_SIZE;
+    while (ClassSize < Size)
+    {
+        ClassSize <<= 1;
+        Index++;
+    }
+    return Index;
+}
+
+void* CoroutineFramePool::Allocate(size_t Size)
+{
+    if (Size > MAX_CLASS_SIZE)
+    {
+        Debug::CoroutineFrameAllocations.Add(1.0f);
+        return ::operator new(Size);
+    }
+
+    size_t Index = GetSizeClass(Size);
+    SizeClass& Class = Classes[Index];
+
+    {
+        std::unique_lock<std::mutex> Lock(Class.Mutex);
+        if (!Class.FreeFrames.empty())
+        {
+            void* Frame = Class.FreeFrames.back();
+            Class.FreeFrames.pop_back();
+            return Frame;
+        }
+    }
+
+    Debug::CoroutineFrameAllocations.Add(1.0f);
+    return ::operator new(MIN_CLASS_SIZE << Index);
+}
+
+void CoroutineFramePool::Free(void* Frame, size_t Size)
+{
+    if (Size <= MAX_CLASS_SIZE)
+    {
+        SizeClass& Class = Classes[GetSizeClass(Size)];
+
+        std::unique_lock<std::mutex> Lock(Class.Mutex);
+        if (Class.FreeFrames.size() < MAX_FREE_FRAMES_PER_CLASS)
+        {
+            Class.FreeFrames.push_back(Frame);
+            return;
+        }
+    }
+
+    ::operator delete(Frame);
+}
@@ -0,0 +1,44 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+// Recycles coroutine frames so starting a Task doesn't go to the heap every
+// time. Frames are bucketed into power of two size classes, each with its own
+// free list. Anything bigger than the largest class is allocated directly.
+
+class CoroutineFramePool
+{
+public:
+    static void* Allocate(size_t Size);
+    static void Free(void* Frame, size_t Size);
+
+private:
+    inline static const size_t MIN_CLASS_SIZE = 128;
+    inline static const size_t MAX_CLASS_SIZE = 8 * 1024;
+    inline static const size_t CLASS_COUNT = 7;
+
+    // Frames held on to per size class, anything freed beyond this goes back to the heap.
+    inline static const size_t MAX_FREE_FRAMES_PER_CLASS = 1024;
+
+    static size_t GetSizeClass(size_t Size);
+
+    struct SizeClass
+    {
+        std::mutex Mutex;
+        std::vector<void*> FreeFrames;
+    };
+
+    inline static SizeClass Classes[CLASS_COUNT];
+
+};
@@ -10,9 +10,9 @@
 #include "Core/Utils/DebugCounter.h"
 
 DebugCounter::DebugCounter(const std::string& InName, double InRateWindow, double InRollingWindow)
-    : Name(InName)
+    : RateWindow(InRateWindow)
     , RollingWindow(InRollingWindow)
-    , RateWindow(InRateWindow)
+    , Name(InName)
 {
     Registry.push_back(this);
 }
@@ -11,6 +11,8 @@
 
 #include <string>
 #include <vector>
+#include <list>
+#include <mutex>
 
 #include "Platform/Platform.h"
 
@@ -10,8 +10,8 @@
 #include "Core/Utils/DebugTimer.h"
 
 DebugTimer::DebugTimer(const std::string& InName, double InRollingWindow)
-    : Name(InName)
-    , RollingWindow(InRollingWindow)
+    : RollingWindow(InRollingWindow)
+    , Name(InName)
 {
     Registry.push_back(this);
 }
@@ -14,6 +14,9 @@
 
 #include "Platform/Platform.h"
 
+#include <string>
+#include <list>
+
 #define STRINGIFY2(x) #x
 #define STRINGIFY(x) STRINGIFY2(x)
 
@@ -33,27 +36,27 @@ void WriteLog(ConsoleColor Color, const char* Source, const char* Level, const c
 
 // Various macros for different log levels.
 #if defined(_DEBUG)
-#define Verbose(Format, ...)                    WriteLog(ConsoleColor::Grey,      "", "Verbose", Format, __VA_ARGS__);
+#define Verbose(Format, ...)                    WriteLog(ConsoleColor::Grey,      "", "Verbose", Format, ##__VA_ARGS__);
 #else
 #define Verbose(Format, ...)           
 #endif
-#define Log(Format, ...)                        WriteLog(ConsoleColor::Grey,      "", "Log", Format, __VA_ARGS__);
-#define Success(Format, ...)                    WriteLog(ConsoleColor::Green,     "", "Success", Format, __VA_ARGS__);
-#define Warning(Format, ...)                    WriteLog(ConsoleColor::Yellow,    "", "Warning", Format, __VA_ARGS__);
-#define Error(Format, ...)                      WriteLog(ConsoleColor::Red,       "", "Error", Format, __VA_ARGS__);
-#define Fatal(Format, ...)                      WriteLog(ConsoleColor::Red,       "", "Fatal", Format, __VA_ARGS__); Ensure(false);
+#define Log(Format, ...)                        WriteLog(ConsoleColor::Grey,      "", "Log", Format, ##__VA_ARGS__);
+#define Success(Format, ...)                    WriteLog(ConsoleColor::Green,     "", "Success", Format, ##__VA_ARGS__);
+#define Warning(Format, ...)                    WriteLog(ConsoleColor::Yellow,    "", "Warning", Format, ##__VA_ARGS__);
+#define Error(Format, ...)                      WriteLog(ConsoleColor::Red,       "", "Error", Format, ##__VA_ARGS__);
+#define Fatal(Format, ...)                      WriteLog(ConsoleColor::Red,       "", "Fatal", Format, ##__VA_ARGS__); Ensure(false);
 
 // Same as the ones above but allows you to define the values of the "Source" column.
 #if defined(_DEBUG)
-#define VerboseS(Source, Format, ...)           WriteLog(ConsoleColor::Grey,      Source, "Verbose", Format, __VA_ARGS__);
+#define VerboseS(Source, Format, ...)           WriteLog(ConsoleColor::Grey,      Source, "Verbose", Format, ##__VA_ARGS__);
 #else
 #define VerboseS(Source, Format, ...)           
 #endif
-#define LogS(Source, Format, ...)               WriteLog(ConsoleColor::Grey,      Source, "Log", Format, __VA_ARGS__);
-#define SuccessS(Source, Format, ...)           WriteLog(ConsoleColor::Green,     Source, "Success", Format, __VA_ARGS__);
-#define WarningS(Source, Format, ...)           WriteLog(ConsoleColor::Yellow,    Source, "Warning", Format, __VA_ARGS__);
-#define ErrorS(Source, Format, ...)             WriteLog(ConsoleColor::Red,       Source, "Error", Format, __VA_ARGS__);
-#define FatalS(Source, Format, ...)             WriteLog(ConsoleColor::Red,       Source, "Fatal", Format, __VA_ARGS__); Ensure(false);
+#define LogS(Source, Format, ...)               WriteLog(ConsoleColor::Grey,      Source, "Log", Format, ##__VA_ARGS__);
+#define SuccessS(Source, Format, ...)           WriteLog(ConsoleColor::Green,     Source, "Success", Format, ##__VA_ARGS__);
+#define WarningS(Source, Format, ...)           WriteLog(ConsoleColor::Yellow,    Source, "Warning", Format, ##__VA_ARGS__);
+#define ErrorS(Source, Format, ...)             WriteLog(ConsoleColor::Red,       Source, "Error", Format, ##__VA_ARGS__);
+#define FatalS(Source, Format, ...)             WriteLog(ConsoleColor::Red,       Source, "Fatal", Format, ##__VA_ARGS__); Ensure(false);
 
 // Some general purpose debugging/assert macros.
 #define Ensure(expr)                                \
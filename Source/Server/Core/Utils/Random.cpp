@@ -8,38 +8,239 @@
  */
 
 #include "Core/Utils/Random.h"
+#include "Core/Utils/Logging.h"
+#include "Platform/Platform.h"
+#include "Config/BuildConfig.h"
 
 #include <random>
+#include <cstring>
+#include <algorithm>
 
-void FillRandomBytes(std::vector<uint8_t>& Output)
+namespace 
 {
-	static std::random_device device;
-	static std::mt19937 generator(device());
+    uint32_t Rotate(uint32_t Value, int Bits)
+    {
+        return (Value << Bits) | (Value >> (32 - Bits));
+    }
+
+    void QuarterRound(uint32_t* State, int A, int B, int C, int D)
+    {
+        State[A] += State[B]; State[D] = Rotate(State[D] ^ State[A], 16);
+        State[C] += State[D]; State[B] = Rotate(State[B] ^ State[C], 12);
+        State[A] += State[B]; State[D] = Rotate(State[D] ^ State[A], 8);
+        State[C] += State[D]; State[B] = Rotate(State[B] ^ State[C], 7);
+    }
+};
+
+void ChaCha20Block(const uint32_t Key[8], uint32_t Counter, const uint32_t Nonce[3], uint8_t Output[64])
+{
+    uint32_t Input[16] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+        Key[0], Key[1], Key[2], Key[3], Key[4], Key[5], Key[6], Key[7],
+        Counter, Nonce[0], Nonce[1], Nonce[2]
+    };
+
+    uint32_t State[16];
+    memcpy(State, Input, sizeof(State));
 
-	std::uniform_int_distribution<> distribution(0, 255);
+    for (int i = 0; i < 10; i++)
+    {
+        QuarterRound(State, 0, 4,  8, 12);
+        QuarterRound(State, 1, 5,  9, 13);
+        QuarterRound(State, 2, 6, 10, 14);
+        QuarterRound(State, 3, 7, 11, 15);
+        QuarterRound(State, 0, 5, 10, 15);
+        QuarterRound(State, 1, 6, 11, 12);
+        QuarterRound(State, 2, 7,  8, 13);
+        QuarterRound(State, 3, 4,  9, 14);
+    }
 
-	for (size_t i = 0; i < Output.size(); i++)
-	{
-		Output[i] = distribution(generator);
-	}
+    for (int i = 0; i < 16; i++)
+    {
+        uint32_t Word = State[i] + Input[i];
+        Output[i * 4 + 0] = (uint8_t)(Word);
+        Output[i * 4 + 1] = (uint8_t)(Word >> 8);
+        Output[i * 4 + 2] = (uint8_t)(Word >> 16);
+        Output[i * 4 + 3] = (uint8_t)(Word >> 24);
+    }
 }
 
-void FillRandomBytes(uint8_t* Buffer, int Count)
+namespace 
 {
-	static std::random_device device;
-	static std::mt19937 generator(device());
+    // ChaCha20 (RFC 8439) keystream used as a CSPRNG. Output is generated a 
+    // few blocks at a time, and the first 32 bytes of every refill become the
+    // key for the next one, so a leaked state can't be used to recover any
+    // output that was already handed out.
+    class ChaChaRandom
+    {
+    public:
+
+        ChaChaRandom()
+        {
+            memset(Key, 0, sizeof(Key));
+            memset(Nonce, 0, sizeof(Nonce));
+            Reseed();
+            Refill();
+        }
+
+        ~ChaChaRandom()
+        {
+            memset(Key, 0, sizeof(Key));
+            memset(Buffer, 0, sizeof(Buffer));
+        }
+
+        void Fill(uint8_t* Output, size_t Count)
+        {
+            bool WroteBlocksDirectly = false;
+
+            while (Count > 0)
+            {
+                if (BufferOffset >= sizeof(Buffer))
+                {
+                    // Large requests skip the buffer and have whole blocks 
+                    // written straight into them.
+                    if (Count >= BLOCK_SIZE)
+                    {
+                        Block(Output);
+                        Output += BLOCK_SIZE;
+                        Count -= BLOCK_SIZE;
+                        BytesSinceReseed += BLOCK_SIZE;
+                        WroteBlocksDirectly = true;
+                        continue;
+                    }
+
+                    Refill();
+                }
+
+                size_t Available = std::min(Count, sizeof(Buffer) - BufferOffset);
+                memcpy(Output, Buffer + BufferOffset, Available);
+                memset(Buffer + BufferOffset, 0, Available);
+
+                Output += Available;
+                Count -= Available;
+                BufferOffset += Available;
+            }
+
+            // Make sure the key that produced the direct blocks doesn't outlive them.
+            if (WroteBlocksDirectly && BufferOffset >= sizeof(Buffer))
+            {
+                Refill();
+            }
+        }
+
+    private:
+
+        inline static const size_t BLOCK_SIZE = 64;
+        inline static const size_t BUFFER_BLOCKS = 16;
+
+        // Generates one 64 byte block of keystream and advances the counter.
+        void Block(uint8_t* Output)
+        {
+            ChaCha20Block(Key, Counter++, Nonce, Output);
+
+            // Counter wrapped, step the nonce so we never reuse a keystream.
+            if (Counter == 0)
+            {
+                Nonce[0]++;
+            }
+        }
+
+        void Refill()
+        {
+            if (BytesSinceReseed >= BuildConfig::RANDOM_RESEED_INTERVAL)
+            {
+                Reseed();
+            }
+
+            for (size_t i = 0; i < BUFFER_BLOCKS; i++)
+            {
+                Block(Buffer + (i * BLOCK_SIZE));
+            }
 
-	std::uniform_int_distribution<> distribution(0, 255);
+            // First 32 bytes are never handed out, they become the next key.
+            for (int i = 0; i < 8; i++)
+            {
+                Key[i] = (uint32_t)Buffer[i * 4 + 0]
+                      | ((uint32_t)Buffer[i * 4 + 1] << 8)
+                      | ((uint32_t)Buffer[i * 4 + 2] << 16)
+                      | ((uint32_t)Buffer[i * 4 + 3] << 24);
+            }
+            memset(Buffer, 0, sizeof(Key));
 
-	for (size_t i = 0; i < Count; i++)
-	{
-		Buffer[i] = distribution(generator);
-	}
+            BufferOffset = sizeof(Key);
+            BytesSinceReseed += sizeof(Buffer);
+        }
+
+        // Mixes fresh entropy from the system into the key and nonce. Entropy is 
+        // xor'd in rather than replacing the state, so a bad source can't make
+        // the output any weaker than it already was.
+        void Reseed()
+        {
+            uint32_t Entropy[8 + 3];
+            if (!GetPlatformEntropy(reinterpret_cast<uint8_t*>(Entropy), sizeof(Entropy)))
+            {
+                Error("Failed to get entropy from the system, falling back to std::random_device.");
+
+                std::random_device Device;
+                for (size_t i = 0; i < sizeof(Entropy) / sizeof(uint32_t); i++)
+                {
+                    Entropy[i] = Device();
+                }
+                Entropy[0] ^= (uint32_t)(GetHighResolutionSeconds() * 1000000.0);
+            }
+
+            for (int i = 0; i < 8; i++)
+            {
+                Key[i] ^= Entropy[i];
+            }
+            for (int i = 0; i < 3; i++)
+            {
+                Nonce[i] ^= Entropy[8 + i];
+            }
+            Counter = 0;
+
+            memset(Entropy, 0, sizeof(Entropy));
+
+            BytesSinceReseed = 0;
+        }
+
+    private:
+
+        uint32_t Key[8];
+        uint32_t Nonce[3];
+        uint32_t Counter = 0;
+
+        uint8_t Buffer[BLOCK_SIZE * BUFFER_BLOCKS];
+        size_t BufferOffset = sizeof(Buffer);
+
+        size_t BytesSinceReseed = 0;
+
+    };
+
+    ChaChaRandom& GetThreadRandom()
+    {
+        static thread_local ChaChaRandom Instance;
+        return Instance;
+    }
+};
+
+void FillRandomBytes(std::vector<uint8_t>& Output)
+{
+    GetThreadRandom().Fill(Output.data(), Output.size());
+}
+
+void FillRandomBytes(uint8_t* Buffer, int Count)
+{
+    GetThreadRandom().Fill(Buffer, (size_t)Count);
 }
 
 double FRandRange(double min, double max)
 {
-	double range = max - min;
-	double weight = (static_cast<double>(rand()) / RAND_MAX);
-	return min + (weight * range);
+    // Top 53 bits give a uniformly distributed double in [0, 1).
+    uint64_t Value = 0;
+    GetThreadRandom().Fill(reinterpret_cast<uint8_t*>(&Value), sizeof(Value));
+
+    double range = max - min;
+    double weight = (double)(Value >> 11) * (1.0 / 9007199254740992.0);
+    return min + (weight * range);
 }
\ No newline at end of file
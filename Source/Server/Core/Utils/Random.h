@@ -11,10 +11,19 @@
 
 #include <filesystem>
 #include <string>
+#include <vector>
+#include <cstdint>
 
 // Some general purpose random functionality.
+//
+// All of these are backed by a per-thread ChaCha20 generator seeded from
+// the operating system, so they are safe to use for keys, ivs and tokens.
 
 void FillRandomBytes(std::vector<uint8_t>& Output);
 void FillRandomBytes(uint8_t* Buffer, int Count);
 
-double FRandRange(double min, double max);
\ No newline at end of file
+double FRandRange(double min, double max);
+
+// Generates one 64 byte block of ChaCha20 keystream (RFC 8439). This is what the 
+// generators above are built on, exposed so it can be checked against known answers.
+void ChaCha20Block(const uint32_t Key[8], uint32_t Counter, const uint32_t Nonce[3], uint8_t Output[64]);
\ No newline at end of file
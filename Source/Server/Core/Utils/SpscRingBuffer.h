@@ -0,0 +1,86 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// Fixed size lock-free queue for passing items from exactly one producer thread
+// to exactly one consumer thread. Push fails rather than blocking when the queue
+// is full, it's up to the producer to decide what to do (drop, retry, etc).
+
+template <typename ElementType>
+class SpscRingBuffer
+{
+public:
+
+    // Capacity is rounded up to a power of two.
+    SpscRingBuffer(size_t MinCapacity)
+    {
+        size_t Capacity = 1;
+        while (Capacity < MinCapacity)
+        {
+            Capacity <<= 1;
+        }
+        Elements.resize(Capacity);
+        Mask = Capacity - 1;
+    }
+
+    // Producer thread only. Returns false if the queue is full, in which case
+    // Element is left untouched.
+    bool Push(ElementType&& Element)
+    {
+        size_t Tail = TailIndex.load(std::memory_order_relaxed);
+        if (Tail - HeadIndex.load(std::memory_order_acquire) > Mask)
+        {
+            return false;
+        }
+
+        Elements[Tail & Mask] = std::move(Element);
+        TailIndex.store(Tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns false if the queue is empty.
+    bool Pop(ElementType& Element)
+    {
+        size_t Head = HeadIndex.load(std::memory_order_relaxed);
+        if (Head == TailIndex.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        Element = std::move(Elements[Head & Mask]);
+        HeadIndex.store(Head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Safe to call from either side, but only a snapshot as the other side 
+    // may be changing it.
+    size_t Size() const
+    {
+        return TailIndex.load(std::memory_order_acquire) - HeadIndex.load(std::memory_order_acquire);
+    }
+
+    size_t Capacity() const
+    {
+        return Elements.size();
+    }
+
+private:
+    std::vector<ElementType> Elements;
+    size_t Mask = 0;
+
+    // Kept on separate cache lines so the two threads don't fight over them.
+    alignas(64) std::atomic<size_t> HeadIndex = 0;
+    alignas(64) std::atomic<size_t> TailIndex = 0;
+
+};
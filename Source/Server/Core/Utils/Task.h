@@ -0,0 +1,141 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include "Core/Utils/CoroutineFramePool.h"
+
+#include <coroutine>
+#include <optional>
+#include <functional>
+#include <exception>
+#include <utility>
+
+// Coroutine type for handlers that need to wait on something slow, like a
+// database query, without holding up the thread they were started on.
+//
+// A task starts running as soon as it's called and carries on until the first
+// co_await that has to wait. Whatever it's waiting on resumes it later, from
+// the main loop, and the task picks up where it left off. Tasks can co_await
+// other tasks, or non-coroutine code can use Then to be told the result.
+//
+// The task is free to outlive the Task object that was returned for it, its
+// frame is cleaned up once it finishes. Anything it needs after a co_await
+// should be passed by value, references to the callers locals won't survive.
+//
+// Frames come from CoroutineFramePool, but that only covers the frame. Each
+// query awaited still allocates its job and result on the executor.
+
+template <typename ResultType>
+class Task
+{
+public:
+    struct promise_type;
+    using HandleType = std::coroutine_handle<promise_type>;
+
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept { return false; }
+        void await_resume() noexcept { }
+
+        std::coroutine_handle<> await_suspend(HandleType Handle) noexcept
+        {
+            promise_type& Promise = Handle.promise();
+
+            if (Promise.Completion)
+            {
+                Promise.Completion(*Promise.Result);
+            }
+
+            std::coroutine_handle<> Continuation = Promise.Continuation;
+            if (Promise.Detached)
+            {
+                Handle.destroy();
+            }
+
+            return Continuation ? Continuation : std::noop_coroutine();
+        }
+    };
+
+    struct promise_type
+    {
+        std::optional<ResultType> Result;
+        std::coroutine_handle<> Continuation;
+        std::function<void(const ResultType& Result)> Completion;
+        bool Detached = false;
+
+        Task get_return_object() { return Task(HandleType::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_value(ResultType Value) { Result = std::move(Value); }
+
+        // The server doesn't use exceptions, treat one escaping a task like any other crash.
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(size_t Size) { return CoroutineFramePool::Allocate(Size); }
+        static void operator delete(void* Frame, size_t Size) { CoroutineFramePool::Free(Frame, Size); }
+    };
+
+    Task(Task&& Other) noexcept
+        : Handle(std::exchange(Other.Handle, nullptr))
+    {
+    }
+
+    Task(const Task& Other) = delete;
+    Task& operator=(const Task& Other) = delete;
+    Task& operator=(Task&& Other) = delete;
+
+    ~Task()
+    {
+        if (Handle)
+        {
+            if (Handle.done())
+            {
+                Handle.destroy();
+            }
+            else
+            {
+                Handle.promise().Detached = true;
+            }
+        }
+    }
+
+    bool IsDone() { return Handle.done(); }
+
+    // Only valid once IsDone returns true.
+    const ResultType& GetResult() { return *Handle.promise().Result; }
+
+    // Calls Completion with the result once the task finishes, or immediately
+    // if it already has.
+    void Then(std::function<void(const ResultType& Result)> Completion)
+    {
+        if (Handle.done())
+        {
+            Completion(*Handle.promise().Result);
+        }
+        else
+        {
+            Handle.promise().Completion = std::move(Completion);
+        }
+    }
+
+    // Awaiting a task from another task resumes the caller when it finishes.
+    bool await_ready() { return Handle.done(); }
+    void await_suspend(std::coroutine_handle<> Caller) { Handle.promise().Continuation = Caller; }
+    ResultType await_resume() { return std::move(*Handle.promise().Result); }
+
+private:
+    explicit Task(HandleType InHandle)
+        : Handle(InHandle)
+    {
+    }
+
+    HandleType Handle;
+
+};
@@ -0,0 +1,100 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Utils/WorkerGroup.h"
+
+WorkerGroup::WorkerGroup(size_t WorkerCount)
+{
+    for (size_t i = 0; i < WorkerCount; i++)
+    {
+        Workers.push_back(std::thread([this]() { WorkerMain(); }));
+    }
+}
+
+WorkerGroup::~WorkerGroup()
+{
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        Quit = true;
+    }
+    WorkSignal.notify_all();
+
+    for (std::thread& Worker : Workers)
+    {
+        Worker.join();
+    }
+}
+
+void WorkerGroup::ParallelFor(size_t InCount, const std::function<void(size_t Index)>& InFunction)
+{
+    // Not worth waking anyone up for.
+    if (Workers.empty() || InCount <= 1)
+    {
+        for (size_t i = 0; i < InCount; i++)
+        {
+            InFunction(i);
+        }
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        Function = &InFunction;
+        Count = InCount;
+        NextIndex = 0;
+        ActiveWorkers = Workers.size();
+        Generation++;
+    }
+    WorkSignal.notify_all();
+
+    RunIterations();
+
+    // Wait for every worker to be finished with the function before it goes out of scope.
+    std::unique_lock<std::mutex> Lock(Mutex);
+    DoneSignal.wait(Lock, [this]() { return ActiveWorkers == 0; });
+    Function = nullptr;
+}
+
+void WorkerGroup::RunIterations()
+{
+    for (size_t Index = NextIndex++; Index < Count; Index = NextIndex++)
+    {
+        (*Function)(Index);
+    }
+}
+
+void WorkerGroup::WorkerMain()
+{
+    uint64_t LastGeneration = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            WorkSignal.wait(Lock, [this, LastGeneration]() { return Quit || Generation != LastGeneration; });
+
+            if (Quit)
+            {
+                return;
+            }
+
+            LastGeneration = Generation;
+        }
+
+        RunIterations();
+
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            if (--ActiveWorkers == 0)
+            {
+                DoneSignal.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of threads that can be used to run the iterations of a loop in
+// parallel. The calling thread does its share of the work as well, and 
+// ParallelFor doesn't return until every iteration is done.
+
+class WorkerGroup
+{
+public:
+    WorkerGroup(size_t WorkerCount);
+    ~WorkerGroup();
+
+    // Calls Function once for each index in [0, Count), spread across the 
+    // workers. Iterations can run in any order.
+    void ParallelFor(size_t Count, const std::function<void(size_t Index)>& Function);
+
+    size_t GetWorkerCount() { return Workers.size(); }
+
+private:
+    void WorkerMain();
+    void RunIterations();
+
+private:
+    std::vector<std::thread> Workers;
+
+    std::mutex Mutex;
+    std::condition_variable WorkSignal;
+    std::condition_variable DoneSignal;
+
+    const std::function<void(size_t Index)>* Function = nullptr;
+    size_t Count = 0;
+    std::atomic<size_t> NextIndex = 0;
+
+    uint64_t Generation = 0;
+    size_t ActiveWorkers = 0;
+    bool Quit = false;
+
+};
@@ -0,0 +1,106 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+// Only enough of the platform layer for the tools that run on linux (the
+// benchmark). Networking is not implemented for this platform.
+
+#include "Platform/Platform.h"
+#include "Core/Utils/Logging.h"
+
+#include <cstdio>
+#include <ctime>
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/random.h>
+
+namespace 
+{
+    void CtrlSignalCallback(int)
+    {
+        PlatformEvents::OnCtrlSignal.Broadcast();
+    }
+};
+
+bool PlatformInit()
+{
+    signal(SIGINT, CtrlSignalCallback);
+    signal(SIGTERM, CtrlSignalCallback);
+    return true;
+}
+
+bool PlatformTerm()
+{
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    return true;
+}
+
+void WriteToConsole(ConsoleColor Color, const char* Message)
+{
+    static const char* ColorEscapeCodes[(int)ConsoleColor::Count] = {
+        "\033[91m", // Red
+        "\033[93m", // Yellow
+        "\033[92m", // Green
+        "\033[97m", // White
+        "\033[37m"  // Grey
+    };
+
+    // Don't write escape codes if we are being piped somewhere.
+    static bool IsTerminal = isatty(fileno(stdout));
+    if (IsTerminal)
+    {
+        printf("%s%s\033[0m", ColorEscapeCodes[(int)Color], Message);
+    }
+    else
+    {
+        printf("%s", Message);
+    }
+}
+
+double GetSeconds()
+{
+    timespec Time;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &Time);
+    return (double)Time.tv_sec + (double)Time.tv_nsec / 1000000000.0;
+}
+
+double GetHighResolutionSeconds()
+{
+    static timespec Epoch = []() {
+        timespec Result;
+        clock_gettime(CLOCK_MONOTONIC, &Result);
+        return Result;
+    }();
+
+    timespec Current;
+    clock_gettime(CLOCK_MONOTONIC, &Current);
+
+    return (double)(Current.tv_sec - Epoch.tv_sec) + (double)(Current.tv_nsec - Epoch.tv_nsec) / 1000000000.0;
+}
+
+bool GetPlatformEntropy(uint8_t* Buffer, size_t Length)
+{
+    while (Length > 0)
+    {
+        ssize_t Result = getrandom(Buffer, Length, 0);
+        if (Result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        Buffer += Result;
+        Length -= (size_t)Result;
+    }
+    return true;
+}
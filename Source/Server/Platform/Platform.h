@@ -15,6 +15,8 @@
 
 #include "Core/Utils/Event.h"
 
+#include <cstdint>
+
 // ========================================================================
 // General platform setup functions.
 // ========================================================================
@@ -63,6 +65,11 @@ enum class ConsoleColor
 
 void WriteToConsole(ConsoleColor Color, const char* Message);
 
+// Breaks into the debugger (or kills the process if there isn't one).
+#if !defined(_MSC_VER)
+#define __debugbreak() __builtin_trap()
+#endif
+
 // ========================================================================
 // Timing related functionality.
 // ========================================================================
@@ -75,4 +82,12 @@ double GetSeconds();
 // This is similar to GetSeconds but uses a high resolution timer suitable for
 // performance timings. There is an overhead for using this, so
 // prefer use of GetSeconds where possible.
-double GetHighResolutionSeconds();
\ No newline at end of file
+double GetHighResolutionSeconds();
+
+// ========================================================================
+// Security related functionality.
+// ========================================================================
+
+// Fills the buffer with cryptographically secure random bytes from the 
+// operating system. Returns false if the system source is unavailable.
+bool GetPlatformEntropy(uint8_t* Buffer, size_t Length);
\ No newline at end of file
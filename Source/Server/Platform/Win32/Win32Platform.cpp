@@ -11,11 +11,14 @@
 #include "Core/Utils/Logging.h"
 
 #include <windows.h>
+#include <bcrypt.h>
 #include <chrono>
 
 #if defined(_WIN32)
 // Link to the windows socket library.
 #pragma comment(lib, "Ws2_32.lib")
+// Link to the windows crypto library (for BCryptGenRandom).
+#pragma comment(lib, "Bcrypt.lib")
 #endif
 
 struct Win32CtrlSignalHandler
@@ -127,3 +130,9 @@ double GetHighResolutionSeconds()
 
     return (double)ElapsedMicroseconds.QuadPart / 1000000.0;
 }
+
+bool GetPlatformEntropy(uint8_t* Buffer, size_t Length)
+{
+    NTSTATUS Result = BCryptGenRandom(nullptr, Buffer, (ULONG)Length, BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+    return BCRYPT_SUCCESS(Result);
+}
\ No newline at end of file
@@ -12,10 +12,14 @@
 // The version of protobuf we have to use to support DS3 doesn't generate
 // code that compiles without warnings under x64 (lots of size_t truncation).
 // To keep things a bit cleaner we import all the files through this header and cpp.
+#if defined(_MSC_VER)
 #pragma warning(disable: 4267 4244 4018)
+#endif
 
 #include "FpdLogMessage.pb.h"
 #include "Frpg2PlayerData.pb.h"
 #include "Frpg2RequestMessage.pb.h"
 
+#if defined(_MSC_VER)
 #pragma warning(default: 4267 4244 4018)
+#endif
@@ -39,6 +39,7 @@ AuthClient::AuthClient(AuthService* OwningService, std::shared_ptr<NetConnection
     LastMessageRecievedTime = GetSeconds();
 
     MessageStream = std::make_shared<Frpg2MessageStream>(InConnection, InServerRSAKey);
+    MessageStream->SetCipherWorkerPool(&OwningService->GetServer()->GetHandshakeWorkerPool());
 }
 
 bool AuthClient::Poll()
@@ -115,7 +116,8 @@ bool AuthClient::Poll()
                 }
 
                 // Enable new aes-cwc-128 cipher.
-                MessageStream->SetCipher(std::make_shared<CWCCipher>(CwcKey), std::make_shared<CWCCipher>(CwcKey)); 
+                std::shared_ptr<CWCKeySchedule> KeySchedule = std::make_shared<CWCKeySchedule>(CwcKey);
+                MessageStream->SetCipher(std::make_shared<CWCCipher>(KeySchedule), std::make_shared<CWCCipher>(KeySchedule)); 
 
                 LastMessageRecievedTime = GetSeconds();
                 State = AuthClientState::WaitingForServiceStatusRequest;
@@ -214,9 +216,6 @@ bool AuthClient::Poll()
             Frpg2Message Message;
             if (MessageStream->Recieve(&Message))
             {
-                const RuntimeConfig& RuntimeConfig = Service->GetServer()->GetConfig();
-                std::string ServerIP = Service->GetServer()->GetPublicIP().ToString();
-
                 // Format Note:
                 // The message payload is stored as:
                 //      Bytes 0-15: GameCwcKey Calculated Above
@@ -228,62 +227,52 @@ bool AuthClient::Poll()
                     return true;
                 }
 
-                // Validate the steam ticket.
-                std::vector<uint8_t> Ticket;
-                Ticket.assign(Message.Payload.data() + 16, Message.Payload.data() + 16 + (Message.Payload.size() - 16));
-
-                uint64 SteamIdInt;
-                sscanf(SteamId.c_str(), "%016llx", &SteamIdInt);
-                CSteamID SteamIdStruct(SteamIdInt);                
+                SteamTicketMessageIndex = Message.Header.msg_index;
+                LastMessageRecievedTime = GetSeconds();
 
                 if constexpr (BuildConfig::AUTH_ENABLED)
                 {
-                    int AuthResult = SteamGameServer()->BeginAuthSession(Ticket.data(), (int)Ticket.size(), SteamIdStruct);
-                    if (AuthResult != k_EBeginAuthSessionResultOK)
+                    // The steam api isn't thread safe, so the ticket is validated by the game 
+                    // service on the main thread and we wait for the result.
+                    PendingTicketCheck = std::make_shared<SteamTicketCheck>();
+                    PendingTicketCheck->SteamId = SteamId;
+                    PendingTicketCheck->Ticket.assign(Message.Payload.data() + 16, Message.Payload.data() + 16 + (Message.Payload.size() - 16));
+
+                    std::shared_ptr<GameService> GameServiceInstance = Service->GetServer()->GetService<GameService>();
+                    GameServiceInstance->QueueSteamTicketCheck(PendingTicketCheck);
+
+                    State = AuthClientState::WaitingForSteamTicketCheck;
+                }
+                else
+                {
+                    if (!SendGameServerInfo())
                     {
-                        WarningS(GetName().c_str(), "Disconnecting client as steam ticket authentication failed with error %i.", AuthResult);
                         return true;
                     }
-                    else
-                    {
-                        VerboseS(GetName().c_str(), "Client steam ticket authenticated successfully.");
-                    }
-                    SteamGameServer()->EndAuthSession(SteamIdStruct);
+                    State = AuthClientState::Complete;
                 }
+            }
+            break;
+        }
 
-                // If user IP is on a private network, we can assume they are on our LAN
-                // and return our internal IP address.
-                if (Connection->GetAddress().IsPrivateNetwork())
+    // Waiting for the main thread to validate the steam ticket.
+    case AuthClientState::WaitingForSteamTicketCheck:
+        {
+            if (PendingTicketCheck->Complete)
+            {
+                if (PendingTicketCheck->Result != k_EBeginAuthSessionResultOK)
                 {
-                    ServerIP = Service->GetServer()->GetPrivateIP().ToString();
-                    LogS(GetName().c_str(), "Directing auth client to our private ip (%s) as appears to be on private subnet.", ServerIP.c_str());
+                    WarningS(GetName().c_str(), "Disconnecting client as steam ticket authentication failed with error %i.", PendingTicketCheck->Result);
+                    return true;
                 }
 
-                Frpg2GameServerInfo GameInfo;
-                memset(GameInfo.stack_data, 0, sizeof(GameInfo.stack_data));
-                memset(GameInfo.game_server_ip, 0, sizeof(GameInfo.game_server_ip));
-                FillRandomBytes((uint8_t*)&GameInfo.auth_token, 8);
-                memcpy(GameInfo.game_server_ip, ServerIP.data(), ServerIP.size() + 1);
-                GameInfo.game_port = RuntimeConfig.GameServerPort;
-                GameInfo.SwapEndian();
+                VerboseS(GetName().c_str(), "Client steam ticket authenticated successfully.");
+                PendingTicketCheck = nullptr;
 
-                Frpg2Message Response;
-                Response.Payload.resize(sizeof(GameInfo));
-                memcpy(Response.Payload.data(), &GameInfo, sizeof(GameInfo));
-
-                if (!MessageStream->Send(Response, Frpg2MessageType::Reply, Message.Header.msg_index))
+                if (!SendGameServerInfo())
                 {
-                    WarningS(GetName().c_str(), "Disconnecting client as failed to game server info.");
                     return true;
                 }
-
-                // Store authentication state in game service.
-                std::shared_ptr<GameService> GameServiceInstance = Service->GetServer()->GetService<GameService>();
-                GameServiceInstance->CreateAuthToken(GameInfo.auth_token, GameCwcKey);
-
-                LastMessageRecievedTime = GetSeconds();
-
-                VerboseS(GetName().c_str(), "Authentication complete.");
                 State = AuthClientState::Complete;
             }
             break;
@@ -300,6 +289,48 @@ bool AuthClient::Poll()
     return false;
 }
 
+bool AuthClient::SendGameServerInfo()
+{
+    const RuntimeConfig& RuntimeConfig = Service->GetServer()->GetConfig();
+    std::string ServerIP = Service->GetServer()->GetPublicIP().ToString();
+
+    // If user IP is on a private network, we can assume they are on our LAN
+    // and return our internal IP address.
+    if (Connection->GetAddress().IsPrivateNetwork())
+    {
+        ServerIP = Service->GetServer()->GetPrivateIP().ToString();
+        LogS(GetName().c_str(), "Directing auth client to our private ip (%s) as appears to be on private subnet.", ServerIP.c_str());
+    }
+
+    Frpg2GameServerInfo GameInfo;
+    memset(GameInfo.stack_data, 0, sizeof(GameInfo.stack_data));
+    memset(GameInfo.game_server_ip, 0, sizeof(GameInfo.game_server_ip));
+    FillRandomBytes((uint8_t*)&GameInfo.auth_token, 8);
+    memcpy(GameInfo.game_server_ip, ServerIP.data(), ServerIP.size() + 1);
+    GameInfo.game_port = RuntimeConfig.GameServerPort;
+    GameInfo.SwapEndian();
+
+    // Store authentication state in game service. It is picked up on the game service's
+    // next poll, so do it before the client is told where to connect.
+    std::shared_ptr<GameService> GameServiceInstance = Service->GetServer()->GetService<GameService>();
+    GameServiceInstance->CreateAuthToken(GameInfo.auth_token, GameCwcKey);
+
+    Frpg2Message Response;
+    Response.Payload.resize(sizeof(GameInfo));
+    memcpy(Response.Payload.data(), &GameInfo, sizeof(GameInfo));
+
+    if (!MessageStream->Send(Response, Frpg2MessageType::Reply, SteamTicketMessageIndex))
+    {
+        WarningS(GetName().c_str(), "Disconnecting client as failed to game server info.");
+        return false;
+    }
+
+    LastMessageRecievedTime = GetSeconds();
+
+    VerboseS(GetName().c_str(), "Authentication complete.");
+    return true;
+}
+
 std::string AuthClient::GetName()
 {
     return Connection->GetName();
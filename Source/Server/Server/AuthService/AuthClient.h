@@ -20,6 +20,7 @@ class NetConnection;
 class Frpg2PacketStream;
 class Frpg2MessageStream;
 class RSAKeyPair;
+struct SteamTicketCheck;
 
 // Response data sent in as part of the authentication flow. No idea
 // why they didn't just use a protobuf for this.
@@ -75,6 +76,7 @@ enum class AuthClientState
     WaitingForServiceStatusRequest,
     WaitingForKeyData,
     WaitingForSteamTicket,
+    WaitingForSteamTicketCheck,
     Complete,
 };
 
@@ -89,6 +91,11 @@ public:
 
     std::string GetName();
 
+protected:
+
+    // Sends the game server's address and a new auth token, in reply to the steam ticket.
+    bool SendGameServerInfo();
+
 private:    
     AuthService* Service;
 
@@ -102,6 +109,9 @@ private:
 
     std::string SteamId;
 
+    uint32_t SteamTicketMessageIndex = 0;
+    std::shared_ptr<SteamTicketCheck> PendingTicketCheck;
+
     AuthClientState State = AuthClientState::WaitingForHandshakeRequest;
 
 };
\ No newline at end of file
@@ -38,6 +38,9 @@ public:
 
     virtual std::string GetName() override;
 
+    // Handshakes and accept storms are kept away from the game service's main loop.
+    virtual bool HasOwnThread() override { return true; }
+
     Server* GetServer() { return ServerInstance; }
 
 protected:
@@ -0,0 +1,112 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Server/Database/DatabaseExecutor.h"
+#include "Server/Database/ServerDatabase.h"
+#include "Core/Utils/DebugObjects.h"
+#include "Config/BuildConfig.h"
+
+#include <chrono>
+
+DatabaseExecutor::DatabaseExecutor(ServerDatabase& InDatabase)
+    : Database(InDatabase)
+{
+    if constexpr (BuildConfig::EMULATE_SLOW_DATABASE)
+    {
+        EmulatedQueryTime = BuildConfig::SLOW_DATABASE_QUERY_TIME;
+    }
+
+    Worker = std::thread([this]() { WorkerMain(); });
+}
+
+DatabaseExecutor::~DatabaseExecutor()
+{
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        Quit = true;
+    }
+    QueueSignal.notify_all();
+
+    // Worker finishes off anything still queued before exiting, so no writes are lost
+    // on shutdown. Completions for them are dropped.
+    Worker.join();
+}
+
+void DatabaseExecutor::Queue(std::function<void(ServerDatabase& Database)>&& Query, std::function<void()>&& Completion)
+{
+    Debug::DatabaseQueriesDeferred.Add(1.0f);
+
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        PendingJobs.push_back({ std::move(Query), std::move(Completion) });
+    }
+    QueueSignal.notify_one();
+}
+
+void DatabaseExecutor::AddStatistic(const std::string& Key, uint32_t PlayerId, int64_t Count)
+{
+    Run([Key, PlayerId, Count](ServerDatabase& Database) {
+        Database.AddGlobalStatistic(Key, Count);
+        Database.AddPlayerStatistic(Key, PlayerId, Count);
+    });
+}
+
+void DatabaseExecutor::Poll()
+{
+    std::vector<std::function<void()>> Finished;
+
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        Finished.swap(Completions);
+    }
+
+    for (std::function<void()>& Completion : Finished)
+    {
+        Completion();
+    }
+}
+
+void DatabaseExecutor::SetEmulatedQueryTime(double Milliseconds)
+{
+    EmulatedQueryTime = Milliseconds;
+}
+
+void DatabaseExecutor::WorkerMain()
+{
+    while (true)
+    {
+        Job NextJob;
+
+        {
+            std::unique_lock<std::mutex> Lock(QueueMutex);
+            QueueSignal.wait(Lock, [this]() { return Quit || !PendingJobs.empty(); });
+
+            if (PendingJobs.empty())
+            {
+                return;
+            }
+
+            NextJob = std::move(PendingJobs.front());
+            PendingJobs.pop_front();
+        }
+
+        if (double StallTime = EmulatedQueryTime; StallTime > 0.0)
+        {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(StallTime));
+        }
+
+        NextJob.Query(Database);
+
+        if (NextJob.Completion)
+        {
+            std::unique_lock<std::mutex> Lock(QueueMutex);
+            Completions.push_back(std::move(NextJob.Completion));
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include <coroutine>
+#include <condition_variable>
+
+class ServerDatabase;
+
+// Runs database queries on a dedicated thread so a slow disk doesn't stall
+// every connected player. Handlers queue the query along with a completion,
+// which is called with the result from the main thread once it has run.
+//
+// Queries run one at a time in the order they are queued, so a query always
+// sees the effects of anything queued before it.
+class DatabaseExecutor
+{
+public:
+    DatabaseExecutor(ServerDatabase& Database);
+    ~DatabaseExecutor();
+
+    // Queues Query to run on the database thread. Completion is called with
+    // whatever Query returned from the next Poll after it has run. Both are
+    // copied, so anything they need should be captured by value.
+    template <typename QueryType, typename CompletionType>
+    void Run(QueryType Query, CompletionType Completion)
+    {
+        using ResultType = std::invoke_result_t<QueryType&, ServerDatabase&>;
+
+        std::shared_ptr<ResultType> Result = std::make_shared<ResultType>();
+        Queue(
+            [Result, Query](ServerDatabase& Database) mutable { *Result = Query(Database); },
+            [Result, Completion]() mutable { Completion(*Result); }
+        );
+    }
+
+    // Queues a query whose result nobody is waiting on, eg. statistics.
+    template <typename QueryType>
+    void Run(QueryType Query)
+    {
+        Queue(Query, nullptr);
+    }
+
+    // Queues adding Count to both the global and the players value of a statistic.
+    void AddStatistic(const std::string& Key, uint32_t PlayerId, int64_t Count);
+
+    template <typename QueryType>
+    struct QueryAwaiter
+    {
+        using ResultType = std::invoke_result_t<QueryType&, ServerDatabase&>;
+
+        DatabaseExecutor* Executor;
+        QueryType Query;
+        ResultType Result;
+
+        bool await_ready() { return false; }
+        ResultType await_resume() { return std::move(Result); }
+
+        void await_suspend(std::coroutine_handle<> Handle)
+        {
+            Executor->Run(Query, [this, Handle](const ResultType& QueryResult) {
+                Result = QueryResult;
+                Handle.resume();
+            });
+        }
+    };
+
+    // co_await this from a Task to run Query on the database thread. The task is
+    // resumed with whatever Query returned from the next Poll after it has run.
+    template <typename QueryType>
+    QueryAwaiter<QueryType> Query(QueryType InQuery)
+    {
+        return QueryAwaiter<QueryType>{ this, std::move(InQuery), {} };
+    }
+
+    // Calls the completions for any queries that have finished.
+    void Poll();
+
+    // Stalls the worker this many milliseconds before each query to emulate a slow disk. Defaults
+    // to SLOW_DATABASE_QUERY_TIME if EMULATE_SLOW_DATABASE is set in the build config.
+    void SetEmulatedQueryTime(double Milliseconds);
+
+private:
+    void Queue(std::function<void(ServerDatabase& Database)>&& Query, std::function<void()>&& Completion);
+
+    void WorkerMain();
+
+private:
+    struct Job
+    {
+        std::function<void(ServerDatabase& Database)> Query;
+        std::function<void()> Completion;
+    };
+
+    ServerDatabase& Database;
+
+    std::mutex QueueMutex;
+    std::condition_variable QueueSignal;
+    std::deque<Job> PendingJobs;
+    std::vector<std::function<void()>> Completions;
+
+    std::thread Worker;
+    bool Quit = false;
+
+    std::atomic<double> EmulatedQueryTime = 0.0;
+
+};
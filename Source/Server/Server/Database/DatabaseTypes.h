@@ -19,7 +19,7 @@
 struct BloodMessage
 {
     uint32_t MessageId;
-    OnlineAreaId OnlineAreaId;
+    ::OnlineAreaId OnlineAreaId;
 
     uint32_t PlayerId;
     std::string PlayerSteamId;
@@ -36,7 +36,7 @@ struct BloodMessage
 struct Bloodstain
 {
     uint32_t BloodstainId;
-    OnlineAreaId OnlineAreaId;
+    ::OnlineAreaId OnlineAreaId;
 
     uint32_t PlayerId;
     std::string PlayerSteamId;
@@ -49,7 +49,7 @@ struct Bloodstain
 struct Ghost
 {
     uint32_t GhostId;
-    OnlineAreaId OnlineAreaId;
+    ::OnlineAreaId OnlineAreaId;
 
     uint32_t PlayerId;
     std::string PlayerSteamId;
@@ -61,7 +61,7 @@ struct Ghost
 struct SummonSign
 {
     uint32_t SignId;
-    OnlineAreaId OnlineAreaId;
+    ::OnlineAreaId OnlineAreaId;
 
     uint32_t PlayerId;
     std::string PlayerSteamId;
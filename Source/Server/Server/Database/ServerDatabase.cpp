@@ -165,6 +165,8 @@ bool ServerDatabase::CreateTables()
 
 bool ServerDatabase::RunStatement(const std::string& sql, const std::vector<DatabaseValue>& Values, RowCallback Callback)
 {
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     DebugTimerScope Scope(Debug::DatabaseQueryTime);
     Debug::DatabaseQueries.Add(1.0f);
 
@@ -174,7 +176,7 @@ bool ServerDatabase::RunStatement(const std::string& sql, const std::vector<Data
         Error("sqlite3_prepare_v2 failed with error: %s", sqlite3_errstr(result));
         return false;
     }
-    for (int i = 0; i < Values.size(); i++)
+    for (int i = 0; i < (int)Values.size(); i++)
     {
         const DatabaseValue& Value = Values[i];
         if (auto CastValue = std::get_if<std::string>(&Value))
@@ -263,6 +265,8 @@ bool ServerDatabase::RunStatement(const std::string& sql, const std::vector<Data
 
 bool ServerDatabase::FindOrCreatePlayer(const std::string& SteamId, uint32_t& PlayerId)
 {
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     PlayerId = 0;
 
     if (!RunStatement("SELECT PlayerId FROM Players WHERE PlayerSteamId = ?1", { SteamId }, [&PlayerId](sqlite3_stmt* statement) {
@@ -359,6 +363,8 @@ std::vector<std::shared_ptr<BloodMessage>> ServerDatabase::FindRecentBloodMessag
 
 std::shared_ptr<BloodMessage> ServerDatabase::CreateBloodMessage(OnlineAreaId AreaId, uint32_t PlayerId, const std::string& PlayerSteamId, uint32_t CharacterId, const std::vector<uint8_t>& Data)
 {
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     if (!RunStatement("INSERT INTO BloodMessages(OnlineAreaId, PlayerId, PlayerSteamId, CharacterId, RatingPoor, RatingGood, Data, CreatedTime) VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, datetime('now'))", { (uint32_t)AreaId, PlayerId, PlayerSteamId, CharacterId, 0, 0, Data }, nullptr))
     {
         return nullptr;
@@ -448,6 +454,8 @@ std::vector<std::shared_ptr<Bloodstain>> ServerDatabase::FindRecentBloodstains(O
 
 std::shared_ptr<Bloodstain> ServerDatabase::CreateBloodstain(OnlineAreaId AreaId, uint32_t PlayerId, const std::string& PlayerSteamId, const std::vector<uint8_t>& Data, const std::vector<uint8_t>& GhostData)
 {
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     if (!RunStatement("INSERT INTO Bloodstains(OnlineAreaId, PlayerId, PlayerSteamId, Data, GhostData, CreatedTime) VALUES(?1, ?2, ?3, ?4, ?5, datetime('now'))", { (uint32_t)AreaId, PlayerId, PlayerSteamId, Data, GhostData }, nullptr))
     {
         return nullptr;
@@ -491,6 +499,8 @@ std::vector<std::shared_ptr<Ghost>> ServerDatabase::FindRecentGhosts(OnlineAreaI
 
 std::shared_ptr<Ghost> ServerDatabase::CreateGhost(OnlineAreaId AreaId, uint32_t PlayerId, const std::string& PlayerSteamId, const std::vector<uint8_t>& Data)
 {
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     if (!RunStatement("INSERT INTO Ghosts(OnlineAreaId, PlayerId, PlayerSteamId, Data, CreatedTime) VALUES(?1, ?2, ?3, ?4, datetime('now'))", { (uint32_t)AreaId, PlayerId, PlayerSteamId, Data }, nullptr))
     {
         return nullptr;
@@ -513,6 +523,8 @@ void ServerDatabase::TrimGhosts(size_t MaxEntries)
 
 std::shared_ptr<Ranking> ServerDatabase::RegisterScore(uint32_t BoardId, uint32_t PlayerId, uint32_t CharacterId, uint32_t Score, const std::vector<uint8_t>& Data)
 {
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     // Delete existing ranking.
     if (!RunStatement("DELETE FROM Rankings WHERE BoardId = ?1 AND PlayerId = ?2 AND CharacterId = ?3", { BoardId, PlayerId, CharacterId }, nullptr))
     {
@@ -542,8 +554,6 @@ std::shared_ptr<Ranking> ServerDatabase::RegisterScore(uint32_t BoardId, uint32_
     RunStatement("SELECT ScoreId, Score FROM Rankings WHERE BoardId = ?1 ORDER BY Score DESC, CreatedTime ASC", { BoardId }, [&CurrentRank, &CurrentRankScore, &CurrentSerialRank, &ScoreRanks, NewRankingId, &NewRank, &NewSerialRank] (sqlite3_stmt* statement) {
         uint32_t ScoreId = sqlite3_column_int(statement, 0);
         uint32_t Score = sqlite3_column_int(statement, 1);
-        uint32_t ScoreRank = 0;
-        uint32_t ScoreSerialRank = 0;
 
         if (CurrentSerialRank == 1)
         {
@@ -645,6 +655,8 @@ uint32_t ServerDatabase::GetRankingCount(uint32_t BoardId)
 
 bool ServerDatabase::CreateOrUpdateCharacter(uint32_t PlayerId, uint32_t CharacterId, const std::vector<uint8_t>& Data)
 {
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     if (!RunStatement("UPDATE Characters SET Data = ?3 WHERE PlayerId = ?1 AND CharacterId = ?2", { PlayerId, CharacterId, Data }, nullptr))
     {
         return false;
@@ -714,6 +726,8 @@ void ServerDatabase::AddStatistic(const std::string& Name, const std::string& Sc
         return;
     }
 
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     if (!RunStatement("UPDATE Statistics SET Value = Value + ?3 WHERE Name = ?1 AND Scope = ?2", { Name, Scope, Count }, nullptr))
     {
         return;
@@ -735,6 +749,8 @@ void ServerDatabase::SetStatistic(const std::string& Name, const std::string& Sc
         return;
     }
 
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     if (!RunStatement("UPDATE Statistics SET Value = ?3 WHERE Name = ?1 AND Scope = ?2", { Name, Scope, Count }, nullptr))
     {
         return;
@@ -836,6 +852,8 @@ int64_t ServerDatabase::GetPlayerStatistic(const std::string& Name, uint32_t Pla
 
 void ServerDatabase::TrimTable(const std::string& TableName, const std::string& IdColumn, size_t MaxEntries)
 {
+    std::lock_guard<std::recursive_mutex> Lock(Mutex);
+
     size_t TotalEntries = 0;
 
     RunStatement("SELECT COUNT(*) FROM " + TableName, { }, [&TotalEntries](sqlite3_stmt* statement) {
@@ -12,6 +12,7 @@
 #include <filesystem>
 #include <functional>
 #include <variant>
+#include <mutex>
 
 #include "Server/Database/DatabaseTypes.h"
 
@@ -19,6 +20,9 @@ struct sqlite3;
 struct sqlite3_stmt;
 
 // Interface to the sqlite database.
+//
+// Safe to call from multiple threads, queries are serialized. Anything that shouldn't
+// block the main thread should be queued on the DatabaseExecutor instead.
 
 class ServerDatabase
 {
@@ -185,4 +189,8 @@ protected:
 private:
     sqlite3* db_handle = nullptr;
 
+    // Recursive as functions that run several statements (or read the last inserted 
+    // row id) hold it across all of them.
+    std::recursive_mutex Mutex;
+
 };
\ No newline at end of file
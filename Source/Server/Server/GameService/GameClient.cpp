@@ -10,6 +10,7 @@
 #include "Server/GameService/GameClient.h"
 #include "Server/GameService/GameService.h"
 #include "Server/GameService/GameManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 
@@ -34,10 +35,47 @@ GameClient::GameClient(GameService* OwningService, std::shared_ptr<NetConnection
     LastMessageRecievedTime = GetSeconds();
 
     MessageStream = std::make_shared<Frpg2ReliableUdpMessageStream>(InConnection, CwcKey, AuthToken);
+
+    // Packets are encrypted and sent in bulk by the game service at the end of each tick. Anything 
+    // sent to us outside our own poll (push messages from other players etc) needs us polled to 
+    // handle the acks/resends.
+    MessageStream->SetBatchSends(true);
+    MessageStream->SetBatchStartedCallback([this]() {
+        Service->MarkClientReady(this);
+    });
+}
+
+void GameClient::PumpNetwork()
+{
+    HasPumpedNetwork = true;
+
+    ConnectionInErrorState = Connection->Pump();
+    MessageStreamClosed = false;
+
+    if (!ConnectionInErrorState && Connection->IsConnected())
+    {
+        MessageStreamClosed = MessageStream->Pump();
+    }
+}
+
+bool GameClient::HasPendingWork()
+{
+    return Connection->HasPendingData() || MessageStream->HasPendingWork();
+}
+
+double GameClient::GetNextPollTime()
+{
+    if (DisconnectTime > 0.0 && DisconnectTime < NextIdlePollTime)
+    {
+        return DisconnectTime;
+    }
+    return NextIdlePollTime;
 }
 
 bool GameClient::Poll()
 {
+    NextIdlePollTime = GetSeconds() + BuildConfig::IDLE_CLIENT_POLL_INTERVAL;
+
     // Has this client timed out?
     double TimeSinceLastMessage = GetSeconds() - LastMessageRecievedTime;
     if (TimeSinceLastMessage >= BuildConfig::CLIENT_TIMEOUT)
@@ -53,8 +91,14 @@ bool GameClient::Poll()
         return true;
     }
 
+    if (!HasPumpedNetwork)
+    {
+        PumpNetwork();
+    }
+    HasPumpedNetwork = false;
+
     // Client disconnected.
-    if (Connection->Pump())
+    if (ConnectionInErrorState)
     {
         WarningS(GetName().c_str(), "Disconnecting client as connection was in an error state.");
         return true;
@@ -65,8 +109,8 @@ bool GameClient::Poll()
         return true;
     }
 
-    // Pump the message stream and handle any messages that come in.
-    if (MessageStream->Pump())
+    // Handle any messages that came in.
+    if (MessageStreamClosed)
     {
         WarningS(GetName().c_str(), "Disconnecting client as message stream closed.");
         return true;
@@ -76,7 +120,11 @@ bool GameClient::Poll()
     Frpg2ReliableUdpMessage Message;
     while (MessageStream->Recieve(&Message))
     {
-        if (HandleMessage(Message))
+        HandlingAckSequenceIndex = Message.AckSequenceIndex;
+        bool HandleFailed = HandleMessage(Message);
+        HandlingAckSequenceIndex = 0;
+
+        if (HandleFailed)
         {
             if (BuildConfig::DISCONNECT_ON_UNHANDLED_MESSAGE)
             {
@@ -106,6 +154,13 @@ bool GameClient::HandleMessage(const Frpg2ReliableUdpMessage& Message)
 {
     //WarningS(GetName().c_str(), "-> %s", Message.Protobuf->GetTypeName().c_str());
 
+    MessageHandleResult DispatchResult = Service->GetMessageDispatcher().Dispatch(this, Message);
+    if (DispatchResult != MessageHandleResult::Unhandled)
+    {
+        return DispatchResult == MessageHandleResult::Error;
+    }
+
+    // Nothing registered for this message type, give managers a chance to handle it manually.
     const std::vector<std::shared_ptr<GameManager>>& Managers = Service->GetManagers();
     for (auto& Manager : Managers)
     {
@@ -132,9 +187,8 @@ std::string GameClient::GetName()
     return Connection->GetName();
 }
 
-void GameClient::SendTextMessage(const std::string& TextMessage)
+void GameClient::BuildTextMessage(const std::string& TextMessage, Frpg2RequestMessage::ManagementTextMessage& Message)
 {
-    Frpg2RequestMessage::ManagementTextMessage Message;
     Message.set_push_message_id(Frpg2RequestMessage::PushID_ManagementTextMessage);
     Message.set_message(TextMessage);
     Message.set_unknown_4(0);
@@ -149,9 +203,51 @@ void GameClient::SendTextMessage(const std::string& TextMessage)
     DateTime->set_minutes(0);
     DateTime->set_seconds(0);
     DateTime->set_tzdiff(0);
+}
+
+bool GameClient::SendDeferredResponse(google::protobuf::MessageLite* Response, const Frpg2ReliableUdpMessage& ResponseTo)
+{
+    if (IsDisconnecting)
+    {
+        return false;
+    }
+
+    // Once the message's packet has been acked the response has to go out as plain data.
+    const Frpg2ReliableUdpMessage* Target = &ResponseTo;
+    Frpg2ReliableUdpMessage DeferredTarget;
+    if (ResponseTo.AckSequenceIndex != 0 && ResponseTo.AckSequenceIndex != HandlingAckSequenceIndex)
+    {
+        DeferredTarget = MakeDeferredResponseTarget(ResponseTo);
+        Target = &DeferredTarget;
+    }
+
+    if (!MessageStream->Send(Response, Target))
+    {
+        WarningS(GetName().c_str(), "Disconnecting client as failed to send deferred %s response.", Response->GetTypeName().c_str());
+        DisconnectTime = GetSeconds();
+        return false;
+    }
+
+    return true;
+}
+
+Frpg2ReliableUdpMessage GameClient::MakeDeferredResponseTarget(const Frpg2ReliableUdpMessage& Message)
+{
+    // The packet the message arrived in has already been acked by the time the response
+    // goes out, so only the message index is kept and the response is sent as plain data
+    // rather than piggybacking the ack again.
+    Frpg2ReliableUdpMessage Result;
+    Result.Header = Message.Header;
+    return Result;
+}
+
+void GameClient::SendTextMessage(const std::string& TextMessage)
+{
+    Frpg2RequestMessage::ManagementTextMessage Message;
+    BuildTextMessage(TextMessage, Message);
 
     if (!MessageStream->Send(&Message))
     {
         WarningS(GetName().c_str(), "Failed to send game client text message.");
     }
-}
\ No newline at end of file
+}
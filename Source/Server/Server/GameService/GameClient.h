@@ -25,11 +25,24 @@ struct SummonSign;
 
 // Represents an individual client connected to the game service.
 
-class GameClient 
+class GameClient : public std::enable_shared_from_this<GameClient>
 {
 public:
     GameClient(GameService* OwningService, std::shared_ptr<NetConnection> InConnection, const std::vector<uint8_t>& CwcKey, uint64_t AuthToken);
 
+    // Recieves anything pending on the connection and decrypts/reassembles it ready
+    // for the next Poll. Only touches this clients own state, so can be called from
+    // a worker thread. Poll will do this itself if it hasn't been called.
+    void PumpNetwork();
+
+    // Returns true if the client still has something to do next tick; data waiting to 
+    // be recieved or packets waiting on acks. Otherwise it's left alone until data arrives,
+    // something is sent to it, or GetNextPollTime comes around.
+    bool HasPendingWork();
+
+    // When the client next needs to be polled even if nothing happens, to check timeouts etc.
+    double GetNextPollTime();
+
     // If this returns true the client is expected to be disconnected and is disposed of.
     bool Poll();
 
@@ -39,9 +52,27 @@ public:
 
     double GetConnectionDuration() { return GetSeconds() - ConnectTime; }
 
+    // False once the game service has started disconnecting the client. Deferred work can
+    // still be holding on to it after that, but shouldn't send it anything.
+    bool IsConnected() const { return !IsDisconnecting; }
+
+    // Sends a response to a message whose handler has already returned, eg. once a deferred 
+    // database query has completed. If the send fails the client is flagged for disconnect.
+    // Nothing is sent, and false is returned, if the client has already disconnected.
+    // If it's called while the message is still being handled, eg. by a task that didn't 
+    // need to suspend, the response piggybacks the ack of the packet the message came in.
+    bool SendDeferredResponse(google::protobuf::MessageLite* Response, const Frpg2ReliableUdpMessage& ResponseTo);
+
+    // Takes what SendDeferredResponse needs from a recieved message, so the handler
+    // doesn't have to keep the whole message alive.
+    static Frpg2ReliableUdpMessage MakeDeferredResponseTarget(const Frpg2ReliableUdpMessage& Message);
+
     // Sends a text message displayed at the top of the users screen.
     void SendTextMessage(const std::string& Message);
 
+    // Fills in the push message used to display a text message at the top of the users screen.
+    static void BuildTextMessage(const std::string& Message, Frpg2RequestMessage::ManagementTextMessage& Output);
+
 public:
 
     std::shared_ptr<NetConnection> Connection;
@@ -63,14 +94,33 @@ protected:
     bool PollInner();
 
 private:    
+    friend class GameService;
+
     GameService* Service;
 
     uint64_t AuthToken;
 
     bool IsDisconnecting = false;
 
+    // Ack sequence of the packet whose message is being handled, 0 outside of HandleMessage.
+    uint32_t HandlingAckSequenceIndex = 0;
+
+    // What this client is currently registered under in the game services lookups.
+    uint32_t IndexedPlayerId = 0;
+    std::string IndexedSteamId;
+    OnlineAreaId IndexedArea = OnlineAreaId::None;
+
     double LastMessageRecievedTime = 0.0;
 
+    // Idle clients are still polled occasionally to check for timeouts and keep
+    // their auth token alive.
+    double NextIdlePollTime = 0.0;
+
+    // Results of the last PumpNetwork, consumed by Poll.
+    bool HasPumpedNetwork = false;
+    bool ConnectionInErrorState = false;
+    bool MessageStreamClosed = false;
+
     PlayerState State;
 
 };
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include <string>
 
 class GameClient;
+class GameMessageDispatcher;
 struct Frpg2ReliableUdpMessage;
 
 enum class MessageHandleResult
@@ -45,7 +46,12 @@ public:
     // Called when we have a lost a player previously registered with OnGainPlayer.
     virtual void OnLostPlayer(GameClient* Client) { };
 
-    // Called when a game client recieves a message.
+    // Called once during initialization so the manager can register handlers for the 
+    // message types it is responsible for.
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) { };
+
+    // Called when a game client recieves a message that has no handler registered
+    // in the message dispatcher.
     // Returns true if an error occured and the client should be disconnected.
     virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) { return MessageHandleResult::Unhandled; }
 
@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/BloodMessage/BloodMessageManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -69,243 +70,276 @@ void BloodMessageManager::TrimDatabase()
     Database.TrimBloodMessages(MaxEntries);
 }
 
-MessageHandleResult BloodMessageManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void BloodMessageManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestReentryBloodMessage)
-    {
-        return Handle_RequestReentryBloodMessage(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetBloodMessageEvaluation)
-    {
-        return Handle_RequestGetBloodMessageEvaluation(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateBloodMessage)
-    {
-        return Handle_RequestCreateBloodMessage(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRemoveBloodMessage)
-    {
-        return Handle_RequestRemoveBloodMessage(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetBloodMessageList)
-    {
-        return Handle_RequestGetBloodMessageList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestEvaluateBloodMessage)
-    {
-        return Handle_RequestEvaluateBloodMessage(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestReCreateBloodMessageList)
-    {
-        return Handle_RequestReCreateBloodMessageList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestReentryBloodMessage, this, &BloodMessageManager::Handle_RequestReentryBloodMessage);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetBloodMessageEvaluation, this, &BloodMessageManager::Handle_RequestGetBloodMessageEvaluation);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateBloodMessage, this, &BloodMessageManager::Handle_RequestCreateBloodMessage);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRemoveBloodMessage, this, &BloodMessageManager::Handle_RequestRemoveBloodMessage);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetBloodMessageList, this, &BloodMessageManager::Handle_RequestGetBloodMessageList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestEvaluateBloodMessage, this, &BloodMessageManager::Handle_RequestEvaluateBloodMessage);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestReCreateBloodMessageList, this, &BloodMessageManager::Handle_RequestReCreateBloodMessageList);
 }
 
 MessageHandleResult BloodMessageManager::Handle_RequestReentryBloodMessage(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
-
     Frpg2RequestMessage::RequestReentryBloodMessage* Request = (Frpg2RequestMessage::RequestReentryBloodMessage*)Message.Protobuf.get();
 
-    Frpg2RequestMessage::RequestReentryBloodMessageResponse Response;
-    auto RecreateMessageIds = Response.mutable_recreate_message_ids();
+    std::vector<std::pair<OnlineAreaId, uint32_t>> Requested;
+    for (int i = 0; i < Request->messages_size(); i++)
+    {
+        const Frpg2RequestMessage::LocatedBloodMessage& Message = Request->messages(i);
+        Requested.push_back({ static_cast<OnlineAreaId>(Message.online_area_id()), Message.message_id() });
+    }
 
     // Go through all ids, if they are already in the live pool, do nothing, if they
     // are in the database, move them to the live pool, if they don't exist in either
     // ask for them to be recreated.
-    for (int i = 0; i < Request->messages_size(); i++)
-    {
-        const Frpg2RequestMessage::LocatedBloodMessage& Message = Request->messages(i);
-        
-        OnlineAreaId OnlineArea = static_cast<OnlineAreaId>(Message.online_area_id());
-        uint32_t Id = Message.message_id();
+    FindMessages(Client, Message, Requested, 
+        [Requested](GameClient* Client, const std::vector<std::shared_ptr<BloodMessage>>& Found, const Frpg2ReliableUdpMessage& ResponseTarget) {
+            Frpg2RequestMessage::RequestReentryBloodMessageResponse Response;
+            auto RecreateMessageIds = Response.mutable_recreate_message_ids();
 
-        if (!LiveCache.Contains(OnlineArea, Id))
-        {            
-            if (std::shared_ptr<BloodMessage> DatabaseBloodMessage = Database.FindBloodMessage(Id))
-            {
-                LiveCache.Add(OnlineArea, Id, DatabaseBloodMessage);
-            }
-            else
+            for (size_t i = 0; i < Requested.size(); i++)
             {
-                LogS(Client->GetName().c_str(), "Requesting client to recreate message %i.", Id);
-                RecreateMessageIds->Add(Id);
+                if (!Found[i])
+                {
+                    uint32_t Id = Requested[i].second;
+                    LogS(Client->GetName().c_str(), "Requesting client to recreate message %i.", Id);
+                    RecreateMessageIds->Add(Id);
+                }
             }
-        }
-    }
 
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestReentryBloodMessageResponse response.");
-        return MessageHandleResult::Error;
-    }
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
     
     return MessageHandleResult::Handled;
 }
 
 MessageHandleResult BloodMessageManager::Handle_RequestReCreateBloodMessageList(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
     
     Frpg2RequestMessage::RequestReCreateBloodMessageList* Request = (Frpg2RequestMessage::RequestReCreateBloodMessageList*)Message.Protobuf.get();
 
-    Frpg2RequestMessage::RequestReCreateBloodMessageListResponse Response;
-    auto CreatedMessageIds = Response.mutable_message_ids();
+    struct RecreateInfo
+    {
+        OnlineAreaId AreaId;
+        std::vector<uint8_t> Data;
+    };
 
-    // Recreate all the messages passed through by the client.
+    std::vector<RecreateInfo> ToRecreate;
     for (int i = 0; i < Request->blood_message_info_list_size(); i++)
     {
         const Frpg2RequestMessage::RequestReCreateBloodMessageList_Blood_message_info_list& MessageInfo = Request->blood_message_info_list(i);
 
-        std::vector<uint8_t> MessageData;
-        MessageData.assign(MessageInfo.message_data().data(), MessageInfo.message_data().data() + MessageInfo.message_data().size());
+        RecreateInfo& Info = ToRecreate.emplace_back();
+        Info.AreaId = (OnlineAreaId)MessageInfo.online_area_id();
+        Info.Data.assign(MessageInfo.message_data().data(), MessageInfo.message_data().data() + MessageInfo.message_data().size());
+    }
 
-        // Create the message in the database.
-        std::shared_ptr<BloodMessage> BloodMessage = Database.CreateBloodMessage((OnlineAreaId)MessageInfo.online_area_id(), Player.GetPlayerId(), Player.GetSteamId(), Request->character_id(), MessageData);
-        if (!BloodMessage)
-        {
-            WarningS(Client->GetName().c_str(), "Failed to recreate blood message.");
-            continue;
-        }
+    uint32_t PlayerId = Player.GetPlayerId();
+    std::string SteamId = Player.GetSteamId();
+    uint32_t CharacterId = Request->character_id();
 
-        LogS(Client->GetName().c_str(), "Recreated message %i.", BloodMessage->MessageId);
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
 
-        LiveCache.Add(BloodMessage->OnlineAreaId, BloodMessage->MessageId, BloodMessage);
-        CreatedMessageIds->Add(BloodMessage->MessageId);
-    }
+    // Recreate all the messages passed through by the client on the database thread. Any that fail 
+    // are left out of the response.
+    ServerInstance->GetDatabaseExecutor().Run(
+        [ToRecreate, PlayerId, SteamId, CharacterId](ServerDatabase& Database) {
+            std::vector<std::shared_ptr<BloodMessage>> Result;
+            for (const RecreateInfo& Info : ToRecreate)
+            {
+                if (std::shared_ptr<BloodMessage> Created = Database.CreateBloodMessage(Info.AreaId, PlayerId, SteamId, CharacterId, Info.Data))
+                {
+                    Result.push_back(Created);
+                }
+            }
+            return Result;
+        },
+        [this, WeakClient, ResponseTarget, ExpectedCount = ToRecreate.size()](std::vector<std::shared_ptr<BloodMessage>> Created) {
+            for (std::shared_ptr<BloodMessage>& BloodMessage : Created)
+            {
+                LiveCache.Add(BloodMessage->OnlineAreaId, BloodMessage->MessageId, BloodMessage);
+            }
 
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestReCreateBloodMessageListResponse response.");
-        return MessageHandleResult::Error;
-    }
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
+
+            if (Created.size() != ExpectedCount)
+            {
+                WarningS(Client->GetName().c_str(), "Failed to recreate %zi blood messages.", ExpectedCount - Created.size());
+            }
+
+            Frpg2RequestMessage::RequestReCreateBloodMessageListResponse Response;
+            auto CreatedMessageIds = Response.mutable_message_ids();
+
+            for (std::shared_ptr<BloodMessage>& BloodMessage : Created)
+            {
+                LogS(Client->GetName().c_str(), "Recreated message %i.", BloodMessage->MessageId);
+                CreatedMessageIds->Add(BloodMessage->MessageId);
+            }
+
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
 
 MessageHandleResult BloodMessageManager::Handle_RequestGetBloodMessageEvaluation(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
-    PlayerState& Player = Client->GetPlayerState();
-
     Frpg2RequestMessage::RequestGetBloodMessageEvaluation* Request = (Frpg2RequestMessage::RequestGetBloodMessageEvaluation*)Message.Protobuf.get();
 
-    Frpg2RequestMessage::RequestGetBloodMessageEvaluationResponse Response;
-    auto MessageEvaluation = Response.mutable_messages();
-
-    // Grab the current rating for every message, first from live if possible, then database.
+    std::vector<std::pair<OnlineAreaId, uint32_t>> Requested;
     for (int i = 0; i < Request->messages_size(); i++)
     {
         const Frpg2RequestMessage::LocatedBloodMessage& MessageInfo = Request->messages(i);
+        Requested.push_back({ (OnlineAreaId)MessageInfo.online_area_id(), MessageInfo.message_id() });
+    }
 
-        Frpg2RequestMessage::BloodMessageEvaluationData& EvalData = *MessageEvaluation->Add();
-        EvalData.set_message_id(MessageInfo.message_id());
+    // Grab the current rating for every message, first from live if possible, then database.
+    FindMessages(Client, Message, Requested, 
+        [Requested](GameClient* Client, const std::vector<std::shared_ptr<BloodMessage>>& Found, const Frpg2ReliableUdpMessage& ResponseTarget) {
+            Frpg2RequestMessage::RequestGetBloodMessageEvaluationResponse Response;
+            auto MessageEvaluation = Response.mutable_messages();
 
-        // Try live cache first.
-        if (std::shared_ptr<BloodMessage> ActiveMessage = LiveCache.Find((OnlineAreaId)MessageInfo.online_area_id(), MessageInfo.message_id()))
-        {
-            EvalData.set_good(ActiveMessage->RatingGood);
-            EvalData.set_poor(ActiveMessage->RatingPoor);
-        }
-        // Otherwise fall back to database.
-        else if (std::shared_ptr<BloodMessage> ActiveMessage = Database.FindBloodMessage(MessageInfo.message_id()))
-        {
-            EvalData.set_good(ActiveMessage->RatingGood);
-            EvalData.set_poor(ActiveMessage->RatingPoor);
+            for (size_t i = 0; i < Requested.size(); i++)
+            {
+                Frpg2RequestMessage::BloodMessageEvaluationData& EvalData = *MessageEvaluation->Add();
+                EvalData.set_message_id(Requested[i].second);
+
+                if (const std::shared_ptr<BloodMessage>& ActiveMessage = Found[i])
+                {
+                    EvalData.set_good(ActiveMessage->RatingGood);
+                    EvalData.set_poor(ActiveMessage->RatingPoor);
+                }
+                // If we can't find it, just return 0 evaluation, this shouldn't happen in practice.
+                else
+                {
+                    WarningS(Client->GetName().c_str(), "Client requested evaluation of unknown message id '%u', returning 0.", Requested[i].second);
+                    EvalData.set_good(0);
+                    EvalData.set_poor(0);
+                }
+            }
 
-            LiveCache.Add(ActiveMessage->OnlineAreaId, ActiveMessage->MessageId, ActiveMessage);
-        }
-        // If we can't find it, just return 0 evaluation, this shouldn't happen in practice.
-        else
-        {
-            WarningS(Client->GetName().c_str(), "Client requested evaluation of unknown message id '%u', returning 0.", MessageInfo.message_id());
-            EvalData.set_good(0);
-            EvalData.set_poor(0);
+            Client->SendDeferredResponse(&Response, ResponseTarget);
         }
-    }
-
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestGetBloodMessageEvaluationResponse response.");
-        return MessageHandleResult::Error;
-    }
+    );
 
     return MessageHandleResult::Handled;
 }
 
 MessageHandleResult BloodMessageManager::Handle_RequestCreateBloodMessage(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestCreateBloodMessage* Request = (Frpg2RequestMessage::RequestCreateBloodMessage*)Message.Protobuf.get();
 
-    Frpg2RequestMessage::RequestCreateBloodMessageResponse Response;
-
     std::vector<uint8_t> MessageData;
     MessageData.assign(Request->message_data().data(), Request->message_data().data() + Request->message_data().size());
 
-    if (std::shared_ptr<BloodMessage> ActiveMessage = Database.CreateBloodMessage((OnlineAreaId)Request->online_area_id(), Player.GetPlayerId(), Player.GetSteamId(), Request->character_id(), MessageData))
-    {
-        Response.set_message_id(ActiveMessage->MessageId);
+    OnlineAreaId AreaId = (OnlineAreaId)Request->online_area_id();
+    uint32_t PlayerId = Player.GetPlayerId();
+    std::string SteamId = Player.GetSteamId();
+    uint32_t CharacterId = Request->character_id();
 
-        LiveCache.Add(ActiveMessage->OnlineAreaId, ActiveMessage->MessageId, ActiveMessage);
-    }
-    else
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to create blood message.");
-        return MessageHandleResult::Error;
-    }
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
 
-    std::string TypeStatisticKey = StringFormat("BloodMessage/TotalCreated");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
-    
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestCreateBloodMessageResponse response.");
-        return MessageHandleResult::Error;
-    }
+    // The response needs the new message id, so wait for the database thread to store it.
+    ServerInstance->GetDatabaseExecutor().Run(
+        [AreaId, PlayerId, SteamId, CharacterId, MessageData](ServerDatabase& Database) {
+            std::shared_ptr<BloodMessage> Result = Database.CreateBloodMessage(AreaId, PlayerId, SteamId, CharacterId, MessageData);
+            if (Result)
+            {
+                std::string TypeStatisticKey = StringFormat("BloodMessage/TotalCreated");
+                Database.AddGlobalStatistic(TypeStatisticKey, 1);
+                Database.AddPlayerStatistic(TypeStatisticKey, PlayerId, 1);
+            }
+            return Result;
+        },
+        [this, WeakClient, ResponseTarget](std::shared_ptr<BloodMessage> ActiveMessage) {
+            if (ActiveMessage)
+            {
+                LiveCache.Add(ActiveMessage->OnlineAreaId, ActiveMessage->MessageId, ActiveMessage);
+            }
+
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
+
+            if (!ActiveMessage)
+            {
+                WarningS(Client->GetName().c_str(), "Disconnecting client as failed to create blood message.");
+                Client->DisconnectTime = GetSeconds();
+                return;
+            }
+
+            Frpg2RequestMessage::RequestCreateBloodMessageResponse Response;
+            Response.set_message_id(ActiveMessage->MessageId);
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
 
 MessageHandleResult BloodMessageManager::Handle_RequestRemoveBloodMessage(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestRemoveBloodMessage* Request = (Frpg2RequestMessage::RequestRemoveBloodMessage*)Message.Protobuf.get();
 
     LogS(Client->GetName().c_str(), "Removing blood message %i.", Request->message_id());
 
-    if (Database.RemoveOwnBloodMessage(Player.GetPlayerId(), Request->message_id()))
-    {
-        LiveCache.Remove((OnlineAreaId)Request->online_area_id(), Request->message_id());
-    }
-    else
-    {
-        WarningS(Client->GetName().c_str(), "Failed to remove blood message.");
-    }
+    OnlineAreaId AreaId = (OnlineAreaId)Request->online_area_id();
+    uint32_t MessageId = Request->message_id();
 
-    // Empty response, not sure what purpose this serves really other than saying message-recieved. Client
-    // doesn't work without it though.
-    Frpg2RequestMessage::RequestRemoveBloodMessageResponse Response;
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestRemoveBloodMessageResponse response.");
-        return MessageHandleResult::Error;
-    }
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
+
+    ServerInstance->GetDatabaseExecutor().Run(
+        [PlayerId = Player.GetPlayerId(), MessageId](ServerDatabase& Database) {
+            return Database.RemoveOwnBloodMessage(PlayerId, MessageId);
+        },
+        [this, WeakClient, ResponseTarget, AreaId, MessageId](bool Removed) {
+            if (Removed)
+            {
+                LiveCache.Remove(AreaId, MessageId);
+            }
+
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
+
+            if (!Removed)
+            {
+                WarningS(Client->GetName().c_str(), "Failed to remove blood message.");
+            }
+
+            // Empty response, not sure what purpose this serves really other than saying message-recieved. Client
+            // doesn't work without it though.
+            Frpg2RequestMessage::RequestRemoveBloodMessageResponse Response;
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
 
 MessageHandleResult BloodMessageManager::Handle_RequestGetBloodMessageList(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestGetBloodMessageList* Request = (Frpg2RequestMessage::RequestGetBloodMessageList*)Message.Protobuf.get();
@@ -356,89 +390,149 @@ MessageHandleResult BloodMessageManager::Handle_RequestGetBloodMessageList(GameC
 
 MessageHandleResult BloodMessageManager::Handle_RequestEvaluateBloodMessage(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
-    PlayerState& Player = Client->GetPlayerState();
-
     Frpg2RequestMessage::RequestEvaluateBloodMessage* Request = (Frpg2RequestMessage::RequestEvaluateBloodMessage*)Message.Protobuf.get();
 
-    std::shared_ptr<BloodMessage> ActiveMessage = nullptr;
+    uint32_t MessageId = Request->message_id();
+    bool WasPoor = Request->was_poor();
+
+    // If its in live cache evaluate it, otherwise try and get it out of database.
+    FindMessages(Client, Message, { { (OnlineAreaId)Request->online_area_id(), MessageId } }, 
+        [this, MessageId, WasPoor](GameClient* Client, const std::vector<std::shared_ptr<BloodMessage>>& Found, const Frpg2ReliableUdpMessage& ResponseTarget) {
+            // If we can't find it, this shouldn't happen in practice.
+            if (!Found[0])
+            {
+                WarningS(Client->GetName().c_str(), "Disconnecting client as attempted to evaluate unknown unknown message id '%u'.", MessageId);
+                Client->DisconnectTime = GetSeconds();
+                return;
+            }
+
+            CompleteEvaluateBloodMessage(Client, Found[0], WasPoor, ResponseTarget);
+        }
+    );
 
-    // If its in live cache, evaluate it.
-    if (ActiveMessage = LiveCache.Find((OnlineAreaId)Request->online_area_id(), Request->message_id()))
+    return MessageHandleResult::Handled;
+}
+
+void BloodMessageManager::CompleteEvaluateBloodMessage(GameClient* Client, const std::shared_ptr<BloodMessage>& ActiveMessage, bool WasPoor, const Frpg2ReliableUdpMessage& ResponseTarget)
+{
+    PlayerState& Player = Client->GetPlayerState();
+
+    if (ActiveMessage->PlayerId == Player.GetPlayerId())
     {
-        // Handled below
+        WarningS(Client->GetName().c_str(), "Disconnecting client as attempted to evaluate own message id '%u'.", ActiveMessage->MessageId);
+        Client->DisconnectTime = GetSeconds();
+        return;
     }
-    // Otherwise try and get it out of database.
-    else if (ActiveMessage = Database.FindBloodMessage(Request->message_id()))
+
+    // Update rating and commit to database.
+    if (WasPoor)
     {
-        LiveCache.Add(ActiveMessage->OnlineAreaId, ActiveMessage->MessageId, ActiveMessage);
+        ActiveMessage->RatingPoor++;
     }
-    // If we can't find it, just return 0 evaluation, this shouldn't happen in practice.
     else
     {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as attempted to evaluate unknown unknown message id '%u'.", Request->message_id());
-        return MessageHandleResult::Error;
+        ActiveMessage->RatingGood++;
     }
 
-    if (ActiveMessage != nullptr)
-    {
-        if (ActiveMessage->PlayerId == Player.GetPlayerId())
-        {
-            WarningS(Client->GetName().c_str(), "Disconnecting client as attempted to evaluate own message id '%u'.", Request->message_id());
-            return MessageHandleResult::Error;
+    ServerInstance->GetDatabaseExecutor().Run(
+        [MessageId = ActiveMessage->MessageId, Poor = ActiveMessage->RatingPoor, Good = ActiveMessage->RatingGood](ServerDatabase& Database) {
+            if (!Database.SetBloodMessageEvaluation(MessageId, Poor, Good))
+            {
+                Warning("Failed to update message evaluation for message id '%u'.", MessageId);
+            }
         }
+    );
 
-        // Update rating and commit to database.
-        // TODO: We could batch these updates if it becomes problematic.
-        if (Request->was_poor())
-        {
-            ActiveMessage->RatingPoor++;
-        }
-        else
-        {
-            ActiveMessage->RatingGood++;
-        }
+    LogS(Client->GetName().c_str(), "Evaluating blood message %i as %s.", ActiveMessage->MessageId, WasPoor ? "poor" : "good");
 
-        if (!Database.SetBloodMessageEvaluation(Request->message_id(), ActiveMessage->RatingPoor, ActiveMessage->RatingGood))
-        {
-            WarningS(Client->GetName().c_str(), "Failed to update message evaluation for message id '%u'.", Request->message_id());
-        }
+    // Send push message to originating player if they are online.
+    if (std::shared_ptr<GameClient> OriginClient = GameServiceInstance->FindClientByPlayerId(ActiveMessage->PlayerId))
+    {
+        LogS(Client->GetName().c_str(), "Sending push message for evaluation of blood message %i to player %i.", ActiveMessage->MessageId, ActiveMessage->PlayerId);
 
-        LogS(Client->GetName().c_str(), "Evaluating blood message %i as %s.", ActiveMessage->MessageId, Request->was_poor() ? "poor" : "good");
+        Frpg2RequestMessage::PushRequestEvaluateBloodMessage EvaluatePushMessage;
+        EvaluatePushMessage.set_push_message_id(Frpg2RequestMessage::PushID_PushRequestEvaluateBloodMessage);
+        EvaluatePushMessage.set_player_id(Player.GetPlayerId());
+        EvaluatePushMessage.set_player_steam_id(Player.GetSteamId());
+        EvaluatePushMessage.set_message_id(ActiveMessage->MessageId);
+        EvaluatePushMessage.set_was_poor(WasPoor);
 
-        // Send push message to originating player if they are online.
-        if (std::shared_ptr<GameClient> OriginClient = GameServiceInstance->FindClientByPlayerId(ActiveMessage->PlayerId))
+        if (!OriginClient->MessageStream->Send(&EvaluatePushMessage))
         {
-            LogS(Client->GetName().c_str(), "Sending push message for evaluation of blood message %i to player %i.", ActiveMessage->MessageId, ActiveMessage->PlayerId);
-
-            Frpg2RequestMessage::PushRequestEvaluateBloodMessage EvaluatePushMessage;
-            EvaluatePushMessage.set_push_message_id(Frpg2RequestMessage::PushID_PushRequestEvaluateBloodMessage);
-            EvaluatePushMessage.set_player_id(Player.GetPlayerId());
-            EvaluatePushMessage.set_player_steam_id(Player.GetSteamId());
-            EvaluatePushMessage.set_message_id(ActiveMessage->MessageId);
-            EvaluatePushMessage.set_was_poor(Request->was_poor());
-
-            if (!OriginClient->MessageStream->Send(&EvaluatePushMessage))
-            {
-                WarningS(Client->GetName().c_str(), "Failed to send push message for evaluation of blood message %i to player %i..", ActiveMessage->MessageId, ActiveMessage->PlayerId);
-            }
+            WarningS(Client->GetName().c_str(), "Failed to send push message for evaluation of blood message %i to player %i..", ActiveMessage->MessageId, ActiveMessage->PlayerId);
         }
     }
 
     std::string TypeStatisticKey = StringFormat("BloodMessage/TotalEvaluated");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
 
     // Empty response, not sure what purpose this serves really other than saying message-recieved. Client
     // doesn't work without it though.
     Frpg2RequestMessage::RequestEvaluateBloodMessageResponse Response;
-    if (!Client->MessageStream->Send(&Response, &Message))
+    Client->SendDeferredResponse(&Response, ResponseTarget);
+}
+
+void BloodMessageManager::FindMessages(GameClient* Client, const Frpg2ReliableUdpMessage& Message, const std::vector<std::pair<OnlineAreaId, uint32_t>>& Requested, FindMessagesCompletion Completion)
+{
+    std::vector<std::shared_ptr<BloodMessage>> Found(Requested.size());
+    std::vector<std::pair<size_t, uint32_t>> Uncached;
+
+    for (size_t i = 0; i < Requested.size(); i++)
     {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestEvaluateBloodMessageResponse response.");
-        return MessageHandleResult::Error;
+        Found[i] = LiveCache.Find(Requested[i].first, Requested[i].second);
+        if (!Found[i])
+        {
+            Uncached.push_back({ i, Requested[i].second });
+        }
     }
 
-    return MessageHandleResult::Handled;
+    if (Uncached.empty())
+    {
+        Completion(Client, Found, Message);
+        return;
+    }
+
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
+
+    ServerInstance->GetDatabaseExecutor().Run(
+        [Uncached](ServerDatabase& Database) {
+            std::vector<std::shared_ptr<BloodMessage>> Result;
+            for (const auto& [Index, MessageId] : Uncached)
+            {
+                Result.push_back(Database.FindBloodMessage(MessageId));
+            }
+            return Result;
+        },
+        [this, WeakClient, ResponseTarget, Uncached, Found, Completion](const std::vector<std::shared_ptr<BloodMessage>>& LookedUp) mutable {
+            for (size_t i = 0; i < Uncached.size(); i++)
+            {
+                std::shared_ptr<BloodMessage> DatabaseBloodMessage = LookedUp[i];
+                if (!DatabaseBloodMessage)
+                {
+                    continue;
+                }
+
+                // Another request may have brought it into the cache while we were waiting, in 
+                // which case use that one so evaluations aren't applied to a stale copy.
+                if (std::shared_ptr<BloodMessage> Cached = LiveCache.Find(DatabaseBloodMessage->OnlineAreaId, DatabaseBloodMessage->MessageId))
+                {
+                    DatabaseBloodMessage = Cached;
+                }
+                else
+                {
+                    LiveCache.Add(DatabaseBloodMessage->OnlineAreaId, DatabaseBloodMessage->MessageId, DatabaseBloodMessage);
+                }
+
+                Found[Uncached[i].first] = DatabaseBloodMessage;
+            }
+
+            if (std::shared_ptr<GameClient> Client = WeakClient.lock())
+            {
+                Completion(Client.get(), Found, ResponseTarget);
+            }
+        }
+    );
 }
 
 std::string BloodMessageManager::GetName()
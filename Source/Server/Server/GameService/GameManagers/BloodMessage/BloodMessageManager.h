@@ -13,6 +13,8 @@
 #include "Server/GameService/Utils/OnlineAreaPool.h"
 #include "Server/Database/DatabaseTypes.h"
 
+#include <functional>
+
 struct Frpg2ReliableUdpMessage;
 class Server;
 class GameService;
@@ -30,7 +32,7 @@ public:
     virtual void Poll() override;
     virtual void TrimDatabase() override;
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
@@ -45,6 +47,16 @@ protected:
     MessageHandleResult Handle_RequestEvaluateBloodMessage(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
     MessageHandleResult Handle_RequestReCreateBloodMessageList(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
 
+    using FindMessagesCompletion = std::function<void(GameClient* Client, const std::vector<std::shared_ptr<BloodMessage>>& Found, const Frpg2ReliableUdpMessage& ResponseTarget)>;
+
+    // Finds each of the requested messages, anything not in the live cache is looked up on the database
+    // thread and added to it. Found is in the same order as Requested, with nullptr for messages that
+    // don't exist. If everything was cached Completion is called straight away, otherwise its called
+    // once the lookup finishes, as long as the client is still around.
+    void FindMessages(GameClient* Client, const Frpg2ReliableUdpMessage& Message, const std::vector<std::pair<OnlineAreaId, uint32_t>>& Requested, FindMessagesCompletion Completion);
+
+    void CompleteEvaluateBloodMessage(GameClient* Client, const std::shared_ptr<BloodMessage>& ActiveMessage, bool WasPoor, const Frpg2ReliableUdpMessage& ResponseTarget);
+
 private:
     Server* ServerInstance;
     GameService* GameServiceInstance;
@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/Bloodstain/BloodstainManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -61,27 +62,15 @@ void BloodstainManager::TrimDatabase()
     Database.TrimBloodStains(MaxEntries);
 }
 
-MessageHandleResult BloodstainManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void BloodstainManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateBloodstain)
-    {
-        return Handle_RequestCreateBloodstain(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetBloodstainList)
-    {
-        return Handle_RequestGetBloodstainList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetDeadingGhost)
-    {
-        return Handle_RequestGetDeadingGhost(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateBloodstain, this, &BloodstainManager::Handle_RequestCreateBloodstain);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetBloodstainList, this, &BloodstainManager::Handle_RequestGetBloodstainList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetDeadingGhost, this, &BloodstainManager::Handle_RequestGetDeadingGhost);
 }
 
 MessageHandleResult BloodstainManager::Handle_RequestCreateBloodstain(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestCreateBloodstain* Request = (Frpg2RequestMessage::RequestCreateBloodstain*)Message.Protobuf.get();
@@ -91,19 +80,36 @@ MessageHandleResult BloodstainManager::Handle_RequestCreateBloodstain(GameClient
     Data.assign(Request->data().data(), Request->data().data() + Request->data().size());
     GhostData.assign(Request->ghost_data().data(), Request->ghost_data().data() + Request->ghost_data().size());
 
-    if (std::shared_ptr<Bloodstain> ActiveStain = Database.CreateBloodstain((OnlineAreaId)Request->online_area_id(), Player.GetPlayerId(), Player.GetSteamId(), Data, GhostData))
-    {
-        LiveCache.Add(ActiveStain->OnlineAreaId, ActiveStain->BloodstainId, ActiveStain);
-    }
-    else
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to create blood stain.");
-        return MessageHandleResult::Error;
-    }
+    OnlineAreaId AreaId = (OnlineAreaId)Request->online_area_id();
+    uint32_t PlayerId = Player.GetPlayerId();
+    std::string SteamId = Player.GetSteamId();
 
-    std::string TypeStatisticKey = StringFormat("Bloodstain/TotalCreated");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+
+    // No response is expected, the stain just becomes visible to others once it's stored.
+    ServerInstance->GetDatabaseExecutor().Run(
+        [AreaId, PlayerId, SteamId, Data, GhostData](ServerDatabase& Database) {
+            std::shared_ptr<Bloodstain> Result = Database.CreateBloodstain(AreaId, PlayerId, SteamId, Data, GhostData);
+            if (Result)
+            {
+                std::string TypeStatisticKey = StringFormat("Bloodstain/TotalCreated");
+                Database.AddGlobalStatistic(TypeStatisticKey, 1);
+                Database.AddPlayerStatistic(TypeStatisticKey, PlayerId, 1);
+            }
+            return Result;
+        },
+        [this, WeakClient](std::shared_ptr<Bloodstain> ActiveStain) {
+            if (ActiveStain)
+            {
+                LiveCache.Add(ActiveStain->OnlineAreaId, ActiveStain->BloodstainId, ActiveStain);
+            }
+            else if (std::shared_ptr<GameClient> Client = WeakClient.lock())
+            {
+                WarningS(Client->GetName().c_str(), "Disconnecting client as failed to create blood stain.");
+                Client->DisconnectTime = GetSeconds();
+            }
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
@@ -156,44 +162,63 @@ MessageHandleResult BloodstainManager::Handle_RequestGetBloodstainList(GameClien
 
 MessageHandleResult BloodstainManager::Handle_RequestGetDeadingGhost(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
-    PlayerState& Player = Client->GetPlayerState();
-
     Frpg2RequestMessage::RequestGetDeadingGhost* Request = (Frpg2RequestMessage::RequestGetDeadingGhost*)Message.Protobuf.get();
 
-    std::shared_ptr<Bloodstain> ActiveStain;
+    OnlineAreaId AreaId = (OnlineAreaId)Request->online_area_id();
+    uint32_t BloodstainId = Request->bloodstain_id();
 
     // Find it in live cache.
-    if (ActiveStain = LiveCache.Find((OnlineAreaId)Request->online_area_id(), Request->bloodstain_id()))
+    if (std::shared_ptr<Bloodstain> ActiveStain = LiveCache.Find(AreaId, BloodstainId))
     {
-        // Nothing needed here.
+        SendDeadingGhost(Client, ActiveStain, Message);
+        return MessageHandleResult::Handled;
     }
+
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
+
     // If not in cache, grab it from database.
-    else if (ActiveStain =  Database.FindBloodstain(Request->bloodstain_id()))
-    {
-        LiveCache.Add(ActiveStain->OnlineAreaId, ActiveStain->BloodstainId, ActiveStain);
-    }
-    // Doesn't exist, no go.
-    else
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to retrieve bloodstain '%i'", Request->bloodstain_id());
-        return MessageHandleResult::Error;
-    }
+    ServerInstance->GetDatabaseExecutor().Run(
+        [BloodstainId](ServerDatabase& Database) {
+            return Database.FindBloodstain(BloodstainId);
+        },
+        [this, WeakClient, ResponseTarget, AreaId, BloodstainId](std::shared_ptr<Bloodstain> ActiveStain) {
+            if (ActiveStain)
+            {
+                LiveCache.Add(ActiveStain->OnlineAreaId, ActiveStain->BloodstainId, ActiveStain);
+            }
 
-    Frpg2RequestMessage::RequestGetDeadingGhostResponse Response;
-    Response.set_online_area_id(Request->online_area_id());
-    Response.set_bloodstain_id(Request->bloodstain_id());
-    Response.set_data(ActiveStain->GhostData.data(), ActiveStain->GhostData.size());
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
 
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestGetDeadingGhostResponse response.");
-        return MessageHandleResult::Error;
-    }
+            // Doesn't exist, no go.
+            if (!ActiveStain)
+            {
+                WarningS(Client->GetName().c_str(), "Disconnecting client as failed to retrieve bloodstain '%i'", BloodstainId);
+                Client->DisconnectTime = GetSeconds();
+                return;
+            }
+
+            SendDeadingGhost(Client.get(), ActiveStain, ResponseTarget);
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
 
+void BloodstainManager::SendDeadingGhost(GameClient* Client, const std::shared_ptr<Bloodstain>& ActiveStain, const Frpg2ReliableUdpMessage& ResponseTarget)
+{
+    Frpg2RequestMessage::RequestGetDeadingGhostResponse Response;
+    Response.set_online_area_id((uint32_t)ActiveStain->OnlineAreaId);
+    Response.set_bloodstain_id(ActiveStain->BloodstainId);
+    Response.set_data(ActiveStain->GhostData.data(), ActiveStain->GhostData.size());
+
+    Client->SendDeferredResponse(&Response, ResponseTarget);
+}
+
 std::string BloodstainManager::GetName()
 {
     return "Bloodstain";
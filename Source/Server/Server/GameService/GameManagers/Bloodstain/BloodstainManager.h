@@ -28,7 +28,7 @@ public:
     virtual bool Init() override;
     virtual void TrimDatabase() override;
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
@@ -39,6 +39,8 @@ protected:
     MessageHandleResult Handle_RequestGetBloodstainList(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
     MessageHandleResult Handle_RequestGetDeadingGhost(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
 
+    void SendDeadingGhost(GameClient* Client, const std::shared_ptr<Bloodstain>& ActiveStain, const Frpg2ReliableUdpMessage& ResponseTarget);
+
 private:
     Server* ServerInstance;
 
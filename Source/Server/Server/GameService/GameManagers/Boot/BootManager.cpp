@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/Boot/BootManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -26,23 +27,14 @@ BootManager::BootManager(Server* InServerInstance)
 {
 }
 
-MessageHandleResult BootManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void BootManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestWaitForUserLogin)
-    {
-        return Handle_RequestWaitForUserLogin(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetAnnounceMessageList)
-    {
-        return Handle_RequestGetAnnounceMessageList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestWaitForUserLogin, this, &BootManager::Handle_RequestWaitForUserLogin);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetAnnounceMessageList, this, &BootManager::Handle_RequestGetAnnounceMessageList);
 }
 
 MessageHandleResult BootManager::Handle_RequestWaitForUserLogin(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& State = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestWaitForUserLogin* Request = (Frpg2RequestMessage::RequestWaitForUserLogin*)Message.Protobuf.get();
@@ -64,16 +56,51 @@ MessageHandleResult BootManager::Handle_RequestWaitForUserLogin(GameClient* Clie
 #endif
 
     State.SetSteamId(SteamId);
+    ServerInstance->GetService<GameService>()->UpdateClientIndexes(Client);
+
+    // Resolve steam id to player id on the database thread. If no player recorded with it, create a new one.
+    // The rest of the login happens once we have the id.
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
+
+    ServerInstance->GetDatabaseExecutor().Run(
+        [SteamId](ServerDatabase& Database) {
+            uint32_t NewPlayerId = 0;
+            if (!Database.FindOrCreatePlayer(SteamId, NewPlayerId))
+            {
+                return 0u;
+            }
+
+            std::string TypeStatisticKey = StringFormat("Player/TotalLogins");
+            Database.AddGlobalStatistic(TypeStatisticKey, 1);
+            Database.AddPlayerStatistic(TypeStatisticKey, NewPlayerId, 1);
+
+            return NewPlayerId;
+        },
+        [this, WeakClient, ResponseTarget](uint32_t NewPlayerId) {
+            if (std::shared_ptr<GameClient> Client = WeakClient.lock())
+            {
+                CompleteUserLogin(Client.get(), NewPlayerId, ResponseTarget);
+            }
+        }
+    );
+
+    return MessageHandleResult::Handled;
+}
+
+void BootManager::CompleteUserLogin(GameClient* Client, uint32_t NewPlayerId, const Frpg2ReliableUdpMessage& ResponseTarget)
+{
+    PlayerState& State = Client->GetPlayerState();
 
-    // Resolve steam id to player id. If no player recorded with it, create a new one.
-    uint32_t NewPlayerId = 0;
-    if (!ServerInstance->GetDatabase().FindOrCreatePlayer(State.GetSteamId(), NewPlayerId))
+    if (NewPlayerId == 0)
     {
         WarningS(Client->GetName().c_str(), "Failed to find or create player with steam id '%s' in database.", State.GetSteamId().c_str());
-        return MessageHandleResult::Error;
+        Client->DisconnectTime = GetSeconds();
+        return;
     }
 
     State.SetPlayerId(NewPlayerId);
+    ServerInstance->GetService<GameService>()->UpdateClientIndexes(Client);
 
     LogS(Client->GetName().c_str(), "Steam id '%s' has logged in as player %i.", State.GetSteamId().c_str(), State.GetPlayerId());
     LogS(Client->GetName().c_str(), "Renaming connection to '%s'.", State.GetSteamId().c_str());
@@ -84,10 +111,9 @@ MessageHandleResult BootManager::Handle_RequestWaitForUserLogin(GameClient* Clie
     Frpg2RequestMessage::RequestWaitForUserLoginResponse Response;
     Response.set_steam_id(State.GetSteamId());
     Response.set_player_id(State.GetPlayerId()); 
-    if (!Client->MessageStream->Send(&Response, &Message))
+    if (!Client->SendDeferredResponse(&Response, ResponseTarget))
     {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestWaitForUserLoginResponse response.");
-        return MessageHandleResult::Error;
+        return;
     }
 
     // This happens right after RequestWaitForUserLoginResponse.
@@ -123,14 +149,8 @@ MessageHandleResult BootManager::Handle_RequestWaitForUserLogin(GameClient* Clie
     if (!Client->MessageStream->Send(&UploadInfoPushMessage))
     {
         WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send UploadInfoPushMessage response.");
-        return MessageHandleResult::Error;
+        Client->DisconnectTime = GetSeconds();
     }
-
-    std::string TypeStatisticKey = StringFormat("Player/TotalLogins");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, State.GetPlayerId(), 1);
-
-    return MessageHandleResult::Handled;
 }
 
 MessageHandleResult BootManager::Handle_RequestGetAnnounceMessageList(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
@@ -138,12 +158,33 @@ MessageHandleResult BootManager::Handle_RequestGetAnnounceMessageList(GameClient
     Frpg2RequestMessage::RequestGetAnnounceMessageList* Request = (Frpg2RequestMessage::RequestGetAnnounceMessageList*)Message.Protobuf.get();
     Ensure(Request->max_entries() == 100);
 
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
+
+    // Check the ban list on the database thread, the announcements are sent once we know.
+    ServerInstance->GetDatabaseExecutor().Run(
+        [SteamId = Client->GetPlayerState().GetSteamId()](ServerDatabase& Database) {
+            return Database.IsPlayerBanned(SteamId);
+        },
+        [this, WeakClient, ResponseTarget](bool IsBanned) {
+            if (std::shared_ptr<GameClient> Client = WeakClient.lock())
+            {
+                CompleteGetAnnounceMessageList(Client.get(), IsBanned, ResponseTarget);
+            }
+        }
+    );
+
+    return MessageHandleResult::Handled;
+}
+
+void BootManager::CompleteGetAnnounceMessageList(GameClient* Client, bool IsBanned, const Frpg2ReliableUdpMessage& ResponseTarget)
+{
     Frpg2RequestMessage::RequestGetAnnounceMessageListResponse Response;
     Frpg2RequestMessage::AnnounceMessageDataList* Notices = Response.mutable_notices();
     Frpg2RequestMessage::AnnounceMessageDataList* Changes = Response.mutable_changes();
 
     std::vector<RuntimeConfigAnnouncement> Announcements;
-    if (ServerInstance->GetDatabase().IsPlayerBanned(Client->GetPlayerState().GetSteamId()))
+    if (IsBanned)
     {
         RuntimeConfigAnnouncement Announcement;
         Announcement.Header = "Banned";
@@ -180,13 +221,7 @@ MessageHandleResult BootManager::Handle_RequestGetAnnounceMessageList(GameClient
         DateTime->set_tzdiff(0);
     }
 
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestWaitForUserLoginResponse response.");
-        return MessageHandleResult::Error;
-    }
-
-    return MessageHandleResult::Handled;
+    Client->SendDeferredResponse(&Response, ResponseTarget);
 }
 
 std::string BootManager::GetName()
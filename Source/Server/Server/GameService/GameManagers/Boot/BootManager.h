@@ -23,7 +23,7 @@ class BootManager
 public:    
     BootManager(Server* InServerInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
@@ -31,6 +31,12 @@ protected:
     MessageHandleResult Handle_RequestWaitForUserLogin(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
     MessageHandleResult Handle_RequestGetAnnounceMessageList(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
 
+    // Finishes off RequestWaitForUserLogin once the player id has been looked up.
+    void CompleteUserLogin(GameClient* Client, uint32_t NewPlayerId, const Frpg2ReliableUdpMessage& ResponseTarget);
+
+    // Finishes off RequestGetAnnounceMessageList once the ban list has been checked.
+    void CompleteGetAnnounceMessageList(GameClient* Client, bool IsBanned, const Frpg2ReliableUdpMessage& ResponseTarget);
+
 private:
     Server* ServerInstance;
 
@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/BreakIn/BreakInManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -29,25 +30,14 @@ void BreakInManager::OnLostPlayer(GameClient* Client)
 {
 }
 
-MessageHandleResult BreakInManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void BreakInManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetBreakInTargetList)
-    {
-        return Handle_RequestGetBreakInTargetList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestBreakInTarget)
-    {
-        return Handle_RequestBreakInTarget(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRejectBreakInTarget)
-    {
-        return Handle_RequestRejectBreakInTarget(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetBreakInTargetList, this, &BreakInManager::Handle_RequestGetBreakInTargetList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestBreakInTarget, this, &BreakInManager::Handle_RequestBreakInTarget);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRejectBreakInTarget, this, &BreakInManager::Handle_RequestRejectBreakInTarget);
 }
 
-bool BreakInManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Request, const std::shared_ptr<GameClient>& Match)
+bool BreakInManager::GetMatchingQuery(const Frpg2RequestMessage::MatchingParameter& Request, MatchmakingQuery& Query)
 {
     const RuntimeConfig& Config = ServerInstance->GetConfig();
 
@@ -57,26 +47,15 @@ bool BreakInManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter&
         return false;
     }
 
-    if (!Match->GetPlayerState().GetIsInvadable())
-    {
-        return false;
-    }
-
-    const RuntimeConfigMatchingParameters* MatchingParams = &Config.DarkSpiritInvasionMatchingParameters;
+    Query.Parameters = &Config.DarkSpiritInvasionMatchingParameters;
     if (Request.covenant() == Frpg2RequestMessage::Covenant::Covenant_Mound_Makers)
     {
-        MatchingParams = &Config.MoundMakerInvasionMatchingParameters;
+        Query.Parameters = &Config.MoundMakerInvasionMatchingParameters;
     }
 
-    // Check matching parameters.
-    if (!MatchingParams->CheckMatch(
-            Request.soul_level(), Request.weapon_level(), 
-            Match->GetPlayerState().GetSoulLevel(), Match->GetPlayerState().GetMaxWeaponLevel(),
-            Request.password().size() > 0
-        ))
-    {
-        return false;
-    }
+    Query.SoulLevel = Request.soul_level();
+    Query.WeaponLevel = Request.weapon_level();
+    Query.HasPassword = Request.password().size() > 0;
 
     return true;
 }
@@ -85,26 +64,21 @@ MessageHandleResult BreakInManager::Handle_RequestGetBreakInTargetList(GameClien
 {
     Frpg2RequestMessage::RequestGetBreakInTargetList* Request = (Frpg2RequestMessage::RequestGetBreakInTargetList*)Message.Protobuf.get();
     
-    std::vector<std::shared_ptr<GameClient>> PotentialTargets = GameServiceInstance->FindClients([this, Client, Request](const std::shared_ptr<GameClient>& OtherClient) {
-        if (Client == OtherClient.get())
-        {
-            return false;
-        }
-        if (OtherClient->GetPlayerState().GetCurrentArea() != (OnlineAreaId)Request->online_area_id())
-        {
-            return false;
-        }
-        return CanMatchWith(Request->matching_parameter(), OtherClient); 
-    });
-
-    // TODO: Sort potential targets based on prioritization (more summons etc)
+    // Only players that can be invaded in the requested area are considered, best matches first.
+    std::vector<std::shared_ptr<GameClient>> PotentialTargets;
+    MatchmakingQuery Query;
+    if (GetMatchingQuery(Request->matching_parameter(), Query))
+    {
+        PotentialTargets = GameServiceInstance->FindInvadableClientsInArea((OnlineAreaId)Request->online_area_id(), Query, Request->max_targets(), [Client](const std::shared_ptr<GameClient>& OtherClient) {
+            return Client != OtherClient.get();
+        });
+    }
 
     Frpg2RequestMessage::RequestGetBreakInTargetListResponse Response;
     Response.set_map_id(Request->map_id());
     Response.set_online_area_id(Request->online_area_id());
 
-    int CountToSend = std::min((int)Request->max_targets(), (int)PotentialTargets.size());
-    for (int i = 0; i < CountToSend; i++)
+    for (size_t i = 0; i < PotentialTargets.size(); i++)
     {
         std::shared_ptr<GameClient> OtherClient = PotentialTargets[i];
 
@@ -124,7 +98,6 @@ MessageHandleResult BreakInManager::Handle_RequestGetBreakInTargetList(GameClien
 
 MessageHandleResult BreakInManager::Handle_RequestBreakInTarget(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestBreakInTarget* Request = (Frpg2RequestMessage::RequestBreakInTarget*)Message.Protobuf.get();
@@ -157,8 +130,7 @@ MessageHandleResult BreakInManager::Handle_RequestBreakInTarget(GameClient* Clie
         }
 
         std::string TypeStatisticKey = StringFormat("BreakIn/TotalInvasionsRequested");
-        Database.AddGlobalStatistic(TypeStatisticKey, 1);
-        Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+        ServerInstance->GetDatabaseExecutor().AddStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
     }
 
     // Empty response, not sure what purpose this serves really other than saying message-recieved. Client
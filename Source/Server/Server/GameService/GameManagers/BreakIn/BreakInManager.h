@@ -17,6 +17,7 @@
 struct Frpg2ReliableUdpMessage;
 class Server;
 class GameService;
+struct MatchmakingQuery;
 
 // Handles client requests for invading other games.
 
@@ -26,14 +27,15 @@ class BreakInManager
 public:    
     BreakInManager(Server* InServerInstance, GameService* InGameServiceInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
     virtual void OnLostPlayer(GameClient* Client) override;
 
 protected:
-    bool CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Client, const std::shared_ptr<GameClient>& Match);
+    // Fills in the query used to find targets for the given parameters. Returns false if invasions are disabled.
+    bool GetMatchingQuery(const Frpg2RequestMessage::MatchingParameter& Request, MatchmakingQuery& Query);
 
     MessageHandleResult Handle_RequestGetBreakInTargetList(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
     MessageHandleResult Handle_RequestBreakInTarget(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
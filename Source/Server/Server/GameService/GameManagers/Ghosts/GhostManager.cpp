@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/Ghosts/GhostManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -61,23 +62,14 @@ void GhostManager::TrimDatabase()
     Database.TrimGhosts(MaxEntries);
 }
 
-MessageHandleResult GhostManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void GhostManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateGhostData)
-    {
-        return Handle_RequestCreateGhostData(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetGhostDataList)
-    {
-        return Handle_RequestGetGhostDataList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateGhostData, this, &GhostManager::Handle_RequestCreateGhostData);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetGhostDataList, this, &GhostManager::Handle_RequestGetGhostDataList);
 }
 
 MessageHandleResult GhostManager::Handle_RequestCreateGhostData(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestCreateGhostData* Request = (Frpg2RequestMessage::RequestCreateGhostData*)Message.Protobuf.get();
@@ -85,28 +77,50 @@ MessageHandleResult GhostManager::Handle_RequestCreateGhostData(GameClient* Clie
     std::vector<uint8_t> Data;
     Data.assign(Request->data().data(), Request->data().data() + Request->data().size());
 
-    if (std::shared_ptr<Ghost> ActiveGhost = Database.CreateGhost((OnlineAreaId)Request->online_area_id(), Player.GetPlayerId(), Player.GetSteamId(), Data))
-    {
-        LiveCache.Add(ActiveGhost->OnlineAreaId, ActiveGhost->GhostId, ActiveGhost);
-    }
-    else
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to create ghost.");
-        return MessageHandleResult::Error;
-    }
+    OnlineAreaId AreaId = (OnlineAreaId)Request->online_area_id();
+    uint32_t PlayerId = Player.GetPlayerId();
+    std::string SteamId = Player.GetSteamId();
 
-    std::string TypeStatisticKey = StringFormat("Ghosts/TotalGhostsCreated");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
 
-    // Empty response, not sure what purpose this serves really other than saying message-recieved. Client
-    // doesn't work without it though.
-    Frpg2RequestMessage::RequestCreateGhostDataResponse Response;
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestCreateGhostDataResponse response.");
-        return MessageHandleResult::Error;
-    }
+    // Ghost is written on the database thread, we respond once it's stored.
+    ServerInstance->GetDatabaseExecutor().Run(
+        [AreaId, PlayerId, SteamId, Data](ServerDatabase& Database) {
+            std::shared_ptr<Ghost> Result = Database.CreateGhost(AreaId, PlayerId, SteamId, Data);
+            if (Result)
+            {
+                std::string TypeStatisticKey = StringFormat("Ghosts/TotalGhostsCreated");
+                Database.AddGlobalStatistic(TypeStatisticKey, 1);
+                Database.AddPlayerStatistic(TypeStatisticKey, PlayerId, 1);
+            }
+            return Result;
+        },
+        [this, WeakClient, ResponseTarget](std::shared_ptr<Ghost> ActiveGhost) {
+            if (ActiveGhost)
+            {
+                LiveCache.Add(ActiveGhost->OnlineAreaId, ActiveGhost->GhostId, ActiveGhost);
+            }
+
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
+
+            if (!ActiveGhost)
+            {
+                WarningS(Client->GetName().c_str(), "Disconnecting client as failed to create ghost.");
+                Client->DisconnectTime = GetSeconds();
+                return;
+            }
+
+            // Empty response, not sure what purpose this serves really other than saying message-recieved. Client
+            // doesn't work without it though.
+            Frpg2RequestMessage::RequestCreateGhostDataResponse Response;
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/Logging/LoggingManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -24,59 +25,23 @@ LoggingManager::LoggingManager(Server* InServerInstance)
 {
 }
 
-MessageHandleResult LoggingManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void LoggingManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyProtoBufLog)
-    {
-        return Handle_RequestNotifyProtoBufLog(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyKillEnemy)
-    {
-        return Handle_RequestNotifyKillEnemy(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyDisconnectSession)
-    {
-        return Handle_RequestNotifyDisconnectSession(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyRegisterCharacter)
-    {
-        return Handle_RequestNotifyRegisterCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyDie)
-    {
-        return Handle_RequestNotifyDie(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyKillBoss)
-    {
-        return Handle_RequestNotifyKillBoss(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyJoinMultiplay)
-    {
-        return Handle_RequestNotifyJoinMultiplay(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyLeaveMultiplay)
-    {
-        return Handle_RequestNotifyLeaveMultiplay(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifySummonSignResult)
-    {
-        return Handle_RequestNotifySummonSignResult(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyCreateSignResult)
-    {
-        return Handle_RequestNotifyCreateSignResult(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyBreakInResult)
-    {
-        return Handle_RequestNotifyBreakInResult(Client, Message);
-    }
-        
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyProtoBufLog, this, &LoggingManager::Handle_RequestNotifyProtoBufLog);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyKillEnemy, this, &LoggingManager::Handle_RequestNotifyKillEnemy);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyDisconnectSession, this, &LoggingManager::Handle_RequestNotifyDisconnectSession);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyRegisterCharacter, this, &LoggingManager::Handle_RequestNotifyRegisterCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyDie, this, &LoggingManager::Handle_RequestNotifyDie);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyKillBoss, this, &LoggingManager::Handle_RequestNotifyKillBoss);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyJoinMultiplay, this, &LoggingManager::Handle_RequestNotifyJoinMultiplay);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyLeaveMultiplay, this, &LoggingManager::Handle_RequestNotifyLeaveMultiplay);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifySummonSignResult, this, &LoggingManager::Handle_RequestNotifySummonSignResult);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyCreateSignResult, this, &LoggingManager::Handle_RequestNotifyCreateSignResult);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyBreakInResult, this, &LoggingManager::Handle_RequestNotifyBreakInResult);
 }
 
 MessageHandleResult LoggingManager::Handle_RequestNotifyProtoBufLog(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestNotifyProtoBufLog* Request = (Frpg2RequestMessage::RequestNotifyProtoBufLog*)Message.Protobuf.get();
@@ -108,7 +73,6 @@ MessageHandleResult LoggingManager::Handle_RequestNotifyProtoBufLog(GameClient*
 
 void LoggingManager::Handle_UseMagicLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::UseMagicLog Log;
@@ -124,20 +88,17 @@ void LoggingManager::Handle_UseMagicLog(GameClient* Client, Frpg2RequestMessage:
         const FpdLogMessage::UseMagicLog_Use_magic_info_list& Item = Log.use_magic_info_list(i);
 
         std::string StatisticKey = StringFormat("Magic/TotalUsed/Id=%u", Item.spell_id());
-        Database.AddGlobalStatistic(StatisticKey, Item.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
 
         TotalCount += Item.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Magic/TotalUsed");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 void LoggingManager::Handle_ActGestureLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::ActGestureLog Log;
@@ -153,20 +114,17 @@ void LoggingManager::Handle_ActGestureLog(GameClient* Client, Frpg2RequestMessag
         const FpdLogMessage::ActGestureLog_Use_gesture_info_list& Item = Log.use_gesture_info_list(i);
 
         std::string StatisticKey = StringFormat("Gesture/TotalUsed/Id=%u", Item.guesture_id());
-        Database.AddGlobalStatistic(StatisticKey, Item.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
 
         TotalCount += Item.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Gesture/TotalUsed");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 void LoggingManager::Handle_UseItemLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::UseItemLog Log;
@@ -182,20 +140,17 @@ void LoggingManager::Handle_UseItemLog(GameClient* Client, Frpg2RequestMessage::
         const FpdLogMessage::UseItemLog_Use_item_info_list& Item = Log.use_item_info_list(i);
 
         std::string StatisticKey = StringFormat("Item/TotalUsed/Id=%u", Item.item_id());
-        Database.AddGlobalStatistic(StatisticKey, Item.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
 
         TotalCount += Item.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Item/TotalUsed");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 void LoggingManager::Handle_PurchaseItemLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::PurchaseItemLog Log;
@@ -211,20 +166,17 @@ void LoggingManager::Handle_PurchaseItemLog(GameClient* Client, Frpg2RequestMess
         const FpdLogMessage::PurchaseItemLog_Purchase_item_info_list& Item = Log.purchase_item_info_list(i);
 
         std::string StatisticKey = StringFormat("Item/TotalPurchased/Id=%u", Item.item_id());
-        Database.AddGlobalStatistic(StatisticKey, Item.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
 
         TotalCount += Item.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Item/TotalPurchased");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 void LoggingManager::Handle_GetItemLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::GetItemLog Log;
@@ -240,20 +192,17 @@ void LoggingManager::Handle_GetItemLog(GameClient* Client, Frpg2RequestMessage::
         const FpdLogMessage::GetItemLog_Get_item_info_list& Item = Log.get_item_info_list(i);
 
         std::string StatisticKey = StringFormat("Item/TotalRecieved/Id=%u", Item.item_id());
-        Database.AddGlobalStatistic(StatisticKey, Item.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
 
         TotalCount += Item.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Item/TotalRecieved");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 void LoggingManager::Handle_DropItemLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::DropItemLog Log;
@@ -269,20 +218,17 @@ void LoggingManager::Handle_DropItemLog(GameClient* Client, Frpg2RequestMessage:
         const FpdLogMessage::DropItemLog_Throw_away_item_list& Item = Log.throw_away_item_list(i);
 
         std::string StatisticKey = StringFormat("Item/TotalDropped/Id=%u", Item.item_id());
-        Database.AddGlobalStatistic(StatisticKey, Item.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
 
         TotalCount += Item.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Item/TotalDropped");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 void LoggingManager::Handle_LeaveItemLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::LeaveItemLog Log;
@@ -298,20 +244,17 @@ void LoggingManager::Handle_LeaveItemLog(GameClient* Client, Frpg2RequestMessage
         const FpdLogMessage::LeaveItemLog_Set_item_info_list& Item = Log.set_item_info_list(i);
 
         std::string StatisticKey = StringFormat("Item/TotalLeft/Id=%u", Item.item_id());
-        Database.AddGlobalStatistic(StatisticKey, Item.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
 
         TotalCount += Item.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Item/TotalLeft");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 void LoggingManager::Handle_SaleItemLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::SaleItemLog Log;
@@ -327,20 +270,17 @@ void LoggingManager::Handle_SaleItemLog(GameClient* Client, Frpg2RequestMessage:
         const FpdLogMessage::SaleItemLog_Sale_item_info_list& Item = Log.sale_item_info_list(i);
 
         std::string StatisticKey = StringFormat("Item/TotalSold/Id=%u", Item.item_id());
-        Database.AddGlobalStatistic(StatisticKey, Item.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), Item.count());
 
         TotalCount += Item.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Item/TotalSold");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 void LoggingManager::Handle_StrengthenWeaponLog(GameClient* Client, Frpg2RequestMessage::RequestNotifyProtoBufLog* Request)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     FpdLogMessage::StrengthenWeaponLog Log;
@@ -356,20 +296,17 @@ void LoggingManager::Handle_StrengthenWeaponLog(GameClient* Client, Frpg2Request
         const FpdLogMessage::StrengthenWeaponLog_Strengthen_weapon_info_list& Item = Log.strengthen_weapon_info_list(i);
 
         std::string StatisticKey = StringFormat("Item/TotalUpgraded/Id=%u", Item.from_item_id());
-        Database.AddGlobalStatistic(StatisticKey, 1);
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), 1);
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), 1);
 
         TotalCount += 1;
     }
 
     std::string TotalStatisticKey = StringFormat("Item/TotalUpgraded");
-    Database.AddGlobalStatistic(TotalStatisticKey, TotalCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), TotalCount);
 }
 
 MessageHandleResult LoggingManager::Handle_RequestNotifyKillEnemy(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestNotifyKillEnemy* Request = (Frpg2RequestMessage::RequestNotifyKillEnemy*)Message.Protobuf.get();
@@ -380,15 +317,13 @@ MessageHandleResult LoggingManager::Handle_RequestNotifyKillEnemy(GameClient* Cl
         const Frpg2RequestMessage::KillEnemyInfo& EnemyInfo = Request->enemys(i);
 
         std::string StatisticKey = StringFormat("Enemies/TotalKilled/Id=%u", EnemyInfo.enemy_type_id());
-        Database.AddGlobalStatistic(StatisticKey, EnemyInfo.count());
-        Database.AddPlayerStatistic(StatisticKey, Player.GetPlayerId(), EnemyInfo.count());
+        ServerInstance->GetDatabaseExecutor().AddStatistic(StatisticKey, Player.GetPlayerId(), EnemyInfo.count());
 
         EnemyCount += EnemyInfo.count();
     }
 
     std::string TotalStatisticKey = StringFormat("Enemies/TotalKilled");
-    Database.AddGlobalStatistic(TotalStatisticKey, EnemyCount);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), EnemyCount);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), EnemyCount);
     
     Frpg2RequestMessage::EmptyResponse Response;
     if (!Client->MessageStream->Send(&Response, &Message))
@@ -418,14 +353,12 @@ MessageHandleResult LoggingManager::Handle_RequestNotifyDisconnectSession(GameCl
 
 MessageHandleResult LoggingManager::Handle_RequestNotifyRegisterCharacter(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestNotifyRegisterCharacter* Request = (Frpg2RequestMessage::RequestNotifyRegisterCharacter*)Message.Protobuf.get();
 
     std::string TotalStatisticKey = StringFormat("Player/TotalRegisteredCharacters");
-    Database.AddGlobalStatistic(TotalStatisticKey, 1);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), 1);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), 1);
 
     Frpg2RequestMessage::EmptyResponse Response;
     if (!Client->MessageStream->Send(&Response, &Message))
@@ -439,18 +372,15 @@ MessageHandleResult LoggingManager::Handle_RequestNotifyRegisterCharacter(GameCl
 
 MessageHandleResult LoggingManager::Handle_RequestNotifyDie(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestNotifyDie* Request = (Frpg2RequestMessage::RequestNotifyDie*)Message.Protobuf.get();
 
     std::string TypeStatisticKey = StringFormat("Player/TotalDeaths/Cause=%u", (uint32_t)Request->cause_of_death());
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
 
     std::string TotalStatisticKey = StringFormat("Player/TotalDeaths");
-    Database.AddGlobalStatistic(TotalStatisticKey, 1);
-    Database.AddPlayerStatistic(TotalStatisticKey, Player.GetPlayerId(), 1);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TotalStatisticKey, Player.GetPlayerId(), 1);
 
     Frpg2RequestMessage::EmptyResponse Response;
     if (!Client->MessageStream->Send(&Response, &Message))
@@ -502,14 +432,15 @@ MessageHandleResult LoggingManager::Handle_RequestNotifyLeaveMultiplay(GameClien
     Frpg2RequestMessage::RequestNotifyLeaveMultiplay* Request = (Frpg2RequestMessage::RequestNotifyLeaveMultiplay*)Message.Protobuf.get();
 
     std::string TypeStatisticKey = StringFormat("Player/TotalMultiplaySessions");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
 
     for (int i = 0; i < Request->party_member_info_size(); i++)
     {        
         const Frpg2RequestMessage::PartyMemberInfo& Info = Request->party_member_info(i);
         std::string TypeStatisticKey = StringFormat("Player/TotalMultiplaySessions/PartyPlayerId=%u", Info.player_id());
-        Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+        ServerInstance->GetDatabaseExecutor().Run([TypeStatisticKey, PlayerId = Player.GetPlayerId()](ServerDatabase& Database) {
+            Database.AddPlayerStatistic(TypeStatisticKey, PlayerId, 1);
+        });
     }
 
     Frpg2RequestMessage::EmptyResponse Response;
@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/Mark/MarkManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -22,26 +23,12 @@ MarkManager::MarkManager(Server* InServerInstance)
 {
 }
 
-MessageHandleResult MarkManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void MarkManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateMark)
-    {
-        return Handle_RequestCreateMark(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRemoveMark)
-    {
-        return Handle_RequestRemoveMark(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestReentryMark)
-    {
-        return Handle_RequestReentryMark(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetMarkList)
-    {
-        return Handle_RequestGetMarkList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateMark, this, &MarkManager::Handle_RequestCreateMark);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRemoveMark, this, &MarkManager::Handle_RequestRemoveMark);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestReentryMark, this, &MarkManager::Handle_RequestReentryMark);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetMarkList, this, &MarkManager::Handle_RequestGetMarkList);
 }
 
 MessageHandleResult MarkManager::Handle_RequestCreateMark(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
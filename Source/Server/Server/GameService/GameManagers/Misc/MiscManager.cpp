@@ -10,6 +10,7 @@
 #include "Server/GameService/GameManagers/Misc/MiscManager.h"
 #include "Server/GameService/GameService.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -19,42 +20,20 @@
 #include "Core/Utils/Logging.h"
 #include "Core/Utils/Strings.h"
 
-#include <unordered_set>
-
 MiscManager::MiscManager(Server* InServerInstance, GameService* InGameServiceInstance)
     : ServerInstance(InServerInstance)
     , GameServiceInstance(InGameServiceInstance)
 {
 }
 
-MessageHandleResult MiscManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void MiscManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyRingBell)
-    {
-        return Handle_RequestNotifyRingBell(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSendMessageToPlayers)
-    {
-        return Handle_RequestSendMessageToPlayers(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestMeasureUploadBandwidth)
-    {
-        return Handle_RequestMeasureUploadBandwidth(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestMeasureDownloadBandwidth)
-    {
-        return Handle_RequestMeasureDownloadBandwidth(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetOnlineShopItemList)
-    {
-        return Handle_RequestGetOnlineShopItemList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestBenchmarkThroughput)
-    {
-        return Handle_RequestBenchmarkThroughput(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyRingBell, this, &MiscManager::Handle_RequestNotifyRingBell);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSendMessageToPlayers, this, &MiscManager::Handle_RequestSendMessageToPlayers);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestMeasureUploadBandwidth, this, &MiscManager::Handle_RequestMeasureUploadBandwidth);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestMeasureDownloadBandwidth, this, &MiscManager::Handle_RequestMeasureDownloadBandwidth);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetOnlineShopItemList, this, &MiscManager::Handle_RequestGetOnlineShopItemList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestBenchmarkThroughput, this, &MiscManager::Handle_RequestBenchmarkThroughput);
 }
 
 void MiscManager::Poll()
@@ -63,13 +42,12 @@ void MiscManager::Poll()
 
 MessageHandleResult MiscManager::Handle_RequestNotifyRingBell(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestNotifyRingBell* Request = (Frpg2RequestMessage::RequestNotifyRingBell*)Message.Protobuf.get();
     
     // List of locations the user should be in to recieve a push notification about the bell.
-    std::unordered_set<OnlineAreaId> NotifyLocations = {
+    const OnlineAreaId NotifyLocations[] = {
         OnlineAreaId::Archdragon_Peak_Start,
         OnlineAreaId::Archdragon_Peak,
         OnlineAreaId::Archdragon_Peak_Ancient_Wyvern,
@@ -80,27 +58,26 @@ MessageHandleResult MiscManager::Handle_RequestNotifyRingBell(GameClient* Client
         OnlineAreaId::Archdragon_Peak_Mausoleum_Lift
     };
 
-    std::vector<std::shared_ptr<GameClient>> PotentialTargets = GameServiceInstance->FindClients([Client, Request, NotifyLocations](const std::shared_ptr<GameClient>& OtherClient) {
-        return NotifyLocations.count(OtherClient->GetPlayerState().GetCurrentArea()) > 0;
-    });
-
-    for (std::shared_ptr<GameClient>& OtherClient : PotentialTargets)
+    std::vector<std::shared_ptr<GameClient>> PotentialTargets;
+    for (OnlineAreaId AreaId : NotifyLocations)
     {
-        Frpg2RequestMessage::PushRequestNotifyRingBell PushMessage;
-        PushMessage.set_push_message_id(Frpg2RequestMessage::PushID_PushRequestNotifyRingBell);
-        PushMessage.set_player_id(Player.GetPlayerId());
-        PushMessage.set_online_area_id(Request->online_area_id());
-        PushMessage.set_data(Request->data().data(), Request->data().size());
+        std::vector<std::shared_ptr<GameClient>> AreaClients = GameServiceInstance->FindClientsInArea(AreaId, [](const std::shared_ptr<GameClient>& OtherClient) { return true; });
+        PotentialTargets.insert(PotentialTargets.end(), AreaClients.begin(), AreaClients.end());
+    }
 
-        if (!OtherClient->MessageStream->Send(&PushMessage))
-        {
-            WarningS(Client->GetName().c_str(), "Failed to send push message for bell ring to player '%s'", OtherClient->GetName().c_str());
-        }
+    Frpg2RequestMessage::PushRequestNotifyRingBell PushMessage;
+    PushMessage.set_push_message_id(Frpg2RequestMessage::PushID_PushRequestNotifyRingBell);
+    PushMessage.set_player_id(Player.GetPlayerId());
+    PushMessage.set_online_area_id(Request->online_area_id());
+    PushMessage.set_data(Request->data().data(), Request->data().size());
+
+    if (!GameServiceInstance->BroadcastPushMessage(&PushMessage, PotentialTargets))
+    {
+        WarningS(Client->GetName().c_str(), "Failed to send push message for bell ring.");
     }
 
     std::string TypeStatisticKey = StringFormat("Bell/TotalBellRings");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
 
     Frpg2RequestMessage::RequestNotifyRingBellResponse Response;
     if (!Client->MessageStream->Send(&Response, &Message))
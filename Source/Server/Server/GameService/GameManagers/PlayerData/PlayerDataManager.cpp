@@ -8,7 +8,9 @@
  */
 
 #include "Server/GameService/GameManagers/PlayerData/PlayerDataManager.h"
+#include "Server/GameService/GameService.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -25,73 +27,70 @@ PlayerDataManager::PlayerDataManager(Server* InServerInstance)
 {
 }
 
-MessageHandleResult PlayerDataManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void PlayerDataManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdateLoginPlayerCharacter)
-    {
-        return Handle_RequestUpdateLoginPlayerCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdatePlayerStatus)
-    {
-        return Handle_RequestUpdatePlayerStatus(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdatePlayerCharacter)
-    {
-        return Handle_RequestUpdatePlayerCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetPlayerCharacter)
-    {
-        return Handle_RequestGetPlayerCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetLoginPlayerCharacter)
-    {
-        return Handle_RequestGetLoginPlayerCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetPlayerCharacterList)
-    {
-        return Handle_RequestGetPlayerCharacterList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdateLoginPlayerCharacter, this, &PlayerDataManager::Handle_RequestUpdateLoginPlayerCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdatePlayerStatus, this, &PlayerDataManager::Handle_RequestUpdatePlayerStatus);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdatePlayerCharacter, this, &PlayerDataManager::Handle_RequestUpdatePlayerCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetPlayerCharacter, this, &PlayerDataManager::Handle_RequestGetPlayerCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetLoginPlayerCharacter, this, &PlayerDataManager::Handle_RequestGetLoginPlayerCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetPlayerCharacterList, this, &PlayerDataManager::Handle_RequestGetPlayerCharacterList);
 }
 
 MessageHandleResult PlayerDataManager::Handle_RequestUpdateLoginPlayerCharacter(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& State = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestUpdateLoginPlayerCharacter* Request = (Frpg2RequestMessage::RequestUpdateLoginPlayerCharacter*)Message.Protobuf.get();
 
-    std::shared_ptr<Character> Character = Database.FindCharacter(State.GetPlayerId(), Request->character_id());
-    if (!Character)
-    {
-        std::vector<uint8_t> Data;        
-        if (!Database.CreateOrUpdateCharacter(State.GetPlayerId(), Request->character_id(), Data))
-        {
-            WarningS(Client->GetName().c_str(), "Disconnecting client as failed to find or update character %i.", Request->character_id());
-            return MessageHandleResult::Error;
-        }
+    uint32_t PlayerId = State.GetPlayerId();
+    uint32_t CharacterId = Request->character_id();
 
-        Character = Database.FindCharacter(State.GetPlayerId(), Request->character_id());
-        Ensure(Character);
-    }
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
 
-    Frpg2RequestMessage::RequestUpdateLoginPlayerCharacterResponse Response;
-    Response.set_character_id(Request->character_id());
+    // Find the character on the database thread, creating it if this is the first time we've seen it.
+    ServerInstance->GetDatabaseExecutor().Run(
+        [PlayerId, CharacterId](ServerDatabase& Database) {
+            std::shared_ptr<Character> Character = Database.FindCharacter(PlayerId, CharacterId);
+            if (!Character)
+            {
+                std::vector<uint8_t> Data;        
+                if (Database.CreateOrUpdateCharacter(PlayerId, CharacterId, Data))
+                {
+                    Character = Database.FindCharacter(PlayerId, CharacterId);
+                }
+            }
+            return Character;
+        },
+        [WeakClient, ResponseTarget, CharacterId](std::shared_ptr<Character> Character) {
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
 
-    Frpg2RequestMessage::QuickMatchRank* Rank = Response.mutable_quickmatch_brawl_rank();
-    Rank->set_rank(Character->QuickMatchBrawlRank);
-    Rank->set_xp(Character->QuickMatchBrawlXp);
+            if (!Character)
+            {
+                WarningS(Client->GetName().c_str(), "Disconnecting client as failed to find or update character %i.", CharacterId);
+                Client->DisconnectTime = GetSeconds();
+                return;
+            }
 
-    Rank = Response.mutable_quickmatch_dual_rank();
-    Rank->set_rank(Character->QuickMatchDuelRank);
-    Rank->set_xp(Character->QuickMatchDuelXp);
+            Frpg2RequestMessage::RequestUpdateLoginPlayerCharacterResponse Response;
+            Response.set_character_id(CharacterId);
 
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestUpdateLoginPlayerCharacterResponse response.");
-        return MessageHandleResult::Error;
-    }
+            Frpg2RequestMessage::QuickMatchRank* Rank = Response.mutable_quickmatch_brawl_rank();
+            Rank->set_rank(Character->QuickMatchBrawlRank);
+            Rank->set_xp(Character->QuickMatchBrawlXp);
+
+            Rank = Response.mutable_quickmatch_dual_rank();
+            Rank->set_rank(Character->QuickMatchDuelRank);
+            Rank->set_xp(Character->QuickMatchDuelXp);
+
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
     
     return MessageHandleResult::Handled;
 }
@@ -200,6 +199,9 @@ MessageHandleResult PlayerDataManager::Handle_RequestUpdatePlayerStatus(GameClie
         }
     }
 
+    // Keep the game services area and matchmaking lookups up to date.
+    ServerInstance->GetService<GameService>()->UpdateClientIndexes(Client);
+
     Frpg2RequestMessage::RequestUpdatePlayerStatusResponse Response;
     if (!Client->MessageStream->Send(&Response, &Message))
     {
@@ -212,7 +214,6 @@ MessageHandleResult PlayerDataManager::Handle_RequestUpdatePlayerStatus(GameClie
 
 MessageHandleResult PlayerDataManager::Handle_RequestUpdatePlayerCharacter(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& State = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestUpdatePlayerCharacter* Request = (Frpg2RequestMessage::RequestUpdatePlayerCharacter*)Message.Protobuf.get();
@@ -220,46 +221,74 @@ MessageHandleResult PlayerDataManager::Handle_RequestUpdatePlayerCharacter(GameC
     std::vector<uint8_t> Data;
     Data.assign(Request->character_data().data(), Request->character_data().data() + Request->character_data().size());
 
-    if (!Database.CreateOrUpdateCharacter(State.GetPlayerId(), Request->character_id(), Data))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to find or update character %i.", Request->character_id());
-        return MessageHandleResult::Error;
-    }
+    uint32_t PlayerId = State.GetPlayerId();
+    uint32_t CharacterId = Request->character_id();
 
-    Frpg2RequestMessage::RequestUpdatePlayerCharacterResponse Response;
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestUpdatePlayerCharacterResponse response.");
-        return MessageHandleResult::Error;
-    }
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
+
+    // Character saves are large and frequent, write them on the database thread.
+    ServerInstance->GetDatabaseExecutor().Run(
+        [PlayerId, CharacterId, Data](ServerDatabase& Database) {
+            return Database.CreateOrUpdateCharacter(PlayerId, CharacterId, Data);
+        },
+        [WeakClient, ResponseTarget, CharacterId](bool Success) {
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
+
+            if (!Success)
+            {
+                WarningS(Client->GetName().c_str(), "Disconnecting client as failed to find or update character %i.", CharacterId);
+                Client->DisconnectTime = GetSeconds();
+                return;
+            }
+
+            Frpg2RequestMessage::RequestUpdatePlayerCharacterResponse Response;
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
 
 MessageHandleResult PlayerDataManager::Handle_RequestGetPlayerCharacter(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
-    PlayerState& State = Client->GetPlayerState();
-
     Frpg2RequestMessage::RequestGetPlayerCharacter* Request = (Frpg2RequestMessage::RequestGetPlayerCharacter*)Message.Protobuf.get();
-    Frpg2RequestMessage::RequestGetPlayerCharacterResponse Response;
 
-    std::vector<uint8_t> CharacterData;
-    std::shared_ptr<Character> Character = Database.FindCharacter(Request->player_id(), Request->character_id());
-    if (Character)
-    {
-        CharacterData = Character->Data;
-    }
+    uint32_t PlayerId = Request->player_id();
+    uint32_t CharacterId = Request->character_id();
 
-    Response.set_player_id(Request->player_id());
-    Response.set_character_id(Request->character_id());
-    Response.set_character_data(CharacterData.data(), CharacterData.size());
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
 
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestGetPlayerCharacterResponse response.");
-        return MessageHandleResult::Error;
-    }
+    ServerInstance->GetDatabaseExecutor().Run(
+        [PlayerId, CharacterId](ServerDatabase& Database) {
+            return Database.FindCharacter(PlayerId, CharacterId);
+        },
+        [WeakClient, ResponseTarget, PlayerId, CharacterId](std::shared_ptr<Character> Character) {
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
+
+            std::vector<uint8_t> CharacterData;
+            if (Character)
+            {
+                CharacterData = Character->Data;
+            }
+
+            Frpg2RequestMessage::RequestGetPlayerCharacterResponse Response;
+            Response.set_player_id(PlayerId);
+            Response.set_character_id(CharacterId);
+            Response.set_character_data(CharacterData.data(), CharacterData.size());
+
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
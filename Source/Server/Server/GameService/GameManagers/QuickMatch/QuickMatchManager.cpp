@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/QuickMatch/QuickMatchManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -20,6 +21,12 @@
 #include "Core/Utils/File.h"
 #include "Core/Utils/Strings.h"
 
+#include "Config/BuildConfig.h"
+
+#include <algorithm>
+#include <cmath>
+#include <climits>
+
 QuickMatchManager::QuickMatchManager(Server* InServerInstance, GameService* InGameServiceInstance)
     : ServerInstance(InServerInstance)
     , GameServiceInstance(InGameServiceInstance)
@@ -28,19 +35,10 @@ QuickMatchManager::QuickMatchManager(Server* InServerInstance, GameService* InGa
 
 void QuickMatchManager::OnLostPlayer(GameClient* Client)
 {
-    for (auto Iter = Matches.begin(); Iter != Matches.end(); /* empty */)
+    if (std::shared_ptr<Match> ExistingMatch = GetMatchByHost(Client->GetPlayerState().GetPlayerId()))
     {
-        std::shared_ptr<Match> Match = *Iter;
-
-        if (Match->HostPlayerId == Client->GetPlayerState().GetPlayerId())
-        {
-            LogS(Client->GetName().c_str(), "Unregistered quick match hosted by player %u, as player has disconnected.", Match->HostPlayerId);
-            Iter = Matches.erase(Iter);
-        }
-        else
-        {
-            Iter++;
-        }
+        LogS(Client->GetName().c_str(), "Unregistered quick match hosted by player %u, as player has disconnected.", ExistingMatch->HostPlayerId);
+        RemoveMatch(ExistingMatch);
     }
 }
 
@@ -48,104 +46,169 @@ void QuickMatchManager::Poll()
 {
 }
 
-MessageHandleResult QuickMatchManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void QuickMatchManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
+{
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSearchQuickMatch, this, &QuickMatchManager::Handle_RequestSearchQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUnregisterQuickMatch, this, &QuickMatchManager::Handle_RequestUnregisterQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdateQuickMatch, this, &QuickMatchManager::Handle_RequestUpdateQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestJoinQuickMatch, this, &QuickMatchManager::Handle_RequestJoinQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestAcceptQuickMatch, this, &QuickMatchManager::Handle_RequestAcceptQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRejectQuickMatch, this, &QuickMatchManager::Handle_RequestRejectQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRegisterQuickMatch, this, &QuickMatchManager::Handle_RequestRegisterQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSendQuickMatchStart, this, &QuickMatchManager::Handle_RequestSendQuickMatchStart);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSendQuickMatchResult, this, &QuickMatchManager::Handle_RequestSendQuickMatchResult);
+}
+
+bool QuickMatchManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Request, const std::shared_ptr<Match>& Match)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSearchQuickMatch)
+    // Game mode and map are already matched by the lobby the match was found in.
+
+    // Can match with the hosts level.
+    const RuntimeConfig& Config = ServerInstance->GetConfig();
+    const RuntimeConfigMatchingParameters* MatchingParams = &Config.UndeadMatchMatchingParameters;
+
+    if (!MatchingParams->CheckMatch(
+        Match->MatchingParams.soul_level(), Match->MatchingParams.weapon_level(),
+        Request.soul_level(), Request.weapon_level(),
+        Match->MatchingParams.password().size() > 0
+    ))
     {
-        return Handle_RequestSearchQuickMatch(Client, Message);
+        return false;
     }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUnregisterQuickMatch)
+
+    // Check passwords match.
+    if (Match->MatchingParams.password() != Request.password())
     {
-        return Handle_RequestUnregisterQuickMatch(Client, Message);
+        return false;
     }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdateQuickMatch)
+
+    return true;
+}
+
+std::shared_ptr<QuickMatchManager::Match> QuickMatchManager::GetMatchByHost(uint32_t HostPlayerId)
+{
+    if (auto Iter = MatchesByHost.find(HostPlayerId); Iter != MatchesByHost.end())
     {
-        return Handle_RequestUpdateQuickMatch(Client, Message);
+        return Iter->second;
     }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestJoinQuickMatch)
+    return nullptr;
+}
+
+QuickMatchManager::LobbyKey QuickMatchManager::GetLobbyKey(const Match& ForMatch)
+{
+    return { ForMatch.GameMode, ForMatch.MapId, ForMatch.AreaId, ForMatch.MatchingParams.password() };
+}
+
+int QuickMatchManager::GetLevelBand(int SoulLevel)
+{
+    return std::max(SoulLevel, 0) / BuildConfig::MATCHMAKING_SOUL_LEVEL_BUCKET_SIZE;
+}
+
+void QuickMatchManager::AddMatch(const std::shared_ptr<Match>& NewMatch)
+{
+    // Registering again replaces whatever match the host had open.
+    if (std::shared_ptr<Match> ExistingMatch = GetMatchByHost(NewMatch->HostPlayerId))
     {
-        return Handle_RequestJoinQuickMatch(Client, Message);
+        RemoveMatch(ExistingMatch);
     }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestAcceptQuickMatch)
+
+    NewMatch->LevelBand = GetLevelBand(NewMatch->MatchingParams.soul_level());
+
+    std::vector<std::shared_ptr<Match>>& Band = Lobbies[GetLobbyKey(*NewMatch)].LevelBands[NewMatch->LevelBand];
+    NewMatch->BandIndex = Band.size();
+    Band.push_back(NewMatch);
+
+    MatchesByHost[NewMatch->HostPlayerId] = NewMatch;
+}
+
+void QuickMatchManager::RemoveMatch(std::shared_ptr<Match> ExistingMatch)
+{
+    if (auto Iter = MatchesByHost.find(ExistingMatch->HostPlayerId); Iter != MatchesByHost.end() && Iter->second == ExistingMatch)
     {
-        return Handle_RequestAcceptQuickMatch(Client, Message);
+        MatchesByHost.erase(Iter);
     }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRejectQuickMatch)
+
+    auto LobbyIter = Lobbies.find(GetLobbyKey(*ExistingMatch));
+    if (LobbyIter == Lobbies.end())
     {
-        return Handle_RequestRejectQuickMatch(Client, Message);
+        return;
     }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRegisterQuickMatch)
+
+    auto BandIter = LobbyIter->second.LevelBands.find(ExistingMatch->LevelBand);
+    if (BandIter == LobbyIter->second.LevelBands.end())
     {
-        return Handle_RequestRegisterQuickMatch(Client, Message);
+        return;
     }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSendQuickMatchStart)
+
+    // Order within a band doesn't matter, so move the last match into the gap rather than shuffling everything down.
+    std::vector<std::shared_ptr<Match>>& Band = BandIter->second;
+    size_t Index = ExistingMatch->BandIndex;
+    if (Index < Band.size() && Band[Index] == ExistingMatch)
     {
-        return Handle_RequestSendQuickMatchStart(Client, Message);
+        Band[Index] = Band.back();
+        Band[Index]->BandIndex = Index;
+        Band.pop_back();
     }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSendQuickMatchResult)
+
+    if (Band.empty())
     {
-        return Handle_RequestSendQuickMatchResult(Client, Message);
+        LobbyIter->second.LevelBands.erase(BandIter);
+        if (LobbyIter->second.LevelBands.empty())
+        {
+            Lobbies.erase(LobbyIter);
+        }
     }
-
-    return MessageHandleResult::Unhandled;
 }
 
-bool QuickMatchManager::CanMatchWith(GameClient* Client, const Frpg2RequestMessage::RequestSearchQuickMatch& Request, const std::shared_ptr<Match>& Match)
+void QuickMatchManager::GatherCandidates(const Lobby& SearchLobby, const Frpg2RequestMessage::MatchingParameter& Request, std::vector<std::shared_ptr<Match>>& Candidates)
 {
-    // Matches requested game mode.
-    if (Match->GameMode != Request.mode())
-    {
-        return false;
-    }
+    const RuntimeConfig& Config = ServerInstance->GetConfig();
+    const RuntimeConfigMatchingParameters& MatchingParams = Config.UndeadMatchMatchingParameters;
+    const auto& Bands = SearchLobby.LevelBands;
 
-    // Matches requested map.
-    bool ValidMap = false;
-    for (int i = 0; i < Request.map_id_list_size(); i++)
-    {
-        if (Request.map_id_list(i).map_id() == (uint32_t)Match->MapId &&
-            Request.map_id_list(i).online_area_id() == (uint32_t)Match->AreaId)
+    auto AddBands = [&Candidates](auto Start, auto End) {
+        for (auto Iter = Start; Iter != End; Iter++)
         {
-            ValidMap = true;
-            break;
+            Candidates.insert(Candidates.end(), Iter->second.begin(), Iter->second.end());
         }
-    }
-    if (!ValidMap)
+    };
+
+    // Everyone in the lobby has the same password as us, so if that lifts the limits every band is valid.
+    bool HasPassword = Request.password().size() > 0;
+    if (MatchingParams.DisableLevelMatching || (MatchingParams.PasswordDisablesLimits && HasPassword))
     {
-        return false;
+        AddBands(Bands.begin(), Bands.end());
+        return;
     }
 
-    // Can match with the hosts level.
-    const RuntimeConfig& Config = ServerInstance->GetConfig();
-    const RuntimeConfigMatchingParameters* MatchingParams = &Config.UndeadMatchMatchingParameters;
+    // Hosts below the range removal level accept (HostLevel * Multiplier) + Modifier either side of them, so work
+    // backwards to the range of host levels that would accept us. This is rounded outwards, CanMatchWith does the exact check.
+    auto ToLevel = [](double Level) { return (int)std::clamp(Level, -1.0, (double)(INT_MAX / 2)); };
 
-    if (!MatchingParams->CheckMatch(
-        Match->MatchingParams.soul_level(), Match->MatchingParams.weapon_level(),
-        Request.matching_parameter().soul_level(), Request.matching_parameter().weapon_level(),
-        Match->MatchingParams.password().size() > 0
-    ))
+    double SoulLevel = (double)Request.soul_level();
+    int MinHostLevel = 0;
+    int MaxHostLevel = MatchingParams.RangeRemovalLevel - 1;
+    if (MatchingParams.UpperLimitMultiplier > 0.0f)
     {
-        return false;
+        MinHostLevel = std::max(MinHostLevel, ToLevel(std::floor((SoulLevel - MatchingParams.UpperLimitModifier) / MatchingParams.UpperLimitMultiplier)) - 1);
     }
-
-    // Check passwords match.
-    if (Match->MatchingParams.password() != Request.matching_parameter().password())
+    if (MatchingParams.LowerLimitMultiplier > 0.0f)
     {
-        return false;
+        MaxHostLevel = std::min(MaxHostLevel, ToLevel(std::ceil((SoulLevel - MatchingParams.LowerLimitModifier) / MatchingParams.LowerLimitMultiplier)) + 1);
     }
 
-    return true;
-}
+    int NextBand = 0;
+    if (MinHostLevel <= MaxHostLevel)
+    {
+        AddBands(Bands.lower_bound(GetLevelBand(MinHostLevel)), Bands.upper_bound(GetLevelBand(MaxHostLevel)));
+        NextBand = GetLevelBand(MaxHostLevel) + 1;
+    }
 
-std::shared_ptr<QuickMatchManager::Match> QuickMatchManager::GetMatchByHost(uint32_t HostPlayerId)
-{
-    for (std::shared_ptr<Match>& Iter : Matches)
+    // Hosts at or above the range removal level accept anyone else who is.
+    if (Request.soul_level() >= MatchingParams.RangeRemovalLevel)
     {
-        if (Iter->HostPlayerId == HostPlayerId)
-        {
-            return Iter;
-        }
+        AddBands(Bands.lower_bound(std::max(NextBand, GetLevelBand(MatchingParams.RangeRemovalLevel))), Bands.end());
     }
-    return nullptr;
 }
 
 MessageHandleResult QuickMatchManager::Handle_RequestSearchQuickMatch(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
@@ -153,10 +216,33 @@ MessageHandleResult QuickMatchManager::Handle_RequestSearchQuickMatch(GameClient
     Frpg2RequestMessage::RequestSearchQuickMatch* Request = (Frpg2RequestMessage::RequestSearchQuickMatch*)Message.Protobuf.get();
     Frpg2RequestMessage::RequestSearchQuickMatchResponse Response;
 
+    // Only look in the lobbies for the maps the client asked for.
+    std::vector<std::shared_ptr<Match>> Candidates;
+    std::vector<const Lobby*> SearchedLobbies;
+    for (int i = 0; i < Request->map_id_list_size(); i++)
+    {
+        LobbyKey Key = { Request->mode(), Request->map_id_list(i).map_id(), (OnlineAreaId)Request->map_id_list(i).online_area_id(), Request->matching_parameter().password() };
+        auto LobbyIter = Lobbies.find(Key);
+        if (LobbyIter == Lobbies.end())
+        {
+            continue;
+        }
+
+        // Don't return the same matches twice if a map is listed more than once.
+        const Lobby* SearchLobby = &LobbyIter->second;
+        if (std::find(SearchedLobbies.begin(), SearchedLobbies.end(), SearchLobby) != SearchedLobbies.end())
+        {
+            continue;
+        }
+        SearchedLobbies.push_back(SearchLobby);
+
+        GatherCandidates(*SearchLobby, Request->matching_parameter(), Candidates);
+    }
+
     int ResultCount = 0;
-    for (std::shared_ptr<Match>& Iter : Matches)
+    for (std::shared_ptr<Match>& Iter : Candidates)
     {
-        if (!CanMatchWith(Client, *Request, Iter))
+        if (!CanMatchWith(Request->matching_parameter(), Iter))
         {
             continue;
         }
@@ -208,7 +294,7 @@ MessageHandleResult QuickMatchManager::Handle_RequestRegisterQuickMatch(GameClie
     LogS(Client->GetName().c_str(), "RequestRegisterQuickMatch: Hosting new match.");
     Log(" unknown_5 = %i", Request->unknown_5());
 
-    Matches.push_back(NewMatch);
+    AddMatch(NewMatch);
 
     if (!Client->MessageStream->Send(&Response, &Message))
     {
@@ -224,23 +310,16 @@ MessageHandleResult QuickMatchManager::Handle_RequestUnregisterQuickMatch(GameCl
     Frpg2RequestMessage::RequestUnregisterQuickMatch* Request = (Frpg2RequestMessage::RequestUnregisterQuickMatch*)Message.Protobuf.get();
     Frpg2RequestMessage::RequestUnregisterQuickMatchResponse Response;
 
-    for (auto Iter = Matches.begin(); Iter != Matches.end(); /* empty */)
+    std::shared_ptr<Match> ExistingMatch = GetMatchByHost(Client->GetPlayerState().GetPlayerId());
+    if (ExistingMatch &&
+                  ExistingMatch->GameMode == Request->mode() &&
+                  ExistingMatch->MapId == Request->map_id() &&
+        (uint32_t)ExistingMatch->AreaId == Request->online_area_id())
     {
-        std::shared_ptr<Match> Match = *Iter;
-        if (          Match->HostPlayerId == Client->GetPlayerState().GetPlayerId() &&
-                      Match->GameMode == Request->mode() &&
-                      Match->MapId == Request->map_id() &&
-            (uint32_t)Match->AreaId == Request->online_area_id())
-        {
-            LogS(Client->GetName().c_str(), "RequestUnregisterQuickMatch: Unregistered quick match hosted by self.", Match->HostPlayerId);
-            Log(" unknown_4 = %i", Request->unknown_4());
+        LogS(Client->GetName().c_str(), "RequestUnregisterQuickMatch: Unregistered quick match hosted by self.", ExistingMatch->HostPlayerId);
+        Log(" unknown_4 = %i", Request->unknown_4());
 
-            Iter = Matches.erase(Iter);
-        }
-        else
-        {
-            Iter++;
-        }
+        RemoveMatch(ExistingMatch);
     }
 
     if (!Client->MessageStream->Send(&Response, &Message))
@@ -408,15 +487,10 @@ MessageHandleResult QuickMatchManager::Handle_RequestSendQuickMatchStart(GameCli
 
     LogS(Client->GetName().c_str(), "RequestSendQuickMatchStart: Starting quick match hosted by self.");
 
-    for (auto Iter = Matches.begin(); Iter != Matches.end(); Iter++)
+    if (std::shared_ptr<Match> ExistingMatch = GetMatchByHost(Player.GetPlayerId()))
     {
-        std::shared_ptr<Match> Match = *Iter;
-        if (Match->HostPlayerId == Player.GetPlayerId())
-        {
-            LogS(Client->GetName().c_str(), "Unregistered quick match hosted by player %u, as it has started.", Match->HostPlayerId);
-            Matches.erase(Iter);
-            break;
-        }
+        LogS(Client->GetName().c_str(), "Unregistered quick match hosted by player %u, as it has started.", ExistingMatch->HostPlayerId);
+        RemoveMatch(ExistingMatch);
     }
 
     Frpg2RequestMessage::RequestSendQuickMatchStartResponse Response;
@@ -431,48 +505,31 @@ MessageHandleResult QuickMatchManager::Handle_RequestSendQuickMatchStart(GameCli
 
 MessageHandleResult QuickMatchManager::Handle_RequestSendQuickMatchResult(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     const RuntimeConfig& Config = ServerInstance->GetConfig();
     PlayerState& State = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestSendQuickMatchResult* Request = (Frpg2RequestMessage::RequestSendQuickMatchResult*)Message.Protobuf.get();
-    Frpg2RequestMessage::RequestSendQuickMatchResultResponse Response;
-    Response.set_unknown_1(0); // TODO: Figure out.
 
     LogS(Client->GetName().c_str(), "RequestSendQuickMatchResult: Sending quick match results hosted by self.");
 
-    // Grab the players character to get their current rank data.
-    std::shared_ptr<Character> Character = Database.FindCharacter(State.GetPlayerId(), State.GetCharacterId());
-    if (!Character)
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to find current character during QuickMatchResult.");
-        return MessageHandleResult::Error;
-    }
-
-    // Increase and return rank.
     bool IsDuel = (Request->mode() == Frpg2RequestMessage::QuickMatchGameMode::Duel);
 
-    uint32_t OriginalRank = IsDuel ? Character->QuickMatchDuelRank : Character->QuickMatchBrawlRank;
-    uint32_t OriginalXP = IsDuel ? Character->QuickMatchDuelXp : Character->QuickMatchBrawlXp;
-
-    uint32_t& Rank = IsDuel ? Character->QuickMatchDuelRank : Character->QuickMatchBrawlRank;
-    uint32_t& XP = IsDuel ? Character->QuickMatchDuelXp : Character->QuickMatchBrawlXp;
-    
+    uint32_t XPGained = 0;
     switch (Request->result())
     {
         case Frpg2RequestMessage::QuickMatchResult::QuickMatchResult_Win:
         {
-            XP += Config.QuickMatchWinXp;
+            XPGained = Config.QuickMatchWinXp;
             break;
         }
         case Frpg2RequestMessage::QuickMatchResult::QuickMatchResult_Draw:
         {
-            XP += Config.QuickMatchDrawXp;
+            XPGained = Config.QuickMatchDrawXp;
             break;
         }
         case Frpg2RequestMessage::QuickMatchResult::QuickMatchResult_Lose:
         {
-            XP += Config.QuickMatchLoseXp;
+            XPGained = Config.QuickMatchLoseXp;
             break;
         }
         case Frpg2RequestMessage::QuickMatchResult::QuickMatchResult_Disconnect:
@@ -482,41 +539,92 @@ MessageHandleResult QuickMatchManager::Handle_RequestSendQuickMatchResult(GameCl
         }
     }
 
-    while (Rank < Config.QuickMatchRankXp.size() - 1)
+    struct RankUpdate
     {
-        uint32_t NextRankXP = Config.QuickMatchRankXp[Rank + 1];
-        if (XP > NextRankXP)
-        {
-            Rank++;
-            XP -= NextRankXP;
-        }
-        else
-        {
-            break;
-        }
-    }
+        bool Success = false;
+        uint32_t Rank = 0;
+        uint32_t XP = 0;
+        uint32_t OriginalRank = 0;
+        uint32_t OriginalXP = 0;
+    };
 
-    Response.mutable_new_local_rank()->set_rank(Rank);
-    Response.mutable_new_local_rank()->set_xp(XP);
+    uint32_t PlayerId = State.GetPlayerId();
+    uint32_t CharacterId = State.GetCharacterId();
 
-    LogS(Client->GetName().c_str(), "Player finished undead match, ranked up to: rank=%i xp=%i (from rank=%i xp=%i)", Rank, XP, OriginalRank, OriginalXP);
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    Frpg2ReliableUdpMessage ResponseTarget = GameClient::MakeDeferredResponseTarget(Message);
 
-    // Update character state.
-    if (!Database.UpdateCharacterQuickMatchRank(State.GetPlayerId(), State.GetCharacterId(), Character->QuickMatchDuelRank, Character->QuickMatchDuelXp, Character->QuickMatchBrawlRank, Character->QuickMatchBrawlXp))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to update their quick match result.");
-        return MessageHandleResult::Error;
-    }
+    // Grab the players character to get their current rank data, then increase and store it. This is all
+    // done on the database thread so results from back to back matches can't overwrite each other.
+    ServerInstance->GetDatabaseExecutor().Run(
+        [PlayerId, CharacterId, IsDuel, XPGained, RankXp = Config.QuickMatchRankXp](ServerDatabase& Database) {
+            RankUpdate Result;
 
-    std::string TypeStatisticKey = StringFormat("QuickMatch/TotalMatches");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, State.GetPlayerId(), 1);
+            std::shared_ptr<Character> Character = Database.FindCharacter(PlayerId, CharacterId);
+            if (!Character)
+            {
+                return Result;
+            }
 
-    if (!Client->MessageStream->Send(&Response, &Message))
-    {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestSendQuickMatchResultResponse response.");
-        return MessageHandleResult::Error;
-    }
+            uint32_t& Rank = IsDuel ? Character->QuickMatchDuelRank : Character->QuickMatchBrawlRank;
+            uint32_t& XP = IsDuel ? Character->QuickMatchDuelXp : Character->QuickMatchBrawlXp;
+
+            Result.OriginalRank = Rank;
+            Result.OriginalXP = XP;
+
+            XP += XPGained;
+
+            while (Rank < RankXp.size() - 1)
+            {
+                uint32_t NextRankXP = RankXp[Rank + 1];
+                if (XP > NextRankXP)
+                {
+                    Rank++;
+                    XP -= NextRankXP;
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            Result.Rank = Rank;
+            Result.XP = XP;
+
+            // Update character state.
+            Result.Success = Database.UpdateCharacterQuickMatchRank(PlayerId, CharacterId, Character->QuickMatchDuelRank, Character->QuickMatchDuelXp, Character->QuickMatchBrawlRank, Character->QuickMatchBrawlXp);
+            if (Result.Success)
+            {
+                std::string TypeStatisticKey = StringFormat("QuickMatch/TotalMatches");
+                Database.AddGlobalStatistic(TypeStatisticKey, 1);
+                Database.AddPlayerStatistic(TypeStatisticKey, PlayerId, 1);
+            }
+            return Result;
+        },
+        [WeakClient, ResponseTarget](const RankUpdate& Update) {
+            std::shared_ptr<GameClient> Client = WeakClient.lock();
+            if (!Client)
+            {
+                return;
+            }
+
+            if (!Update.Success)
+            {
+                WarningS(Client->GetName().c_str(), "Disconnecting client as failed to update their quick match result.");
+                Client->DisconnectTime = GetSeconds();
+                return;
+            }
+
+            LogS(Client->GetName().c_str(), "Player finished undead match, ranked up to: rank=%i xp=%i (from rank=%i xp=%i)", Update.Rank, Update.XP, Update.OriginalRank, Update.OriginalXP);
+
+            Frpg2RequestMessage::RequestSendQuickMatchResultResponse Response;
+            Response.set_unknown_1(0); // TODO: Figure out.
+            Response.mutable_new_local_rank()->set_rank(Update.Rank);
+            Response.mutable_new_local_rank()->set_xp(Update.XP);
+
+            Client->SendDeferredResponse(&Response, ResponseTarget);
+        }
+    );
 
     return MessageHandleResult::Handled;
 }
@@ -13,6 +13,12 @@
 #include "Protobuf/Protobufs.h"
 #include "Server/GameService/Utils/GameIds.h"
 
+#include <unordered_map>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <memory>
+
 struct Frpg2ReliableUdpMessage;
 class Server;
 class GameService;
@@ -25,7 +31,7 @@ class QuickMatchManager
 public:    
     QuickMatchManager(Server* InServerInstance, GameService* InGameServiceInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
@@ -33,7 +39,7 @@ public:
 
     virtual void OnLostPlayer(GameClient* Client) override;
     
-    size_t GetLiveCount() { return Matches.size(); }
+    size_t GetLiveCount() { return MatchesByHost.size(); }
 
 protected:
     MessageHandleResult Handle_RequestSearchQuickMatch(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
@@ -59,17 +65,43 @@ private:
         OnlineAreaId AreaId;
 
         bool HasStarted = false;
+
+        // Where the match is stored in the lobby index.
+        int LevelBand = 0;
+        size_t BandIndex = 0;
+    };
+
+    // Open matches can only be joined by players searching for the same mode, in the same
+    // map and with the same password, so those make up the key. Within a lobby matches are
+    // split into bands by the hosts soul level so searches only look at hosts whose level
+    // range could include the searcher.
+    using LobbyKey = std::tuple<Frpg2RequestMessage::QuickMatchGameMode, uint32_t, OnlineAreaId, std::string>;
+
+    struct Lobby
+    {
+        std::map<int, std::vector<std::shared_ptr<Match>>> LevelBands;
     };
 
 private:
-    bool CanMatchWith(GameClient* Client, const Frpg2RequestMessage::RequestSearchQuickMatch& Request, const std::shared_ptr<Match>& Match);
+    bool CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Request, const std::shared_ptr<Match>& Match);
 
     std::shared_ptr<Match> GetMatchByHost(uint32_t HostPlayerId);
 
+    void AddMatch(const std::shared_ptr<Match>& NewMatch);
+    void RemoveMatch(std::shared_ptr<Match> ExistingMatch);
+
+    // Gets every match in the lobby that the searcher may be able to join, matches still need checking with CanMatchWith.
+    void GatherCandidates(const Lobby& SearchLobby, const Frpg2RequestMessage::MatchingParameter& Request, std::vector<std::shared_ptr<Match>>& Candidates);
+
+    static LobbyKey GetLobbyKey(const Match& ForMatch);
+    static int GetLevelBand(int SoulLevel);
+
 private:
     Server* ServerInstance;
     GameService* GameServiceInstance;
 
-    std::vector<std::shared_ptr<Match>> Matches;
+    // A host can only have one match open at a time.
+    std::unordered_map<uint32_t, std::shared_ptr<Match>> MatchesByHost;
+    std::map<LobbyKey, Lobby> Lobbies;
 
 };
\ No newline at end of file
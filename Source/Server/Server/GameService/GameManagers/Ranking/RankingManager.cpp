@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/Ranking/RankingManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -23,31 +24,16 @@ RankingManager::RankingManager(Server* InServerInstance)
 {
 }
 
-MessageHandleResult RankingManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void RankingManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRegisterRankingData)
-    {
-        return Handle_RequestRegisterRankingData(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetRankingData)
-    {
-        return Handle_RequestGetRankingData(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetCharacterRankingData)
-    {
-        return Handle_RequestGetCharacterRankingData(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCountRankingData)
-    {
-        return Handle_RequestCountRankingData(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRegisterRankingData, this, &RankingManager::Handle_RequestRegisterRankingData);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetRankingData, this, &RankingManager::Handle_RequestGetRankingData);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetCharacterRankingData, this, &RankingManager::Handle_RequestGetCharacterRankingData);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCountRankingData, this, &RankingManager::Handle_RequestCountRankingData);
 }
 
-MessageHandleResult RankingManager::Handle_RequestRegisterRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+Task<MessageHandleResult> RankingManager::Handle_RequestRegisterRankingData(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestRegisterRankingData* Request = (Frpg2RequestMessage::RequestRegisterRankingData*)Message.Protobuf.get();
@@ -55,34 +41,52 @@ MessageHandleResult RankingManager::Handle_RequestRegisterRankingData(GameClient
     std::vector<uint8_t> Data;
     Data.assign(Request->data().data(), Request->data().data() + Request->data().size());
 
-    if (!Database.RegisterScore(Request->board_id(), Player.GetPlayerId(), Request->character_id(), Request->score(), Data))
+    uint32_t BoardId = Request->board_id();
+    uint32_t PlayerId = Player.GetPlayerId();
+    uint32_t CharacterId = Request->character_id();
+    uint32_t Score = Request->score();
+
+    // Registering re-ranks the whole board, so this is done on the database thread.
+    bool Success = co_await ServerInstance->GetDatabaseExecutor().Query([BoardId, PlayerId, CharacterId, Score, Data](ServerDatabase& Database) {
+        if (!Database.RegisterScore(BoardId, PlayerId, CharacterId, Score, Data))
+        {
+            return false;
+        }
+
+        std::string TypeStatisticKey = StringFormat("Ranking/TotalRegistrations");
+        Database.AddGlobalStatistic(TypeStatisticKey, 1);
+        Database.AddPlayerStatistic(TypeStatisticKey, PlayerId, 1);
+
+        return true;
+    });
+
+    if (!Success)
     {
         WarningS(Client->GetName().c_str(), "Failed to register score in database.");
-        return MessageHandleResult::Error;
+        co_return MessageHandleResult::Error;
     }
 
-    std::string TypeStatisticKey = StringFormat("Ranking/TotalRegistrations");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
-
     // Empty response.
     Frpg2RequestMessage::RequestRegisterRankingDataResponse Response;
-    if (!Client->MessageStream->Send(&Response, &Message))
+    if (!Client->SendDeferredResponse(&Response, Message))
     {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestRegisterRankingDataResponse response.");
-        return MessageHandleResult::Error;
+        co_return MessageHandleResult::Error;
     }
 
-    return MessageHandleResult::Handled;
+    co_return MessageHandleResult::Handled;
 }
 
-MessageHandleResult RankingManager::Handle_RequestGetRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+Task<MessageHandleResult> RankingManager::Handle_RequestGetRankingData(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
-
     Frpg2RequestMessage::RequestGetRankingData* Request = (Frpg2RequestMessage::RequestGetRankingData*)Message.Protobuf.get();
-    
-    std::vector<std::shared_ptr<Ranking>> Rankings = Database.GetRankings(Request->board_id(), Request->offset(), Request->count());
+
+    uint32_t BoardId = Request->board_id();
+    uint32_t Offset = Request->offset();
+    uint32_t Count = Request->count();
+
+    std::vector<std::shared_ptr<Ranking>> Rankings = co_await ServerInstance->GetDatabaseExecutor().Query([BoardId, Offset, Count](ServerDatabase& Database) {
+        return Database.GetRankings(BoardId, Offset, Count);
+    });
     
     Frpg2RequestMessage::RequestGetRankingDataResponse Response;
     for (std::shared_ptr<Ranking>& Ranking : Rankings)
@@ -96,29 +100,35 @@ MessageHandleResult RankingManager::Handle_RequestGetRankingData(GameClient* Cli
         Data.set_data(Ranking->Data.data(), Ranking->Data.size());
     }
 
-    if (!Client->MessageStream->Send(&Response, &Message))
+    if (!Client->SendDeferredResponse(&Response, Message))
     {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestGetRankingDataResponse response.");
-        return MessageHandleResult::Error;
+        co_return MessageHandleResult::Error;
     }
 
-    return MessageHandleResult::Handled;
+    co_return MessageHandleResult::Handled;
 }
 
-MessageHandleResult RankingManager::Handle_RequestGetCharacterRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+Task<MessageHandleResult> RankingManager::Handle_RequestGetCharacterRankingData(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestGetCharacterRankingData* Request = (Frpg2RequestMessage::RequestGetCharacterRankingData*)Message.Protobuf.get();
+
+    uint32_t BoardId = Request->board_id();
+    uint32_t PlayerId = Player.GetPlayerId();
+    uint32_t CharacterId = Request->character_id();
+
+    std::shared_ptr<Ranking> CharRanking = co_await ServerInstance->GetDatabaseExecutor().Query([BoardId, PlayerId, CharacterId](ServerDatabase& Database) {
+        return Database.GetCharacterRanking(BoardId, PlayerId, CharacterId);
+    });
+
     Frpg2RequestMessage::RequestGetCharacterRankingDataResponse Response;
     Frpg2RequestMessage::RankingData& ResponseData = *Response.mutable_data();
 
-    std::shared_ptr<Ranking> CharRanking = Database.GetCharacterRanking(Request->board_id(), Player.GetPlayerId(), Request->character_id());
     if (CharRanking)
     {
-        ResponseData.set_player_id(Player.GetPlayerId());
-        ResponseData.set_character_id(Request->character_id());
+        ResponseData.set_player_id(PlayerId);
+        ResponseData.set_character_id(CharacterId);
         ResponseData.set_serial_rank(CharRanking->SerialRank);
         ResponseData.set_rank(CharRanking->Rank);
         ResponseData.set_score(CharRanking->Score);
@@ -126,41 +136,41 @@ MessageHandleResult RankingManager::Handle_RequestGetCharacterRankingData(GameCl
     }
     else
     {
-        ResponseData.set_player_id(Player.GetPlayerId());
-        ResponseData.set_character_id(Request->character_id());
+        ResponseData.set_player_id(PlayerId);
+        ResponseData.set_character_id(CharacterId);
         ResponseData.set_serial_rank(0);
         ResponseData.set_rank(0);
         ResponseData.set_score(0);
         ResponseData.set_data("");
     }
 
-    if (!Client->MessageStream->Send(&Response, &Message))
+    if (!Client->SendDeferredResponse(&Response, Message))
     {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestGetCharacterRankingDataResponse response.");
-        return MessageHandleResult::Error;
+        co_return MessageHandleResult::Error;
     }
 
-    return MessageHandleResult::Handled;
+    co_return MessageHandleResult::Handled;
 }
 
-MessageHandleResult RankingManager::Handle_RequestCountRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+Task<MessageHandleResult> RankingManager::Handle_RequestCountRankingData(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
-
     Frpg2RequestMessage::RequestCountRankingData* Request = (Frpg2RequestMessage::RequestCountRankingData*)Message.Protobuf.get();
 
-    uint32_t RankingCount = Database.GetRankingCount(Request->board_id());
+    uint32_t BoardId = Request->board_id();
+
+    uint32_t RankingCount = co_await ServerInstance->GetDatabaseExecutor().Query([BoardId](ServerDatabase& Database) {
+        return Database.GetRankingCount(BoardId);
+    });
 
     Frpg2RequestMessage::RequestCountRankingDataResponse Response;
     Response.set_count(RankingCount);
 
-    if (!Client->MessageStream->Send(&Response, &Message))
+    if (!Client->SendDeferredResponse(&Response, Message))
     {
-        WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestCountRankingDataResponse response.");
-        return MessageHandleResult::Error;
+        co_return MessageHandleResult::Error;
     }
 
-    return MessageHandleResult::Handled;
+    co_return MessageHandleResult::Handled;
 }
 
 std::string RankingManager::GetName()
@@ -11,6 +11,10 @@
 
 #include "Server/GameService/GameManager.h"
 
+#include "Core/Utils/Task.h"
+
+#include <memory>
+
 struct Frpg2ReliableUdpMessage;
 class Server;
 
@@ -23,15 +27,15 @@ class RankingManager
 public:    
     RankingManager(Server* InServerInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
 protected:
-    MessageHandleResult Handle_RequestRegisterRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
-    MessageHandleResult Handle_RequestGetRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
-    MessageHandleResult Handle_RequestGetCharacterRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
-    MessageHandleResult Handle_RequestCountRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
+    Task<MessageHandleResult> Handle_RequestRegisterRankingData(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message);
+    Task<MessageHandleResult> Handle_RequestGetRankingData(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message);
+    Task<MessageHandleResult> Handle_RequestGetCharacterRankingData(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message);
+    Task<MessageHandleResult> Handle_RequestCountRankingData(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message);
 
 private:
     Server* ServerInstance;
@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/Signs/SignManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -25,6 +26,11 @@ SignManager::SignManager(Server* InServerInstance, GameService* InGameServiceIns
     , GameServiceInstance(InGameServiceInstance)
 {
     LiveCache.SetMaxEntriesPerArea(InServerInstance->GetConfig().SummonSignMaxEntriesPerArea);
+
+    // Signs pushed out of the live cache by newer ones shouldn't be found by searches either.
+    LiveCache.SetTrimCallback([this](const std::shared_ptr<SummonSign>& Sign) {
+        SignsByArea.Remove(Sign);
+    });
 }
 
 void SignManager::OnLostPlayer(GameClient* Client)
@@ -40,24 +46,28 @@ void SignManager::OnLostPlayer(GameClient* Client)
 void SignManager::RemoveSignAndNotifyAware(const std::shared_ptr<SummonSign>& Sign)
 {
     LiveCache.Remove((OnlineAreaId)Sign->OnlineAreaId, Sign->SignId);
+    SignsByArea.Remove(Sign);
 
     // Tell anyone who is aware of this sign that its been removed.
+    std::vector<std::shared_ptr<GameClient>> AwareClients;
     for (uint32_t AwarePlayerId : Sign->AwarePlayerIds)
     {
         if (std::shared_ptr<GameClient> OtherClient = GameServiceInstance->FindClientByPlayerId(AwarePlayerId))
         {
-            Frpg2RequestMessage::PushRequestRemoveSign PushMessage;
-            PushMessage.set_push_message_id(Frpg2RequestMessage::PushID_PushRequestRemoveSign);
-            PushMessage.mutable_message()->set_player_id(Sign->PlayerId);
-            PushMessage.mutable_message()->set_sign_id(Sign->SignId);
-
-            if (!OtherClient->MessageStream->Send(&PushMessage))
-            {
-                WarningS(OtherClient->GetName().c_str(), "Failed to send PushRequestRemoveSign to aware player.");
-            }
+            AwareClients.push_back(OtherClient);
         }
     }
 
+    Frpg2RequestMessage::PushRequestRemoveSign PushMessage;
+    PushMessage.set_push_message_id(Frpg2RequestMessage::PushID_PushRequestRemoveSign);
+    PushMessage.mutable_message()->set_player_id(Sign->PlayerId);
+    PushMessage.mutable_message()->set_sign_id(Sign->SignId);
+
+    if (!GameServiceInstance->BroadcastPushMessage(&PushMessage, AwareClients))
+    {
+        Warning("Failed to send PushRequestRemoveSign to aware players.");
+    }
+
     Sign->BeingSummonedByPlayerId = 0;
     Sign->AwarePlayerIds.clear();
 }
@@ -66,82 +76,58 @@ void SignManager::Poll()
 {
 }
 
-MessageHandleResult SignManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void SignManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetSignList)
-    {
-        return Handle_RequestGetSignList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateSign)
-    {
-        return Handle_RequestCreateSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRemoveSign)
-    {
-        return Handle_RequestRemoveSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdateSign)
-    {
-        return Handle_RequestUpdateSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSummonSign)
-    {
-        return Handle_RequestSummonSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRejectSign)
-    {
-        return Handle_RequestRejectSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetRightMatchingArea)
-    {
-        return Handle_RequestGetRightMatchingArea(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetSignList, this, &SignManager::Handle_RequestGetSignList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateSign, this, &SignManager::Handle_RequestCreateSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRemoveSign, this, &SignManager::Handle_RequestRemoveSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdateSign, this, &SignManager::Handle_RequestUpdateSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSummonSign, this, &SignManager::Handle_RequestSummonSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRejectSign, this, &SignManager::Handle_RequestRejectSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetRightMatchingArea, this, &SignManager::Handle_RequestGetRightMatchingArea);
 }
 
-bool SignManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Host, const Frpg2RequestMessage::MatchingParameter& Match, bool IsRedSign)
+bool SignManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Host, const std::shared_ptr<SummonSign>& Sign)
 {
     const RuntimeConfig& Config = ServerInstance->GetConfig();
 
     // Sign globally disabled?
-    bool IsDisabled = IsRedSign ? Config.DisableInvasions : Config.DisableCoop;
+    bool IsDisabled = Sign->IsRedSign ? Config.DisableInvasions : Config.DisableCoop;
     if (IsDisabled)
     {
         return false;
     }
 
     // If password missmatch then no match.
-    if (Host.password() != Match.password())
+    if (Host.password() != Sign->MatchingParameters.password())
     {
         return false;
     }
 
-    // Check matching parameters.
-    if (!ServerInstance->GetConfig().SummonSignMatchingParameters.CheckMatch(
-            Host.soul_level(), Host.weapon_level(), 
-            Match.soul_level(), Match.weapon_level(), 
-            Host.password().size() > 0
-        ))
-    {
-        return false;
-    }
+    // Levels have already been checked against SummonSignMatchingParameters by the index.
 
     return true;
 }
 
 MessageHandleResult SignManager::Handle_RequestGetSignList(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
+    const RuntimeConfig& Config = ServerInstance->GetConfig();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestGetSignList* Request = (Frpg2RequestMessage::RequestGetSignList*)Message.Protobuf.get();
     Frpg2RequestMessage::RequestGetSignListResponse Response;
 
+    MatchmakingQuery Query;
+    Query.Parameters = &Config.SummonSignMatchingParameters;
+    Query.SoulLevel = Request->matching_parameter().soul_level();
+    Query.WeaponLevel = Request->matching_parameter().weapon_level();
+    Query.HasPassword = Request->matching_parameter().password().size() > 0;
+
     uint32_t RemainingSignCount = Request->max_signs();
 
     Frpg2RequestMessage::GetSignResult* SignResult = Response.mutable_get_sign_result();
 
-    // Grab as many recent signs as we can from the cache that match our matching criteria.
+    // Grab as many signs as we can that match our matching criteria, closest in level first.
     for (int i = 0; i < Request->search_areas_size() && RemainingSignCount > 0; i++)
     {
         const Frpg2RequestMessage::SignDomainGetInfo& Area = Request->search_areas(i);
@@ -157,18 +143,18 @@ MessageHandleResult SignManager::Handle_RequestGetSignList(GameClient* Client, c
         uint32_t MaxForArea = Area.max_signs();
         uint32_t GatherCount = std::min(MaxForArea, RemainingSignCount);
 
-        std::vector<std::shared_ptr<SummonSign>> AreaSigns = LiveCache.GetRecentSet(AreaId, GatherCount, [this, &Player, &Request](const std::shared_ptr<SummonSign>& Sign) { 
-            return CanMatchWith(Request->matching_parameter(), Sign->MatchingParameters, Sign->IsRedSign);
-        });
-
-        for (std::shared_ptr<SummonSign>& Sign : AreaSigns)
-        {
+        std::vector<std::shared_ptr<SummonSign>> AreaSigns = SignsByArea.FindBest(AreaId, Query, GatherCount, [this, &Player, &Request](const std::shared_ptr<SummonSign>& Sign) { 
             // Filter players own signs.
             if (Sign->PlayerId == Player.GetPlayerId())
             {
-                continue;
+                return false;
             }
 
+            return CanMatchWith(Request->matching_parameter(), Sign);
+        });
+
+        for (std::shared_ptr<SummonSign>& Sign : AreaSigns)
+        {
             // If client already has sign data we only need to return a limited set of data.
             if (ClientExistingSignId.count(Sign->SignId) > 0)
             {
@@ -206,7 +192,6 @@ MessageHandleResult SignManager::Handle_RequestGetSignList(GameClient* Client, c
 
 MessageHandleResult SignManager::Handle_RequestCreateSign(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestCreateSign* Request = (Frpg2RequestMessage::RequestCreateSign*)Message.Protobuf.get();
@@ -220,6 +205,8 @@ MessageHandleResult SignManager::Handle_RequestCreateSign(GameClient* Client, co
     Sign->PlayerStruct.assign(Request->player_struct().data(), Request->player_struct().data() + Request->player_struct().size());
     Sign->MatchingParameters = Request->matching_parameter();
 
+    // Indexed first, so if adding it to the live cache trims it straight back out it's unindexed as well.
+    SignsByArea.Update(Sign, Sign->OnlineAreaId, Sign->MatchingParameters.soul_level(), Sign->MatchingParameters.weapon_level());
     LiveCache.Add(Sign->OnlineAreaId, Sign->SignId, Sign);
     Client->ActiveSummonSigns.push_back(Sign);
 
@@ -227,8 +214,7 @@ MessageHandleResult SignManager::Handle_RequestCreateSign(GameClient* Client, co
     Response.set_sign_id(Sign->SignId);
 
     std::string TypeStatisticKey = StringFormat("Sign/TotalCreated");
-    Database.AddGlobalStatistic(TypeStatisticKey, 1);
-    Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+    ServerInstance->GetDatabaseExecutor().AddStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
 
     if (!Client->MessageStream->Send(&Response, &Message))
     {
@@ -296,7 +282,6 @@ MessageHandleResult SignManager::Handle_RequestUpdateSign(GameClient* Client, co
 
 MessageHandleResult SignManager::Handle_RequestSummonSign(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestSummonSign* Request = (Frpg2RequestMessage::RequestSummonSign*)Message.Protobuf.get();
@@ -369,12 +354,10 @@ MessageHandleResult SignManager::Handle_RequestSummonSign(GameClient* Client, co
     else
     {
         std::string PoolStatisticKey = StringFormat("Sign/TotalSummonsRequested/IsRedSign=%u", (uint32_t)Sign->IsRedSign);
-        Database.AddGlobalStatistic(PoolStatisticKey, 1);
-        Database.AddPlayerStatistic(PoolStatisticKey, Player.GetPlayerId(), 1);
+        ServerInstance->GetDatabaseExecutor().AddStatistic(PoolStatisticKey, Player.GetPlayerId(), 1);
 
         std::string TypeStatisticKey = StringFormat("Sign/TotalSummonsRequested");
-        Database.AddGlobalStatistic(TypeStatisticKey, 1);
-        Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+        ServerInstance->GetDatabaseExecutor().AddStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
     }
 
     return MessageHandleResult::Handled;
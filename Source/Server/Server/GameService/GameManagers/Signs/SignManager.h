@@ -11,6 +11,7 @@
 
 #include "Server/GameService/GameManager.h"
 #include "Server/GameService/Utils/OnlineAreaPool.h"
+#include "Server/GameService/Utils/MatchmakingIndex.h"
 #include "Server/Database/DatabaseTypes.h"
 
 struct Frpg2ReliableUdpMessage;
@@ -26,7 +27,7 @@ class SignManager
 public:    
     SignManager(Server* InServerInstance, GameService* InGameServiceInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
     virtual void Poll() override;
@@ -36,7 +37,7 @@ public:
     size_t GetLiveCount() { return LiveCache.GetTotalEntries(); }
 
 protected:
-    bool CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Client, const Frpg2RequestMessage::MatchingParameter& Match, bool IsRedSign);
+    bool CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Client, const std::shared_ptr<SummonSign>& Sign);
 
     void RemoveSignAndNotifyAware(const std::shared_ptr<SummonSign>& Sign);
 
@@ -54,6 +55,10 @@ private:
 
     OnlineAreaPool<SummonSign> LiveCache;
 
+    // Signs in each area bucketed by the level they were placed at, so requests
+    // only have to look at signs they are in range of.
+    MatchmakingIndex<OnlineAreaId, std::shared_ptr<SummonSign>> SignsByArea;
+
     uint32_t NextSignId = 1000;
 
 };
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include "Server/GameService/GameManagers/Visitor/VisitorManager.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -25,33 +26,22 @@ VisitorManager::VisitorManager(Server* InServerInstance, GameService* InGameServ
 {
 }
 
-MessageHandleResult VisitorManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void VisitorManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetVisitorList)
-    {
-        return Handle_RequestGetVisitorList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestVisit)
-    {
-        return Handle_RequestVisit(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRejectVisit)
-    {
-        return Handle_RequestRejectVisit(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetVisitorList, this, &VisitorManager::Handle_RequestGetVisitorList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestVisit, this, &VisitorManager::Handle_RequestVisit);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRejectVisit, this, &VisitorManager::Handle_RequestRejectVisit);
 }
 
-bool VisitorManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Request, const std::shared_ptr<GameClient>& Match)
+bool VisitorManager::GetMatchingQuery(Frpg2RequestMessage::VisitorPool Pool, const Frpg2RequestMessage::MatchingParameter& Request, MatchmakingQuery& Query)
 {
     const RuntimeConfig& Config = ServerInstance->GetConfig();
-    bool IsInvasion = (Match->GetPlayerState().GetVisitorPool() != Frpg2RequestMessage::VisitorPool::VisitorPool_Way_of_Blue);
+    bool IsInvasion = (Pool != Frpg2RequestMessage::VisitorPool::VisitorPool_Way_of_Blue);
 
-    const RuntimeConfigMatchingParameters* MatchingParams = &Config.CovenantInvasionMatchingParameters;
+    Query.Parameters = &Config.CovenantInvasionMatchingParameters;
     if (!IsInvasion)
     {
-        MatchingParams = &Config.WayOfBlueMatchingParameters;
+        Query.Parameters = &Config.WayOfBlueMatchingParameters;
     }
 
     // Matching globally disabled?
@@ -61,15 +51,9 @@ bool VisitorManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter&
         return false;
     }
 
-    // Check matching parameters.
-    if (!MatchingParams->CheckMatch(
-            Request.soul_level(), Request.weapon_level(),
-            Match->GetPlayerState().GetSoulLevel(), Match->GetPlayerState().GetMaxWeaponLevel(),
-            Request.password().size() > 0
-        ))
-    {
-        return false;
-    }
+    Query.SoulLevel = Request.soul_level();
+    Query.WeaponLevel = Request.weapon_level();
+    Query.HasPassword = Request.password().size() > 0;
 
     return true;
 }
@@ -78,26 +62,21 @@ MessageHandleResult VisitorManager::Handle_RequestGetVisitorList(GameClient* Cli
 {
     Frpg2RequestMessage::RequestGetVisitorList* Request = (Frpg2RequestMessage::RequestGetVisitorList*)Message.Protobuf.get();
     
-    std::vector<std::shared_ptr<GameClient>> PotentialTargets = GameServiceInstance->FindClients([this, Client, Request](const std::shared_ptr<GameClient>& OtherClient) {
-        if (Client == OtherClient.get())
-        {
-            return false;
-        }
-        if (Request->visitor_pool() != OtherClient->GetPlayerState().GetVisitorPool())
-        {
-            return false;
-        }
-        return CanMatchWith(Request->matching_parameter(), OtherClient); 
-    });
-
-    // TODO: Sort potential targets based on prioritization (more summons etc)
+    // Best matches in the requested pool first.
+    std::vector<std::shared_ptr<GameClient>> PotentialTargets;
+    MatchmakingQuery Query;
+    if (GetMatchingQuery(Request->visitor_pool(), Request->matching_parameter(), Query))
+    {
+        PotentialTargets = GameServiceInstance->FindClientsInVisitorPool(Request->visitor_pool(), Query, Request->max_visitors(), [Client](const std::shared_ptr<GameClient>& OtherClient) {
+            return Client != OtherClient.get();
+        });
+    }
 
     Frpg2RequestMessage::RequestGetVisitorListResponse Response;
     Response.set_map_id(Request->map_id());
     Response.set_online_area_id(Request->online_area_id());
 
-    int CountToSend = std::min((int)Request->max_visitors(), (int)PotentialTargets.size());
-    for (int i = 0; i < CountToSend; i++)
+    for (size_t i = 0; i < PotentialTargets.size(); i++)
     {
         std::shared_ptr<GameClient> OtherClient = PotentialTargets[i];
 
@@ -117,7 +96,6 @@ MessageHandleResult VisitorManager::Handle_RequestGetVisitorList(GameClient* Cli
 
 MessageHandleResult VisitorManager::Handle_RequestVisit(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
 {
-    ServerDatabase& Database = ServerInstance->GetDatabase();
     PlayerState& Player = Client->GetPlayerState();
 
     Frpg2RequestMessage::RequestVisit* Request = (Frpg2RequestMessage::RequestVisit*)Message.Protobuf.get();
@@ -199,12 +177,10 @@ MessageHandleResult VisitorManager::Handle_RequestVisit(GameClient* Client, cons
         }
 
         std::string PoolStatisticKey = StringFormat("Visitor/TotalVisitsRequested/Pool=%u", (uint32_t)Request->visitor_pool());
-        Database.AddGlobalStatistic(PoolStatisticKey, 1);
-        Database.AddPlayerStatistic(PoolStatisticKey, Player.GetPlayerId(), 1);
+        ServerInstance->GetDatabaseExecutor().AddStatistic(PoolStatisticKey, Player.GetPlayerId(), 1);
 
         std::string TypeStatisticKey = StringFormat("Visitor/TotalVisitsRequested");
-        Database.AddGlobalStatistic(TypeStatisticKey, 1);
-        Database.AddPlayerStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
+        ServerInstance->GetDatabaseExecutor().AddStatistic(TypeStatisticKey, Player.GetPlayerId(), 1);
     }
 
     return MessageHandleResult::Handled;
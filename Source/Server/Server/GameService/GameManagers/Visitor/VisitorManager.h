@@ -17,6 +17,7 @@
 struct Frpg2ReliableUdpMessage;
 class Server;
 class GameService;
+struct MatchmakingQuery;
 
 // Handles client requests for visitation (joining other users games via covenants - blue sentinels etc)
 
@@ -26,12 +27,13 @@ class VisitorManager
 public:    
     VisitorManager(Server* InServerInstance, GameService* InGameServiceInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
 protected:
-    bool CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Client, const std::shared_ptr<GameClient>& Match);
+    // Fills in the query used to find visitors in the pool for the given parameters. Returns false if matching for the pool is disabled.
+    bool GetMatchingQuery(Frpg2RequestMessage::VisitorPool Pool, const Frpg2RequestMessage::MatchingParameter& Request, MatchmakingQuery& Query);
 
     MessageHandleResult Handle_RequestGetVisitorList(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
     MessageHandleResult Handle_RequestVisit(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
@@ -0,0 +1,93 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Server/GameService/GameMessageDispatcher.h"
+#include "Server/GameService/GameClient.h"
+
+#include "Core/Utils/Logging.h"
+
+bool GameMessageDispatcher::Register(Frpg2ReliableUdpMessageType Type, const std::string& OwnerName, HandlerFunction Handler)
+{
+    Frpg2ReliableUdpMessageTypeIndex Index;
+    if (!ReliableUdpMessageType_To_Index(Type, Index))
+    {
+        Error("Game manager '%s' attempted to register handler for unknown message type 0x%04x.", OwnerName.c_str(), (uint32_t)Type);
+        return false;
+    }
+
+    HandlerEntry& Entry = Handlers[(size_t)Index];
+    if (Entry.Handler)
+    {
+        Error("Game manager '%s' attempted to register handler for message type '%s', but it is already handled by '%s'.", OwnerName.c_str(), ReliableUdpMessageTypeIndex_To_String(Index), Entry.OwnerName.c_str());
+        return false;
+    }
+
+    Entry.Handler = Handler;
+    Entry.OwnerName = OwnerName;
+
+    return true;
+}
+
+MessageHandleResult GameMessageDispatcher::Dispatch(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+{
+    Frpg2ReliableUdpMessageTypeIndex Index;
+    if (!ReliableUdpMessageType_To_Index(Message.Header.msg_type, Index))
+    {
+        return MessageHandleResult::Unhandled;
+    }
+
+    HandlerEntry& Entry = Handlers[(size_t)Index];
+    if (!Entry.Handler)
+    {
+        return MessageHandleResult::Unhandled;
+    }
+
+    Entry.HandledCount.fetch_add(1, std::memory_order_relaxed);
+
+    return Entry.Handler(Client, Message);
+}
+
+bool GameMessageDispatcher::IsRegistered(Frpg2ReliableUdpMessageTypeIndex Index)
+{
+    return (bool)Handlers[(size_t)Index].Handler;
+}
+
+uint64_t GameMessageDispatcher::GetHandledCount(Frpg2ReliableUdpMessageTypeIndex Index)
+{
+    return Handlers[(size_t)Index].HandledCount.load(std::memory_order_relaxed);
+}
+
+MessageHandleResult GameMessageDispatcher::StartTask(GameClient* Client, const Frpg2ReliableUdpMessage& Message, const TaskHandlerFunction& Handler)
+{
+    // The task gets the message as it was recieved. If it finishes without suspending its
+    // response still piggybacks the ack, SendDeferredResponse drops the ack if it doesn't.
+    Task<MessageHandleResult> HandlerTask = Handler(Client->shared_from_this(), Message);
+    if (HandlerTask.IsDone())
+    {
+        return HandlerTask.GetResult();
+    }
+
+    std::weak_ptr<GameClient> WeakClient = Client->shared_from_this();
+    HandlerTask.Then([WeakClient](const MessageHandleResult& Result) {
+        if (Result != MessageHandleResult::Error)
+        {
+            return;
+        }
+
+        // Failing because the client went away while the task was waiting isn't worth a warning.
+        std::shared_ptr<GameClient> Client = WeakClient.lock();
+        if (Client && Client->IsConnected())
+        {
+            WarningS(Client->GetName().c_str(), "Disconnecting client as failed to handle message.");
+            Client->DisconnectTime = GetSeconds();
+        }
+    });
+
+    return MessageHandleResult::Handled;
+}
@@ -0,0 +1,89 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include "Server/GameService/GameManager.h"
+#include "Server/Streams/Frpg2ReliableUdpMessage.h"
+
+#include "Core/Utils/Task.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+class GameClient;
+
+// Table of message handlers indexed by message type. Game managers register
+// the handlers for the messages they are interested in during initialization,
+// after which routing a message to its handler is a single indexed call.
+
+class GameMessageDispatcher
+{
+public:
+    using HandlerFunction = std::function<MessageHandleResult(GameClient* Client, const Frpg2ReliableUdpMessage& Message)>;
+    using TaskHandlerFunction = std::function<Task<MessageHandleResult>(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message)>;
+
+    // Registers a handler for the given message type, only one handler may be 
+    // registered per message type.
+    bool Register(Frpg2ReliableUdpMessageType Type, const std::string& OwnerName, HandlerFunction Handler);
+
+    // Convenience function for registering a member function of a game manager.
+    template <typename ManagerType>
+    bool Register(Frpg2ReliableUdpMessageType Type, ManagerType* Manager, MessageHandleResult (ManagerType::*Handler)(GameClient* Client, const Frpg2ReliableUdpMessage& Message))
+    {
+        return Register(Type, Manager->GetName(), [Manager, Handler](GameClient* Client, const Frpg2ReliableUdpMessage& Message) {
+            return (Manager->*Handler)(Client, Message);
+        });
+    }
+
+    // Registers a member function that runs as a Task, for handlers that need to co_await
+    // database queries or timers. As the handler may still be running after Dispatch
+    // returns it's given its own reference to the client and copy of the message. It should
+    // respond with GameClient::SendDeferredResponse, which works whether or not it suspended.
+    template <typename ManagerType>
+    bool Register(Frpg2ReliableUdpMessageType Type, ManagerType* Manager, Task<MessageHandleResult> (ManagerType::*Handler)(std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message))
+    {
+        TaskHandlerFunction TaskHandler = [Manager, Handler](std::shared_ptr<GameClient> Client, Frpg2ReliableUdpMessage Message) {
+            return (Manager->*Handler)(std::move(Client), std::move(Message));
+        };
+
+        return Register(Type, Manager->GetName(), [TaskHandler](GameClient* Client, const Frpg2ReliableUdpMessage& Message) {
+            return StartTask(Client, Message, TaskHandler);
+        });
+    }
+
+    // Routes the message to its registered handler, returns Unhandled if 
+    // nothing is registered for the message type.
+    MessageHandleResult Dispatch(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
+
+    bool IsRegistered(Frpg2ReliableUdpMessageTypeIndex Index);
+
+    // Gets the number of messages of the given type that have been routed to a handler.
+    // Safe to call from other threads.
+    uint64_t GetHandledCount(Frpg2ReliableUdpMessageTypeIndex Index);
+
+private:
+    // Starts a task handler. If it finishes straight away its result is returned as
+    // normal, otherwise the message is treated as handled and the client is
+    // disconnected if the task eventually fails.
+    static MessageHandleResult StartTask(GameClient* Client, const Frpg2ReliableUdpMessage& Message, const TaskHandlerFunction& Handler);
+
+    struct HandlerEntry
+    {
+        HandlerFunction Handler;
+        std::string OwnerName;
+        std::atomic<uint64_t> HandledCount = 0;
+    };
+
+    std::array<HandlerEntry, (size_t)Frpg2ReliableUdpMessageTypeIndex::Count> Handlers;
+
+};
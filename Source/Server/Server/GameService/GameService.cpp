@@ -38,9 +38,15 @@
 
 #include "Server/GameService/Utils/GameIds.h"
 
+#include <algorithm>
+
+#include <steam/steam_api.h>
+#include <steam/steam_gameserver.h>
+
 GameService::GameService(Server* OwningServer, RSAKeyPair* InServerRSAKey)
     : ServerInstance(OwningServer)
     , ServerRSAKey(InServerRSAKey)
+    , NetworkWorkers(BuildConfig::NETWORK_WORKER_COUNT)
 {
     // This list of managers are what actually do the grunt work of the server
     // they recieve and response to messages.
@@ -82,6 +88,8 @@ bool GameService::Init()
             Error("Failed to initialize game manager '%s'", Manager->GetName().c_str());
             return false;
         }
+
+        Manager->RegisterMessageHandlers(MessageDispatcher);
     }
 
     TrimDatabase();
@@ -105,14 +113,31 @@ bool GameService::Term()
 
 void GameService::TrimDatabase()
 {
-    Log("Trimming database entries.");
-
-    for (auto& Manager : Managers)
+    if (DatabaseTrimQueued)
     {
-        Manager->TrimDatabase();
+        return;
     }
 
-    GetServer()->GetDatabase().Trim();
+    Log("Trimming database entries.");
+
+    // Managers only touch the database when trimming, so this is safe to do on the database thread.
+    DatabaseTrimQueued = true;
+    GetServer()->GetDatabaseExecutor().Run(
+        [this](ServerDatabase& Database) {
+            DebugTimerScope Scope(Debug::Maintenance_TrimDatabaseTime);
+
+            for (auto& Manager : Managers)
+            {
+                Manager->TrimDatabase();
+            }
+
+            Database.Trim();
+            return true;
+        },
+        [this](bool) {
+            DatabaseTrimQueued = false;
+        }
+    );
 
     NextDatabaseTrim = GetSeconds() + GetServer()->GetConfig().DatabaseTrimInterval;
 }
@@ -128,6 +153,8 @@ void GameService::Poll()
         Manager->Poll();
     }
 
+    AcceptPendingAuthTokens();
+
     while (std::shared_ptr<NetConnection> ClientConnection = Connection->Accept())
     {
         HandleClientConnection(ClientConnection);
@@ -138,10 +165,11 @@ void GameService::Poll()
         TrimDatabase();
     }
 
-    for (auto iter = Clients.begin(); iter != Clients.end(); /* empty */)
-    {
-        std::shared_ptr<GameClient> Client = *iter;
+    ScheduleClients();
+    PumpClientNetworks();
 
+    for (std::shared_ptr<GameClient>& Client : ActiveClients)
+    {
         if (Client->Poll())
         {
             LogS(Client->GetName().c_str(), "Disconnecting client connection.");
@@ -156,11 +184,10 @@ void GameService::Poll()
                 Manager->OnLostPlayer(Client.get());
             }
 
-            iter = Clients.erase(iter);
-        }
-        else
-        {
-            iter++;
+            RemoveClientIndexes(Client.get());
+            PollSchedule.Remove(Client.get());
+            ClientsByConnection.Remove(Client->Connection.get(), Client);
+            Clients.erase(std::find(Clients.begin(), Clients.end(), Client));
         }
     }
     
@@ -175,6 +202,9 @@ void GameService::Poll()
         {
             LogS(Client->GetName().c_str(), "Client disconnected.");
 
+            // Make sure anything it queued on the way out still gets sent.
+            Client->MessageStream->FlushBatch();
+
             iter = DisconnectingClients.erase(iter);
         }
         else
@@ -183,6 +213,19 @@ void GameService::Poll()
         }
     }
 
+    FlushBatchedSends();
+    RescheduleClients();
+
+    if (GetSeconds() > NextAuthTokenExpiry)
+    {
+        DebugTimerScope Scope(Debug::Maintenance_AuthTokenExpiryTime);
+        ExpireAuthTokens();
+        NextAuthTokenExpiry = GetSeconds() + BuildConfig::AUTH_TICKET_EXPIRY_INTERVAL;
+    }
+}
+
+void GameService::ExpireAuthTokens()
+{
     // Remove authentication states that have timed out.
     for (auto iter = AuthenticationStates.begin(); iter != AuthenticationStates.end(); /* empty */)
     {
@@ -201,6 +244,111 @@ void GameService::Poll()
     }
 }
 
+void GameService::ScheduleClients()
+{
+    // Anything the connection has routed datagrams to since last tick.
+    Connection->TakeReadyConnections(ReadyConnections);
+    for (std::shared_ptr<NetConnection>& ReadyConnection : ReadyConnections)
+    {
+        if (std::shared_ptr<GameClient> Client = ClientsByConnection.Find(ReadyConnection.get()))
+        {
+            PollSchedule.MarkReady(Client.get());
+        }
+    }
+
+    PollSchedule.BeginTick(GetSeconds(), ActiveClients);
+}
+
+void GameService::RescheduleClients()
+{
+    for (std::shared_ptr<GameClient>& Client : ActiveClients)
+    {
+        if (!Client->IsDisconnecting)
+        {
+            PollSchedule.EndPoll(Client.get(), Client->HasPendingWork(), Client->GetNextPollTime());
+        }
+    }
+}
+
+void GameService::MarkClientReady(GameClient* Client)
+{
+    PollSchedule.MarkReady(Client);
+}
+
+void GameService::PumpClientNetworks()
+{
+    DebugTimerScope Scope(Debug::GameService_RecieveTime);
+
+    // Each client is pumped entirely by one worker. This only touches the clients 
+    // own connection and streams, anything involving other clients or the managers 
+    // happens when the messages are handled in GameClient::Poll.
+    //
+    // Clients aren't sharded by online area. A players area changes with every status
+    // update, and most handlers reach into other areas or other clients directly
+    // (FindClientByPlayerId for summons, break-ins, visitors and quick matches,
+    // FindClientsInArea for bells), so shards would have to hand off almost every request.
+    if (ActiveClients.size() >= BuildConfig::MIN_CLIENTS_FOR_PARALLEL_RECIEVE)
+    {
+        NetworkWorkers.ParallelFor(ActiveClients.size(), [this](size_t Index) {
+            ActiveClients[Index]->PumpNetwork();
+        });
+    }
+    else
+    {
+        for (auto& Client : ActiveClients)
+        {
+            Client->PumpNetwork();
+        }
+    }
+}
+
+void GameService::FlushBatchedSends()
+{
+    DebugTimerScope Scope(Debug::GameService_SendTime);
+
+    // Only clients polled this tick, or that have been marked ready by something being
+    // sent to them, can have anything queued. These lists never overlap as clients 
+    // being polled can't be marked ready, and disconnecting clients are unscheduled.
+    BatchedStreams.clear();
+    for (auto& Client : ActiveClients)
+    {
+        if (!Client->IsDisconnecting && Client->MessageStream->HasBatchedSends())
+        {
+            BatchedStreams.push_back(Client->MessageStream.get());
+        }
+    }
+    for (GameClient* Client : PollSchedule.GetReadyClients())
+    {
+        if (Client->MessageStream->HasBatchedSends())
+        {
+            BatchedStreams.push_back(Client->MessageStream.get());
+        }
+    }
+    for (auto& Client : DisconnectingClients)
+    {
+        if (Client->MessageStream->HasBatchedSends())
+        {
+            BatchedStreams.push_back(Client->MessageStream.get());
+        }
+    }
+
+    // Each stream is encrypted entirely by one worker, its cipher state is never
+    // shared between threads and its packets keep their order.
+    if (BatchedStreams.size() >= BuildConfig::MIN_STREAMS_FOR_PARALLEL_ENCRYPTION)
+    {
+        NetworkWorkers.ParallelFor(BatchedStreams.size(), [this](size_t Index) {
+            BatchedStreams[Index]->EncryptBatch();
+        });
+    }
+
+    // Connections are only ever sent on from this thread, the queue to the
+    // socket io thread only supports a single producer.
+    for (Frpg2UdpPacketStream* Stream : BatchedStreams)
+    {
+        Stream->FlushBatch();
+    }
+}
+
 void GameService::HandleClientConnection(std::shared_ptr<NetConnection> ClientConnection)
 {
     uint64_t AuthToken;
@@ -232,6 +380,8 @@ void GameService::HandleClientConnection(std::shared_ptr<NetConnection> ClientCo
 
     std::shared_ptr<GameClient> Client = std::make_shared<GameClient>(this, ClientConnection, AuthState.CwcKey, AuthState.AuthToken);
     Clients.push_back(Client);
+    ClientsByConnection.Add(ClientConnection.get(), Client);
+    PollSchedule.Add(Client);
 
     // Let all managers know this client connected.
     for (auto& Manager : Managers)
@@ -253,7 +403,46 @@ void GameService::CreateAuthToken(uint64_t AuthToken, const std::vector<uint8_t>
     AuthState.AuthToken = AuthToken;
     AuthState.CwcKey = CwcKey;
     AuthState.LastRefreshTime = GetSeconds();
-    AuthenticationStates.insert({ AuthToken, AuthState });
+
+    std::scoped_lock Lock(PendingAuthenticationStatesMutex);
+    PendingAuthenticationStates.push_back(std::move(AuthState));
+}
+
+void GameService::QueueSteamTicketCheck(std::shared_ptr<SteamTicketCheck> Check)
+{
+    std::scoped_lock Lock(PendingAuthenticationStatesMutex);
+    PendingSteamTicketChecks.push_back(std::move(Check));
+}
+
+void GameService::AcceptPendingAuthTokens()
+{
+    std::vector<GameClientAuthenticationState> Pending;
+    std::vector<std::shared_ptr<SteamTicketCheck>> TicketChecks;
+    {
+        std::scoped_lock Lock(PendingAuthenticationStatesMutex);
+        Pending.swap(PendingAuthenticationStates);
+        TicketChecks.swap(PendingSteamTicketChecks);
+    }
+
+    for (GameClientAuthenticationState& AuthState : Pending)
+    {
+        AuthenticationStates.insert({ AuthState.AuthToken, std::move(AuthState) });
+    }
+
+    // We only want to know the ticket is valid, so the session is ended straight away.
+    for (std::shared_ptr<SteamTicketCheck>& Check : TicketChecks)
+    {
+        uint64 SteamIdInt = 0;
+        sscanf(Check->SteamId.c_str(), "%016llx", &SteamIdInt);
+        CSteamID SteamIdStruct(SteamIdInt);
+
+        Check->Result = SteamGameServer()->BeginAuthSession(Check->Ticket.data(), (int)Check->Ticket.size(), SteamIdStruct);
+        if (Check->Result == k_EBeginAuthSessionResultOK)
+        {
+            SteamGameServer()->EndAuthSession(SteamIdStruct);
+        }
+        Check->Complete = true;
+    }
 }
 
 void GameService::RefreshAuthToken(uint64_t AuthToken)
@@ -269,33 +458,144 @@ void GameService::RefreshAuthToken(uint64_t AuthToken)
 
 std::shared_ptr<GameClient> GameService::FindClientByPlayerId(uint32_t PlayerId)
 {
-    for (std::shared_ptr<GameClient>& Client : Clients)
+    return ClientsByPlayerId.Find(PlayerId);
+}
+
+std::shared_ptr<GameClient> GameService::FindClientBySteamId(const std::string& SteamId)
+{
+    return ClientsBySteamId.Find(SteamId);
+}
+
+namespace
+{
+    // Moves a client to a new key in an index. Clients aren't registered under the none key.
+    template <typename KeyType>
+    void Reindex(ClientIndex<KeyType, std::shared_ptr<GameClient>>& Index, KeyType& IndexedKey, const KeyType& NewKey, const KeyType& NoneKey, const std::shared_ptr<GameClient>& Client)
     {
-        if (Client->GetPlayerState().GetPlayerId() == PlayerId)
+        if (NewKey == IndexedKey)
         {
-            return Client;
+            return;
         }
+        if (IndexedKey != NoneKey)
+        {
+            Index.Remove(IndexedKey, Client);
+        }
+        if (NewKey != NoneKey)
+        {
+            Index.Add(NewKey, Client);
+        }
+        IndexedKey = NewKey;
+    }
+};
+
+void GameService::UpdateClientIndexes(GameClient* Client)
+{
+    // Deferred logins can complete after the client has started disconnecting, don't
+    // let them put it back in the indexes.
+    if (Client->IsDisconnecting)
+    {
+        return;
+    }
+
+    std::shared_ptr<GameClient> SharedClient = Client->shared_from_this();
+    const PlayerState& State = Client->GetPlayerState();
+
+    Reindex(ClientsByPlayerId, Client->IndexedPlayerId, State.GetPlayerId(), 0u, SharedClient);
+    Reindex(ClientsBySteamId, Client->IndexedSteamId, State.GetSteamId(), std::string(), SharedClient);
+    Reindex(ClientsByArea, Client->IndexedArea, State.GetCurrentArea(), OnlineAreaId::None, SharedClient);
+
+    if (State.GetIsInvadable() && State.GetCurrentArea() != OnlineAreaId::None)
+    {
+        InvadableClientsByArea.Update(SharedClient, State.GetCurrentArea(), State.GetSoulLevel(), State.GetMaxWeaponLevel());
+    }
+    else
+    {
+        InvadableClientsByArea.Remove(SharedClient);
+    }
+
+    if (State.GetVisitorPool() != Frpg2RequestMessage::VisitorPool::VisitorPool_None)
+    {
+        ClientsByVisitorPool.Update(SharedClient, State.GetVisitorPool(), State.GetSoulLevel(), State.GetMaxWeaponLevel());
+    }
+    else
+    {
+        ClientsByVisitorPool.Remove(SharedClient);
     }
-    return nullptr;
 }
 
-std::shared_ptr<GameClient> GameService::FindClientBySteamId(const std::string& SteamId)
+void GameService::RemoveClientIndexes(GameClient* Client)
+{
+    Client->IsDisconnecting = true;
+
+    std::shared_ptr<GameClient> SharedClient = Client->shared_from_this();
+
+    Reindex(ClientsByPlayerId, Client->IndexedPlayerId, 0u, 0u, SharedClient);
+    Reindex(ClientsBySteamId, Client->IndexedSteamId, std::string(), std::string(), SharedClient);
+    Reindex(ClientsByArea, Client->IndexedArea, OnlineAreaId::None, OnlineAreaId::None, SharedClient);
+    InvadableClientsByArea.Remove(SharedClient);
+    ClientsByVisitorPool.Remove(SharedClient);
+}
+
+bool GameService::BroadcastPushMessage(google::protobuf::MessageLite* Message, const std::vector<std::shared_ptr<GameClient>>& TargetClients)
 {
-    for (std::shared_ptr<GameClient>& Client : Clients)
+    if (TargetClients.empty())
+    {
+        return true;
+    }
+
+    Frpg2ReliableUdpFragment Prepared;
+    if (!Frpg2ReliableUdpMessageStream::PreparePush(Message, Prepared))
     {
-        if (Client->GetPlayerState().GetSteamId() == SteamId)
+        return false;
+    }
+
+    for (const std::shared_ptr<GameClient>& Client : TargetClients)
+    {
+        if (!Client->MessageStream->SendPreparedPush(Prepared))
         {
-            return Client;
+            WarningS(Client->GetName().c_str(), "Failed to send broadcast push message.");
         }
     }
-    return nullptr;
+
+    return true;
+}
+
+void GameService::BroadcastTextMessage(const std::string& TextMessage, const std::vector<std::shared_ptr<GameClient>>& TargetClients)
+{
+    Frpg2RequestMessage::ManagementTextMessage Message;
+    GameClient::BuildTextMessage(TextMessage, Message);
+
+    if (!BroadcastPushMessage(&Message, TargetClients))
+    {
+        Warning("Failed to broadcast game client text message.");
+    }
 }
 
 std::vector<std::shared_ptr<GameClient>> GameService::FindClients(std::function<bool(const std::shared_ptr<GameClient>&)> Predicate)
+{
+    return FilterClients(Clients, Predicate);
+}
+
+std::vector<std::shared_ptr<GameClient>> GameService::FindClientsInArea(OnlineAreaId AreaId, std::function<bool(const std::shared_ptr<GameClient>&)> Predicate)
+{
+    return FilterClients(ClientsByArea.FindAll(AreaId), Predicate);
+}
+
+std::vector<std::shared_ptr<GameClient>> GameService::FindInvadableClientsInArea(OnlineAreaId AreaId, const MatchmakingQuery& Query, size_t MaxResults, std::function<bool(const std::shared_ptr<GameClient>&)> Predicate)
+{
+    return InvadableClientsByArea.FindBest(AreaId, Query, MaxResults, Predicate);
+}
+
+std::vector<std::shared_ptr<GameClient>> GameService::FindClientsInVisitorPool(Frpg2RequestMessage::VisitorPool Pool, const MatchmakingQuery& Query, size_t MaxResults, std::function<bool(const std::shared_ptr<GameClient>&)> Predicate)
+{
+    return ClientsByVisitorPool.FindBest(Pool, Query, MaxResults, Predicate);
+}
+
+std::vector<std::shared_ptr<GameClient>> GameService::FilterClients(const std::vector<std::shared_ptr<GameClient>>& Candidates, const std::function<bool(const std::shared_ptr<GameClient>&)>& Predicate)
 {
     std::vector<std::shared_ptr<GameClient>> Result;
 
-    for (std::shared_ptr<GameClient>& Client : Clients)
+    for (const std::shared_ptr<GameClient>& Client : Candidates)
     {
         if (Predicate(Client))
         {
@@ -10,18 +10,28 @@
 #pragma once
 
 #include "Server/Service.h"
+#include "Server/GameService/GameMessageDispatcher.h"
+#include "Server/GameService/PlayerState.h"
+#include "Server/GameService/Utils/ClientIndex.h"
+#include "Server/GameService/Utils/ClientScheduler.h"
+#include "Server/GameService/Utils/MatchmakingIndex.h"
+
+#include "Core/Utils/WorkerGroup.h"
 
 #include <memory>
 #include <vector>
 #include <unordered_map>
 #include <functional>
 #include <mutex>
+#include <atomic>
+#include <string>
 
 class Server;
 class GameClient;
 class GameManager;
 class NetConnection;
 class NetConnectionUDP;
+class Frpg2UdpPacketStream;
 class RSAKeyPair;
 class Cipher;
 
@@ -36,6 +46,19 @@ struct GameClientAuthenticationState
     double LastRefreshTime;
 };
 
+// A steam ticket the auth service wants validated. The steam api isn't thread safe, so 
+// rather than calling it from the auth service's thread the check is queued with the 
+// game service and run on the main thread. Result is only valid once Complete is set.
+
+struct SteamTicketCheck
+{
+    std::string SteamId;
+    std::vector<uint8_t> Ticket;
+
+    std::atomic<bool> Complete = false;
+    int Result = 0;
+};
+
 // The game server is responsible for responding to any requests that game clients make. 
 // Its connected to after the user has visited the login server and the authentication server.
 
@@ -54,10 +77,17 @@ public:
 
     Server* GetServer() { return ServerInstance; }
 
+    // Called by the auth service once a client has authenticated. Safe to call from
+    // other threads, the token is picked up on the game service's next poll.
     void CreateAuthToken(uint64_t AuthToken, const std::vector<uint8_t>& CwcKey);
     void RefreshAuthToken(uint64_t AuthToken);
 
+    // Called by the auth service to validate a steam ticket. Safe to call from other
+    // threads, the check is run on the game service's next poll.
+    void QueueSteamTicketCheck(std::shared_ptr<SteamTicketCheck> Check);
+
     const std::vector<std::shared_ptr<GameManager>>& GetManagers() { return Managers; }
+    GameMessageDispatcher& GetMessageDispatcher() { return MessageDispatcher; }
 
     template <typename T>
     std::shared_ptr<T> GetManager()
@@ -78,16 +108,64 @@ public:
     // Be very careful using this, we manipulate steam-ids in debug to allow multiple 
     // instance of the same player to be active in the game. Use FindClientByPlayerId instead.
     std::shared_ptr<GameClient> FindClientBySteamId(const std::string& SteamId);
+
+    // Updates the lookups used by the FindClient(s)By* functions, should be called whenever
+    // a clients ids, online area, invadability or visitor pool changes.
+    void UpdateClientIndexes(GameClient* Client);
     
+    // Sends the same push message to all the given clients. The message is only serialized and
+    // compressed once, sequencing and encryption are the only parts done for each client.
+    // Returns false if the message could not be prepared, failures to individual clients are only logged.
+    bool BroadcastPushMessage(google::protobuf::MessageLite* Message, const std::vector<std::shared_ptr<GameClient>>& Clients);
+
+    // Sends a text message displayed at the top of the screen to all the given clients.
+    void BroadcastTextMessage(const std::string& Message, const std::vector<std::shared_ptr<GameClient>>& Clients);
+
     std::vector<std::shared_ptr<GameClient>> FindClients(std::function<bool(const std::shared_ptr<GameClient>&)> Predicate);
+
+    // Same as FindClients but only visits the clients in the given area, rather than everyone.
+    std::vector<std::shared_ptr<GameClient>> FindClientsInArea(OnlineAreaId AreaId, std::function<bool(const std::shared_ptr<GameClient>&)> Predicate);
+
+    // Finds up to MaxResults clients that can be invaded in the area, or that are in the visitor pool, that 
+    // pass the query's matching parameters. Closest soul levels come first, then whoever has waited longest.
+    std::vector<std::shared_ptr<GameClient>> FindInvadableClientsInArea(OnlineAreaId AreaId, const MatchmakingQuery& Query, size_t MaxResults, std::function<bool(const std::shared_ptr<GameClient>&)> Predicate);
+    std::vector<std::shared_ptr<GameClient>> FindClientsInVisitorPool(Frpg2RequestMessage::VisitorPool Pool, const MatchmakingQuery& Query, size_t MaxResults, std::function<bool(const std::shared_ptr<GameClient>&)> Predicate);
     std::vector<std::shared_ptr<GameClient>> GetClients() { return Clients; }
 
+    // Makes sure the client is polled next tick. Clients being polled this tick are left
+    // alone, which is what makes it safe for them to call this from the network workers.
+    void MarkClientReady(GameClient* Client);
+
 protected:
 
     void HandleClientConnection(std::shared_ptr<NetConnection> ClientConnection);
 
+    // Trims the database on a maintenance job, unless the last trim is still running.
     void TrimDatabase();
 
+    void RemoveClientIndexes(GameClient* Client);
+
+    std::vector<std::shared_ptr<GameClient>> FilterClients(const std::vector<std::shared_ptr<GameClient>>& Candidates, const std::function<bool(const std::shared_ptr<GameClient>&)>& Predicate);
+
+    void AcceptPendingAuthTokens();
+    void ExpireAuthTokens();
+
+    // Picks out the clients that have something to do this tick, everyone else
+    // is left alone until data arrives for them or a timer is due.
+    void ScheduleClients();
+
+    // Works out when each client polled this tick next needs polling.
+    void RescheduleClients();
+
+    // Recieves, decrypts and reassembles incoming packets for every active client,
+    // spread across the network workers. Messages are handled afterwards on this thread,
+    // the game simulation itself (clients polls and the managers) is not split up.
+    void PumpClientNetworks();
+
+    // Encrypts the packets every client queued this tick, spread across the 
+    // network workers, then hands them to the socket in order.
+    void FlushBatchedSends();
+
 private:
     Server* ServerInstance;
 
@@ -96,12 +174,38 @@ private:
     std::vector<std::shared_ptr<GameClient>> Clients;
     std::vector<std::shared_ptr<GameClient>> DisconnectingClients;
 
+    // Clients being polled this tick, rebuilt by ScheduleClients.
+    std::vector<std::shared_ptr<GameClient>> ActiveClients;
+    ClientScheduler<GameClient> PollSchedule;
+    ClientIndex<NetConnection*, std::shared_ptr<GameClient>> ClientsByConnection;
+    std::vector<std::shared_ptr<NetConnection>> ReadyConnections;
+
+    // Logged in clients indexed by their ids and matchmaking state, maintained by UpdateClientIndexes.
+    ClientIndex<uint32_t, std::shared_ptr<GameClient>> ClientsByPlayerId;
+    ClientIndex<std::string, std::shared_ptr<GameClient>> ClientsBySteamId;
+    ClientIndex<OnlineAreaId, std::shared_ptr<GameClient>> ClientsByArea;
+    MatchmakingIndex<OnlineAreaId, std::shared_ptr<GameClient>> InvadableClientsByArea;
+    MatchmakingIndex<Frpg2RequestMessage::VisitorPool, std::shared_ptr<GameClient>> ClientsByVisitorPool;
+
     std::vector<std::shared_ptr<GameManager>> Managers;
+    GameMessageDispatcher MessageDispatcher;
 
     std::unordered_map<uint64_t, GameClientAuthenticationState> AuthenticationStates;
 
+    // Auth states created, and steam tickets queued for checking, by the auth service 
+    // thread. Both are picked up at the start of each poll.
+    std::mutex PendingAuthenticationStatesMutex;
+    std::vector<GameClientAuthenticationState> PendingAuthenticationStates;
+    std::vector<std::shared_ptr<SteamTicketCheck>> PendingSteamTicketChecks;
+
     RSAKeyPair* ServerRSAKey;
 
     double NextDatabaseTrim = 0.0f;
+    bool DatabaseTrimQueued = false;
+
+    double NextAuthTokenExpiry = 0.0f;
+
+    WorkerGroup NetworkWorkers;
+    std::vector<Frpg2UdpPacketStream*> BatchedStreams;
 
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+// Maps a key (player id, steam id, online area, etc) to the clients registered under it,
+// so they can be found without walking every connected client. More than one client can
+// be registered under the same key, in which case Find returns the one added first.
+
+template <typename KeyType, typename ValueType>
+class ClientIndex
+{
+public:
+    void Add(const KeyType& Key, const ValueType& Value)
+    {
+        Entries[Key].push_back(Value);
+    }
+
+    void Remove(const KeyType& Key, const ValueType& Value)
+    {
+        auto iter = Entries.find(Key);
+        if (iter == Entries.end())
+        {
+            return;
+        }
+
+        std::vector<ValueType>& Values = iter->second;
+        if (auto ValueIter = std::find(Values.begin(), Values.end(), Value); ValueIter != Values.end())
+        {
+            Values.erase(ValueIter);
+        }
+
+        if (Values.empty())
+        {
+            Entries.erase(iter);
+        }
+    }
+
+    // Returns a default constructed value if nothing is registered under the key.
+    ValueType Find(const KeyType& Key) const
+    {
+        if (auto iter = Entries.find(Key); iter != Entries.end())
+        {
+            return iter->second.front();
+        }
+
+        return ValueType();
+    }
+
+    // Returns everything registered under the key, in the order it was added.
+    const std::vector<ValueType>& FindAll(const KeyType& Key) const
+    {
+        if (auto iter = Entries.find(Key); iter != Entries.end())
+        {
+            return iter->second;
+        }
+
+        return EmptyValues;
+    }
+
+    size_t Size() const { return Entries.size(); }
+
+private:
+    std::unordered_map<KeyType, std::vector<ValueType>> Entries;
+
+    inline static const std::vector<ValueType> EmptyValues;
+
+};
@@ -0,0 +1,180 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <cfloat>
+
+// Keeps track of which clients need polling so idle clients aren't visited every tick.
+// A client gets polled when it's marked as ready (data arrived for it, something was
+// sent to it, etc) or once the time it asked to be polled at comes around. The cost
+// of a tick only depends on how many clients are ready or due, not how many are connected.
+
+template <typename ClientType>
+class ClientScheduler
+{
+public:
+    using ClientPtr = std::shared_ptr<ClientType>;
+
+    // New clients are ready to poll straight away.
+    void Add(const ClientPtr& Client)
+    {
+        Entry& NewEntry = Entries[Client.get()];
+        NewEntry.Client = Client;
+        MarkReady(Client.get());
+    }
+
+    // Stale timers are skipped when they come up, but the ready list has to
+    // be cleaned up now in case another client is allocated at the same address.
+    void Remove(ClientType* Client)
+    {
+        auto iter = Entries.find(Client);
+        if (iter == Entries.end())
+        {
+            return;
+        }
+
+        if (iter->second.Ready)
+        {
+            ReadyClients.erase(std::find(ReadyClients.begin(), ReadyClients.end(), Client));
+        }
+
+        Entries.erase(iter);
+    }
+
+    // Does nothing for clients that are already ready or are being polled this tick. As
+    // that doesn't modify anything it's safe for clients being polled on other threads.
+    void MarkReady(ClientType* Client)
+    {
+        auto iter = Entries.find(Client);
+        if (iter == Entries.end() || iter->second.Ready || iter->second.Polling)
+        {
+            return;
+        }
+
+        iter->second.Ready = true;
+        ReadyClients.push_back(Client);
+    }
+
+    // Gets every client that is ready, or whose poll time is due, to be polled this tick. Each of
+    // them should be passed to EndPoll once done with, unless they have been removed.
+    void BeginTick(double CurrentTime, std::vector<ClientPtr>& Output)
+    {
+        while (!Timers.empty() && Timers.top().Time <= CurrentTime)
+        {
+            Timer Due = Timers.top();
+            Timers.pop();
+
+            auto iter = Entries.find(Due.Client);
+            if (iter == Entries.end() || iter->second.TimerSequence != Due.Sequence)
+            {
+                continue;
+            }
+
+            // Poll time may have been pushed back since the timer was queued.
+            Entry& DueEntry = iter->second;
+            DueEntry.TimerTime = DBL_MAX;
+            if (DueEntry.PollTime <= CurrentTime)
+            {
+                MarkReady(Due.Client);
+            }
+            else
+            {
+                QueueTimer(Due.Client, DueEntry, DueEntry.PollTime);
+            }
+        }
+
+        Output.clear();
+        for (ClientType* Client : ReadyClients)
+        {
+            Entry& ReadyEntry = Entries[Client];
+            ReadyEntry.Ready = false;
+            ReadyEntry.Polling = true;
+            Output.push_back(ReadyEntry.Client);
+        }
+        ReadyClients.clear();
+    }
+
+    // Called once a client returned by BeginTick has been polled. If StillReady it's polled
+    // again next tick, otherwise not until it's marked ready or NextPollTime comes around.
+    void EndPoll(ClientType* Client, bool StillReady, double NextPollTime)
+    {
+        auto iter = Entries.find(Client);
+        if (iter == Entries.end())
+        {
+            return;
+        }
+
+        Entry& PolledEntry = iter->second;
+        PolledEntry.Polling = false;
+        PolledEntry.PollTime = NextPollTime;
+
+        // An earlier timer will requeue itself for the new time when it comes up,
+        // so we only need a new one if it's sooner than whats already queued.
+        if (NextPollTime < PolledEntry.TimerTime)
+        {
+            QueueTimer(Client, PolledEntry, NextPollTime);
+        }
+
+        if (StillReady)
+        {
+            MarkReady(Client);
+        }
+    }
+
+    // Clients that have been marked ready since the last BeginTick.
+    const std::vector<ClientType*>& GetReadyClients() const { return ReadyClients; }
+
+    size_t Size() const { return Entries.size(); }
+
+private:
+    struct Entry
+    {
+        ClientPtr Client;
+        double PollTime = DBL_MAX;
+        double TimerTime = DBL_MAX;
+        uint64_t TimerSequence = 0;
+        bool Ready = false;
+        bool Polling = false;
+    };
+
+    struct Timer
+    {
+        double Time;
+        ClientType* Client;
+        uint64_t Sequence;
+
+        bool operator>(const Timer& Other) const
+        {
+            return Time > Other.Time;
+        }
+    };
+
+    void QueueTimer(ClientType* Client, Entry& TimerEntry, double Time)
+    {
+        TimerEntry.TimerTime = Time;
+        TimerEntry.TimerSequence = ++NextTimerSequence;
+        Timers.push({ Time, Client, TimerEntry.TimerSequence });
+    }
+
+private:
+    std::unordered_map<ClientType*, Entry> Entries;
+    std::vector<ClientType*> ReadyClients;
+
+    // Only the most recently queued timer for each client is live, the rest are skipped.
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> Timers;
+    uint64_t NextTimerSequence = 0;
+
+};
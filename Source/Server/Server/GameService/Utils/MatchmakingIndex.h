@@ -0,0 +1,317 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include "Config/RuntimeConfig.h"
+#include "Config/BuildConfig.h"
+#include "Platform/Platform.h"
+
+#include <unordered_map>
+#include <map>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <climits>
+#include <cfloat>
+#include <cmath>
+
+// Who is looking for a match. These are the host values passed to
+// RuntimeConfigMatchingParameters::CheckMatch.
+
+struct MatchmakingQuery
+{
+    const RuntimeConfigMatchingParameters* Parameters = nullptr;
+    int SoulLevel = 0;
+    int WeaponLevel = 0;
+    bool HasPassword = false;
+};
+
+// Players that can be matched with (invadable in an area, in a visitor pool, etc)
+// grouped by a key, then bucketed by soul level and weapon level. Searches only visit
+// buckets that can pass the matching parameters, starting at the soul level nearest
+// the searcher, and stop once enough candidates have been found. Results are ordered by
+// how close their soul level bucket is, then by how long they've been waiting.
+
+template <typename KeyType, typename ValueType>
+class MatchmakingIndex
+{
+public:
+    using PredicateFunction = std::function<bool(const ValueType&)>;
+
+    // Adds the value under the key, or moves it if already added. How long it's been
+    // waiting is kept as long as the key is the same.
+    void Update(const ValueType& Value, const KeyType& Key, int SoulLevel, int WeaponLevel)
+    {
+        int SoulBucket = GetSoulBucket(SoulLevel);
+        int WeaponBucket = GetWeaponBucket(WeaponLevel);
+        double EligibleTime = GetSeconds();
+
+        if (auto iter = Locations.find(Value); iter != Locations.end())
+        {
+            Location& Existing = iter->second;
+            if (Existing.Key == Key && Existing.SoulBucket == SoulBucket && Existing.WeaponBucket == WeaponBucket)
+            {
+                if (Entry* Found = FindEntry(Value, Existing))
+                {
+                    Found->SoulLevel = SoulLevel;
+                    Found->WeaponLevel = WeaponLevel;
+                }
+                return;
+            }
+
+            if (Existing.Key == Key)
+            {
+                if (Entry* Found = FindEntry(Value, Existing))
+                {
+                    EligibleTime = Found->EligibleTime;
+                }
+            }
+
+            RemoveEntry(Value, Existing);
+            Locations.erase(iter);
+        }
+
+        Pools[Key].SoulBuckets[SoulBucket][WeaponBucket].push_back({ Value, SoulLevel, WeaponLevel, EligibleTime });
+        Locations[Value] = { Key, SoulBucket, WeaponBucket };
+    }
+
+    void Remove(const ValueType& Value)
+    {
+        if (auto iter = Locations.find(Value); iter != Locations.end())
+        {
+            RemoveEntry(Value, iter->second);
+            Locations.erase(iter);
+        }
+    }
+
+    // Returns up to MaxResults values under the key that match the query and pass the predicate, best first.
+    std::vector<ValueType> FindBest(const KeyType& Key, const MatchmakingQuery& Query, size_t MaxResults, const PredicateFunction& Predicate) const
+    {
+        std::vector<ValueType> Results;
+
+        auto PoolIter = Pools.find(Key);
+        if (PoolIter == Pools.end() || MaxResults == 0)
+        {
+            return Results;
+        }
+
+        const Pool& SearchPool = PoolIter->second;
+        const RuntimeConfigMatchingParameters& Parameters = *Query.Parameters;
+        bool IgnoreLimits = Parameters.PasswordDisablesLimits && Query.HasPassword;
+
+        // Work out the soul level range we can match with, the same way CheckMatch does.
+        int MinSoulLevel = 0;
+        int MaxSoulLevel = INT_MAX;
+        if (!IgnoreLimits && !Parameters.DisableLevelMatching)
+        {
+            float LowerLimit = (Query.SoulLevel * Parameters.LowerLimitMultiplier) + Parameters.LowerLimitModifier;
+            float UpperLimit = (Query.SoulLevel * Parameters.UpperLimitMultiplier) + Parameters.UpperLimitModifier;
+            if (Query.SoulLevel >= Parameters.RangeRemovalLevel)
+            {
+                LowerLimit = (float)Parameters.RangeRemovalLevel;
+                UpperLimit = FLT_MAX;
+            }
+
+            MinSoulLevel = std::max(0, (int)std::ceil(std::max(LowerLimit, 0.0f)));
+            MaxSoulLevel = UpperLimit >= (float)INT_MAX ? INT_MAX : (int)std::floor(UpperLimit);
+        }
+
+        int MinBucket = std::max(GetSoulBucket(MinSoulLevel), SearchPool.SoulBuckets.begin()->first);
+        int MaxBucket = std::min(GetSoulBucket(MaxSoulLevel), SearchPool.SoulBuckets.rbegin()->first);
+        if (MinSoulLevel > MaxSoulLevel || MinBucket > MaxBucket)
+        {
+            return Results;
+        }
+
+        // And which weapon levels.
+        std::array<bool, WEAPON_BUCKET_COUNT> WeaponBucketAllowed;
+        for (int WeaponBucket = 0; WeaponBucket < WEAPON_BUCKET_COUNT; WeaponBucket++)
+        {
+            WeaponBucketAllowed[WeaponBucket] = IgnoreLimits || Parameters.DisableWeaponLevelMatching ||
+                (WeaponBucket <= GetWeaponLevelUpperLimit(Parameters, Query.WeaponLevel) && Query.WeaponLevel <= GetWeaponLevelUpperLimit(Parameters, WeaponBucket));
+        }
+
+        struct Candidate
+        {
+            int Distance;
+            const Entry* Match;
+        };
+        std::vector<Candidate> Candidates;
+
+        auto VisitBucket = [&](int SoulBucket, int Distance) {
+            auto BucketIter = SearchPool.SoulBuckets.find(SoulBucket);
+            if (BucketIter == SearchPool.SoulBuckets.end())
+            {
+                return;
+            }
+
+            for (int WeaponBucket = 0; WeaponBucket < WEAPON_BUCKET_COUNT; WeaponBucket++)
+            {
+                if (!WeaponBucketAllowed[WeaponBucket])
+                {
+                    continue;
+                }
+
+                for (const Entry& Match : BucketIter->second[WeaponBucket])
+                {
+                    // Buckets are coarser than the limits, so still do the exact check.
+                    if (!Parameters.CheckMatch(Query.SoulLevel, Query.WeaponLevel, Match.SoulLevel, Match.WeaponLevel, Query.HasPassword))
+                    {
+                        continue;
+                    }
+                    if (!Predicate(Match.Value))
+                    {
+                        continue;
+                    }
+
+                    Candidates.push_back({ Distance, &Match });
+                }
+            }
+        };
+
+        // Work outwards from the searchers soul level. Everything in later rings is a worse
+        // match than anything we already have, so stop as soon as we have enough.
+        int CenterBucket = std::clamp(GetSoulBucket(Query.SoulLevel), MinBucket, MaxBucket);
+        int SearcherBucket = GetSoulBucket(Query.SoulLevel);
+        for (int Ring = 0; CenterBucket - Ring >= MinBucket || CenterBucket + Ring <= MaxBucket; Ring++)
+        {
+            if (CenterBucket - Ring >= MinBucket)
+            {
+                VisitBucket(CenterBucket - Ring, std::abs(CenterBucket - Ring - SearcherBucket));
+            }
+            if (Ring > 0 && CenterBucket + Ring <= MaxBucket)
+            {
+                VisitBucket(CenterBucket + Ring, std::abs(CenterBucket + Ring - SearcherBucket));
+            }
+
+            if (Candidates.size() >= MaxResults)
+            {
+                break;
+            }
+        }
+
+        std::sort(Candidates.begin(), Candidates.end(), [](const Candidate& A, const Candidate& B) {
+            if (A.Distance != B.Distance)
+            {
+                return A.Distance < B.Distance;
+            }
+            return A.Match->EligibleTime < B.Match->EligibleTime;
+        });
+
+        size_t ResultCount = std::min(MaxResults, Candidates.size());
+        Results.reserve(ResultCount);
+        for (size_t i = 0; i < ResultCount; i++)
+        {
+            Results.push_back(Candidates[i].Match->Value);
+        }
+
+        return Results;
+    }
+
+private:
+    // Weapon levels go from 0 to 10.
+    inline static const int WEAPON_BUCKET_COUNT = 11;
+
+    struct Entry
+    {
+        ValueType Value;
+        int SoulLevel;
+        int WeaponLevel;
+        double EligibleTime;
+    };
+
+    struct Pool
+    {
+        std::map<int, std::array<std::vector<Entry>, WEAPON_BUCKET_COUNT>> SoulBuckets;
+    };
+
+    struct Location
+    {
+        KeyType Key;
+        int SoulBucket;
+        int WeaponBucket;
+    };
+
+    static int GetSoulBucket(int SoulLevel)
+    {
+        return std::max(SoulLevel, 0) / BuildConfig::MATCHMAKING_SOUL_LEVEL_BUCKET_SIZE;
+    }
+
+    static int GetWeaponBucket(int WeaponLevel)
+    {
+        return std::clamp(WeaponLevel, 0, WEAPON_BUCKET_COUNT - 1);
+    }
+
+    static int GetWeaponLevelUpperLimit(const RuntimeConfigMatchingParameters& Parameters, int WeaponLevel)
+    {
+        if (WeaponLevel < 0 || WeaponLevel >= (int)Parameters.WeaponLevelUpperLimit.size())
+        {
+            return INT_MAX;
+        }
+        return Parameters.WeaponLevelUpperLimit[WeaponLevel];
+    }
+
+    Entry* FindEntry(const ValueType& Value, const Location& At)
+    {
+        std::vector<Entry>& Bucket = Pools[At.Key].SoulBuckets[At.SoulBucket][At.WeaponBucket];
+        for (Entry& Existing : Bucket)
+        {
+            if (Existing.Value == Value)
+            {
+                return &Existing;
+            }
+        }
+        return nullptr;
+    }
+
+    void RemoveEntry(const ValueType& Value, const Location& At)
+    {
+        auto PoolIter = Pools.find(At.Key);
+        if (PoolIter == Pools.end())
+        {
+            return;
+        }
+
+        auto BucketIter = PoolIter->second.SoulBuckets.find(At.SoulBucket);
+        if (BucketIter == PoolIter->second.SoulBuckets.end())
+        {
+            return;
+        }
+
+        // Order within a bucket doesn't matter, results are sorted by wait time.
+        std::vector<Entry>& Bucket = BucketIter->second[At.WeaponBucket];
+        for (size_t i = 0; i < Bucket.size(); i++)
+        {
+            if (Bucket[i].Value == Value)
+            {
+                Bucket[i] = std::move(Bucket.back());
+                Bucket.pop_back();
+                break;
+            }
+        }
+
+        // Get rid of empty buckets so searches don't have to visit them.
+        bool BucketEmpty = std::all_of(BucketIter->second.begin(), BucketIter->second.end(), [](const std::vector<Entry>& Entries) { return Entries.empty(); });
+        if (BucketEmpty)
+        {
+            PoolIter->second.SoulBuckets.erase(BucketIter);
+            if (PoolIter->second.SoulBuckets.empty())
+            {
+                Pools.erase(PoolIter);
+            }
+        }
+    }
+
+private:
+    std::unordered_map<KeyType, Pool> Pools;
+    std::unordered_map<ValueType, Location> Locations;
+
+};
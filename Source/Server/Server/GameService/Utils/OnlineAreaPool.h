@@ -9,7 +9,7 @@
 
 #pragma once
 
-#include "Server/GameService/Utils/Gameids.h"
+#include "Server/GameService/Utils/GameIds.h"
 
 #include <unordered_map>
 #include <deque>
@@ -28,25 +28,49 @@ struct OnlineAreaPool
 {
 public:
     using EntryId = uint32_t;
+    using TrimCallback = std::function<void(const std::shared_ptr<ValueType>& Value)>;
 
 private:
+    struct Entry
+    {
+        EntryId Id;
+        std::shared_ptr<ValueType> Value;
+
+        // Which add this entry came from, lets us tell if a RemoveOrderQueue entry still refers to it.
+        uint64_t Sequence;
+    };
+
+    struct QueuedEntry
+    {
+        EntryId Id;
+        uint64_t Sequence;
+    };
+
     struct Area
     {
-        std::unordered_map<EntryId, std::shared_ptr<ValueType>> Entries;
-        std::deque<EntryId> RemoveOrderQueue;
+        // Entries are kept densely packed so random sets can be drawn straight out of them. 
+        // The order means nothing, removals swap the last entry into the gap.
+        std::vector<Entry> Entries;
+        std::unordered_map<EntryId, size_t> EntryIndices;
+
+        // Oldest first. Removed entries are left in here as stale, they are dropped
+        // when they reach the front, or all at once when they outnumber the live ones.
+        std::deque<QueuedEntry> RemoveOrderQueue;
     };
 
 private:
-    std::shared_ptr<Area> FindOrCreateArea(OnlineAreaId AreaId)
+    Area* FindArea(OnlineAreaId AreaId)
     {
         if (auto iter = AreaMap.find(AreaId); iter != AreaMap.end())
         {
-            return iter->second;
+            return &iter->second;
         }
+        return nullptr;
+    }
 
-        std::shared_ptr<Area> NewArea = std::make_shared<Area>();
-        AreaMap.insert({ AreaId, NewArea });
-        return NewArea;
+    Area& FindOrCreateArea(OnlineAreaId AreaId)
+    {
+        return AreaMap[AreaId];
     }
 
 public:
@@ -57,27 +81,24 @@ public:
 
     bool Remove(OnlineAreaId AreaId, EntryId Id)
     {
-        std::shared_ptr<Area> AreaInstance = FindOrCreateArea(AreaId);
-        if (auto iter = AreaInstance->Entries.find(Id); iter != AreaInstance->Entries.end())
+        Area* AreaInstance = FindArea(AreaId);
+        if (!AreaInstance || !RemoveEntry(*AreaInstance, Id))
         {
-            std::shared_ptr<ValueType> Entry = iter->second;
-            AreaInstance->Entries.erase(iter);
-            
-            // We can ignore the RemoveOrderQueue for now, it will get purged during Trim'ing
-            // Saves iterating over entire deque.
-
-            return true;
+            return false;
         }
 
-        return false;
+        CompactQueue(*AreaInstance);
+        return true;
     }
 
     std::shared_ptr<ValueType> Find(OnlineAreaId AreaId, EntryId Id)
     {
-        std::shared_ptr<Area> AreaInstance = FindOrCreateArea(AreaId);
-        if (auto iter = AreaInstance->Entries.find(Id); iter != AreaInstance->Entries.end())
+        if (Area* AreaInstance = FindArea(AreaId))
         {
-            return iter->second;
+            if (auto iter = AreaInstance->EntryIndices.find(Id); iter != AreaInstance->EntryIndices.end())
+            {
+                return AreaInstance->Entries[iter->second].Value;
+            }
         }
         return nullptr;
     }
@@ -85,12 +106,12 @@ public:
     // Avoid using this one if you can, it has to look through a lot more areas.
     std::shared_ptr<ValueType> Find(EntryId Id)
     {
-        for (auto AreaPair : AreaMap)
+        for (auto& AreaPair : AreaMap)
         {
-            std::shared_ptr<Area> AreaInstance = AreaPair.second;
-            if (auto iter = AreaInstance->Entries.find(Id); iter != AreaInstance->Entries.end())
+            Area& AreaInstance = AreaPair.second;
+            if (auto iter = AreaInstance.EntryIndices.find(Id); iter != AreaInstance.EntryIndices.end())
             {
-                return iter->second;
+                return AreaInstance.Entries[iter->second].Value;
             }
         }
         return nullptr;
@@ -99,39 +120,42 @@ public:
     size_t GetTotalEntries()
     {
         size_t Total = 0;
-        for (auto AreaPair : AreaMap)
+        for (auto& AreaPair : AreaMap)
         {
-            std::shared_ptr<Area> AreaInstance = AreaPair.second;
-            Total += AreaInstance->Entries.size();
+            Total += AreaPair.second.Entries.size();
         }
         return Total;
     }
 
     std::vector<std::shared_ptr<ValueType>> GetRandomSet(OnlineAreaId AreaId, int MaxCount)
     {
-        std::shared_ptr<Area> AreaInstance = FindOrCreateArea(AreaId);
-
         std::vector<std::shared_ptr<ValueType>> Result;
 
-        // TODO: This is not efficient its O(n), do this better.
-
-        // Get a list of entry id's
-        std::vector<EntryId> EntryIds;
-        EntryIds.reserve(AreaInstance->Entries.size());
-
-        for (auto KeyPair : AreaInstance->Entries) 
+        Area* AreaInstance = FindArea(AreaId);
+        if (!AreaInstance || MaxCount <= 0)
         {
-            EntryIds.push_back(KeyPair.first);
+            return Result;
         }
-        
-        // Shuffle them up.
-        std::shuffle(EntryIds.begin(), EntryIds.end(), RandomGenerator);
 
-        // Select however many we need.
-        int MaxToGather = std::min(MaxCount, (int)EntryIds.size());
-        for (int i = 0; i < MaxToGather; i++)
+        std::vector<Entry>& Entries = AreaInstance->Entries;
+        size_t MaxToGather = std::min((size_t)MaxCount, Entries.size());
+        Result.reserve(MaxToGather);
+
+        // Partial fisher-yates shuffle, each step swaps a random entry from the remainder into
+        // the front, so the first MaxToGather entries are a uniformly random selection and we only 
+        // pay for the ones we return.
+        for (size_t i = 0; i < MaxToGather; i++)
         {
-            Result.push_back(AreaInstance->Entries[EntryIds[i]]);
+            std::uniform_int_distribution<size_t> Distribution(i, Entries.size() - 1);
+            size_t Chosen = Distribution(RandomGenerator);
+            if (Chosen != i)
+            {
+                std::swap(Entries[i], Entries[Chosen]);
+                AreaInstance->EntryIndices[Entries[i].Id] = i;
+                AreaInstance->EntryIndices[Entries[Chosen].Id] = Chosen;
+            }
+
+            Result.push_back(Entries[i].Value);
         }
 
         return Result;
@@ -141,18 +165,21 @@ public:
     {
         std::vector<std::shared_ptr<ValueType>> Result;
 
-        std::shared_ptr<Area> AreaInstance = FindOrCreateArea(AreaId);
+        Area* AreaInstance = FindArea(AreaId);
+        if (!AreaInstance)
+        {
+            return Result;
+        }
 
         int RemainingCount = MaxCount;
 
-        for (int i = 0; i < AreaInstance->RemoveOrderQueue.size() && RemainingCount > 0; i++)
+        for (size_t i = 0; i < AreaInstance->RemoveOrderQueue.size() && RemainingCount > 0; i++)
         {
-            EntryId Id = AreaInstance->RemoveOrderQueue[i];
-            if (auto Iter = AreaInstance->Entries.find(Id); Iter != AreaInstance->Entries.end())
+            if (Entry* Found = FindQueuedEntry(*AreaInstance, AreaInstance->RemoveOrderQueue[i]))
             {
-                if (FilterCallback(Iter->second))
+                if (FilterCallback(Found->Value))
                 {
-                    Result.push_back(Iter->second);
+                    Result.push_back(Found->Value);
                     RemainingCount--;
                 }
             }
@@ -168,14 +195,17 @@ public:
 
     bool Add(OnlineAreaId AreaId, EntryId Id, std::shared_ptr<ValueType> Value)
     {
-        std::shared_ptr<Area> AreaInstance = FindOrCreateArea(AreaId);
-        if (auto iter = AreaInstance->Entries.find(Id); iter != AreaInstance->Entries.end())
+        Area& AreaInstance = FindOrCreateArea(AreaId);
+        if (auto iter = AreaInstance.EntryIndices.find(Id); iter != AreaInstance.EntryIndices.end())
         {
             return false;
         }
 
-        AreaInstance->Entries.insert({ Id, Value });
-        AreaInstance->RemoveOrderQueue.push_back(Id);
+        uint64_t Sequence = NextSequence++;
+
+        AreaInstance.EntryIndices.insert({ Id, AreaInstance.Entries.size() });
+        AreaInstance.Entries.push_back({ Id, Value, Sequence });
+        AreaInstance.RemoveOrderQueue.push_back({ Id, Sequence });
         TrimArea(AreaInstance);
 
         return true;
@@ -183,10 +213,9 @@ public:
 
     void Trim()
     {
-        for (auto Pair : AreaMap)
+        for (auto& Pair : AreaMap)
         {
-            std::shared_ptr<Area> AreaInstance = Pair.second;
-            TrimArea(AreaInstance);
+            TrimArea(Pair.second);
         }
     }
 
@@ -195,25 +224,103 @@ public:
         MaxEntriesPerArea = Entries;
     }
 
+    // Called for each entry dropped to keep an area under its maximum, so anything else
+    // indexing the entries can drop them too. Not called for entries passed to Remove.
+    void SetTrimCallback(TrimCallback Callback)
+    {
+        OnTrimmed = std::move(Callback);
+    }
+
+    // Makes GetRandomSet repeatable, for tests.
+    void SetRandomSeed(uint32_t Seed)
+    {
+        RandomGenerator.seed(Seed);
+    }
+
 private:
 
-    void TrimArea(std::shared_ptr<Area> AreaInstance)
+    // Returns nullptr if the entry the queue refers to has since been removed.
+    Entry* FindQueuedEntry(Area& AreaInstance, const QueuedEntry& Queued)
     {
-        while (AreaInstance->Entries.size() > MaxEntriesPerArea && AreaInstance->RemoveOrderQueue.size() > 0)
+        if (auto iter = AreaInstance.EntryIndices.find(Queued.Id); iter != AreaInstance.EntryIndices.end())
         {
-            EntryId ToRemove = AreaInstance->RemoveOrderQueue.front();
-            AreaInstance->RemoveOrderQueue.pop_front();
+            Entry& Found = AreaInstance.Entries[iter->second];
+            if (Found.Sequence == Queued.Sequence)
+            {
+                return &Found;
+            }
+        }
+        return nullptr;
+    }
+
+    bool RemoveEntry(Area& AreaInstance, EntryId Id)
+    {
+        auto iter = AreaInstance.EntryIndices.find(Id);
+        if (iter == AreaInstance.EntryIndices.end())
+        {
+            return false;
+        }
+
+        size_t Index = iter->second;
+        AreaInstance.EntryIndices.erase(iter);
+
+        if (Index != AreaInstance.Entries.size() - 1)
+        {
+            AreaInstance.Entries[Index] = std::move(AreaInstance.Entries.back());
+            AreaInstance.EntryIndices[AreaInstance.Entries[Index].Id] = Index;
+        }
+        AreaInstance.Entries.pop_back();
+
+        return true;
+    }
+
+    void CompactQueue(Area& AreaInstance)
+    {
+        std::deque<QueuedEntry>& Queue = AreaInstance.RemoveOrderQueue;
+
+        while (!Queue.empty() && !FindQueuedEntry(AreaInstance, Queue.front()))
+        {
+            Queue.pop_front();
+        }
+
+        // Only happens after at least as many removals as there are live entries, so it evens out to constant time per removal.
+        if (Queue.size() > (AreaInstance.Entries.size() * 2) + 16)
+        {
+            Queue.erase(std::remove_if(Queue.begin(), Queue.end(), [this, &AreaInstance](const QueuedEntry& Queued) {
+                return FindQueuedEntry(AreaInstance, Queued) == nullptr;
+            }), Queue.end());
+        }
+    }
 
-            if (auto iter = AreaInstance->Entries.find(ToRemove); iter != AreaInstance->Entries.end())
+    void TrimArea(Area& AreaInstance)
+    {
+        size_t MaxEntries = (size_t)std::max(MaxEntriesPerArea, 0);
+        while (AreaInstance.Entries.size() > MaxEntries && AreaInstance.RemoveOrderQueue.size() > 0)
+        {
+            QueuedEntry ToRemove = AreaInstance.RemoveOrderQueue.front();
+            AreaInstance.RemoveOrderQueue.pop_front();
+
+            if (Entry* Found = FindQueuedEntry(AreaInstance, ToRemove))
             {
-                AreaInstance->Entries.erase(iter);
+                std::shared_ptr<ValueType> Value = Found->Value;
+                RemoveEntry(AreaInstance, ToRemove.Id);
+
+                if (OnTrimmed)
+                {
+                    OnTrimmed(Value);
+                }
             }
         }
+
+        CompactQueue(AreaInstance);
     }
 
 private:
-    std::unordered_map<OnlineAreaId, std::shared_ptr<Area>> AreaMap;
+    std::unordered_map<OnlineAreaId, Area> AreaMap;
     int MaxEntriesPerArea  = 100;
+    uint64_t NextSequence = 0;
+
+    TrimCallback OnTrimmed;
 
     std::random_device RandomDevice;
     std::mt19937 RandomGenerator;
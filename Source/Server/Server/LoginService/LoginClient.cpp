@@ -31,6 +31,7 @@ LoginClient::LoginClient(LoginService* OwningService, std::shared_ptr<NetConnect
     LastMessageRecievedTime = GetSeconds();
 
     MessageStream = std::make_shared<Frpg2MessageStream>(InConnection, InServerRSAKey);
+    MessageStream->SetCipherWorkerPool(&OwningService->GetServer()->GetHandshakeWorkerPool());
 }
 
 bool LoginClient::Poll()
@@ -48,6 +48,9 @@ Server::Server()
         QuitRecieved = true;
     });
 
+    HandshakeWorkerPool = std::make_unique<CipherWorkerPool>(BuildConfig::HANDSHAKE_WORKER_COUNT, BuildConfig::MAX_QUEUED_HANDSHAKE_OPERATIONS);
+    MaintenanceWorker = std::make_unique<BackgroundWorker>();
+
     // Register all services we want to run.
     Services.push_back(std::make_shared<LoginService>(this, &PrimaryKeyPair));
     Services.push_back(std::make_shared<AuthService>(this, &PrimaryKeyPair));
@@ -185,6 +188,8 @@ bool Server::Init()
         return false;
     }
 
+    DatabaseWorker = std::make_unique<DatabaseExecutor>(Database);
+
     // Initialize all our services.
     for (auto& Service : Services)
     {
@@ -202,6 +207,9 @@ bool Server::Term()
 {
     Log("Terminating server ...");
 
+    // Let any maintenance jobs still running finish, they use the services and database.
+    MaintenanceWorker = nullptr;
+
     CancelServerAdvertisement();
 
     for (auto& Service : Services)
@@ -213,6 +221,9 @@ bool Server::Term()
         }
     }
 
+    // Flushes any queries still queued.
+    DatabaseWorker = nullptr;
+
     if (!Database.Close())
     {
         Error("Failed to close database.");
@@ -295,23 +306,13 @@ void Server::PollServerAdvertisement()
     }
 
     // Waiting for current advertisement to finish.
-    if (MasterServerUpdateRequest)
+    if (MasterServerUpdateInProgress)
     {
-        if (!MasterServerUpdateRequest->InProgress())
-        {
-            if (std::shared_ptr<NetHttpResponse> Response = MasterServerUpdateRequest->GetResponse(); Response && Response->GetWasSuccess())
-            {
-                nlohmann::json json;
-                ParseServerAdvertisementResponse(Response, json);
-            }
-
-            LastMasterServerUpdate = GetSeconds();
-            MasterServerUpdateRequest = nullptr;
-        }
+        return;
     }
 
     // Is it time to kick off a new one?
-    else if (GetSeconds() - LastMasterServerUpdate > Config.AdvertiseHearbeatTime)
+    if (GetSeconds() - LastMasterServerUpdate > Config.AdvertiseHearbeatTime)
     {
         nlohmann::json Body;
         Body["Hostname"] = Config.ServerHostname.length() > 0 ? Config.ServerHostname : PublicIP.ToString();
@@ -325,15 +326,33 @@ void Server::PollServerAdvertisement()
         Body["ModsBlackList"] = Config.ModsBlacklist;
         Body["ModsRequiredList"] = Config.ModsRequiredList;        
 
-        MasterServerUpdateRequest = std::make_shared<NetHttpRequest>();
-        MasterServerUpdateRequest->SetMethod(NetHttpMethod::POST);
-        MasterServerUpdateRequest->SetBody(Body.dump(4));
-        MasterServerUpdateRequest->SetUrl(StringFormat("http://%s:%i/api/v1/servers", Config.MasterServerIp.c_str(), Config.MasterServerPort));
-        if (!MasterServerUpdateRequest->SendAsync())
-        {
-            Warning("Recieved error when trying to advertise server on master server. Failed to start request.");
-            MasterServerUpdateRequest = nullptr;
-        }
+        std::string RequestBody = Body.dump(4);
+        std::string RequestUrl = StringFormat("http://%s:%i/api/v1/servers", Config.MasterServerIp.c_str(), Config.MasterServerPort);
+
+        // The request and parsing its response are done on the maintenance worker, everything 
+        // it needs is gathered above so it doesn't touch anything the main thread is using.
+        MasterServerUpdateInProgress = true;
+        MaintenanceWorker->Submit([this, RequestBody, RequestUrl]() {
+            NetHttpRequest Request;
+            Request.SetMethod(NetHttpMethod::POST);
+            Request.SetBody(RequestBody);
+            Request.SetUrl(RequestUrl);
+            if (!Request.Send())
+            {
+                Warning("Recieved error when trying to advertise server on master server. Failed to start request.");
+                MasterServerUpdateInProgress = false;
+                return;
+            }
+
+            if (std::shared_ptr<NetHttpResponse> Response = Request.GetResponse(); Response && Response->GetWasSuccess())
+            {
+                nlohmann::json json;
+                ParseServerAdvertisementResponse(Response, json);
+            }
+
+            LastMasterServerUpdate = GetSeconds();
+            MasterServerUpdateInProgress = false;
+        }, &Debug::Maintenance_AdvertiseTime);
     }
 }
 
@@ -341,6 +360,20 @@ void Server::RunUntilQuit()
 {
     Success("Server is now running.");
 
+    for (auto& Service : Services)
+    {
+        if (Service->HasOwnThread())
+        {
+            ServiceThreads.push_back(std::thread([this, Service]() {
+                while (!QuitRecieved)
+                {
+                    Service->Poll();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }));
+        }
+    }
+
     // We should really do this event driven ...
     // This suffices for now.
     while (!QuitRecieved)
@@ -348,9 +381,14 @@ void Server::RunUntilQuit()
         {
             DebugTimerScope Scope(Debug::UpdateTime);
 
+            DatabaseWorker->Poll();
+
             for (auto& Service : Services)
             {
-                Service->Poll();
+                if (!Service->HasOwnThread())
+                {
+                    Service->Poll();
+                }
             }
 
             PollServerAdvertisement();
@@ -374,6 +412,12 @@ void Server::RunUntilQuit()
 
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
+
+    for (std::thread& Thread : ServiceThreads)
+    {
+        Thread.join();
+    }
+    ServiceThreads.clear();
 }
 
 void Server::SaveConfig()
@@ -10,14 +10,20 @@
 #pragma once
 
 #include "Server/Database/ServerDatabase.h"
+#include "Server/Database/DatabaseExecutor.h"
+
+#include "Core/Utils/BackgroundWorker.h"
 
 #include "Platform/Platform.h"
 
 #include <memory>
 #include <vector>
 #include <filesystem>
+#include <thread>
+#include <atomic>
 
 #include "Core/Crypto/RSAKeyPair.h"
+#include "Core/Crypto/CipherWorkerPool.h"
 
 #include "Core/Network/NetIPAddress.h"
 
@@ -46,9 +52,16 @@ public:
     RuntimeConfig& GetMutableConfig()   { return Config; }
     ServerDatabase& GetDatabase()       { return Database; }
 
+    // Queue for database queries that shouldn't block the main thread. Completions
+    // are called from the main loop.
+    DatabaseExecutor& GetDatabaseExecutor() { return *DatabaseWorker; }
+
     NetIPAddress GetPublicIP()          { return PublicIP; }
     NetIPAddress GetPrivateIP()         { return PrivateIP; }
 
+    // Pool the login and auth services run their rsa handshakes on.
+    CipherWorkerPool& GetHandshakeWorkerPool() { return *HandshakeWorkerPool; }
+
     template <typename T>
     std::shared_ptr<T> GetService()
     {
@@ -71,7 +84,7 @@ protected:
 
 private:
 
-    bool QuitRecieved = false;
+    std::atomic<bool> QuitRecieved = false;
 
     PlatformEvents::CtrlSignalEvent::DelegatePtr CtrlSignalHandle = nullptr;
 
@@ -79,8 +92,14 @@ private:
 
     std::vector<std::shared_ptr<Service>> Services;
 
+    // Threads polling the services that asked for their own.
+    std::vector<std::thread> ServiceThreads;
+
     ServerDatabase Database;
 
+    // Declared after the database so its thread is stopped before the database goes away.
+    std::unique_ptr<DatabaseExecutor> DatabaseWorker;
+
     std::filesystem::path SavedPath;
     std::filesystem::path ConfigPath;
     std::filesystem::path PrivateKeyPath;
@@ -93,9 +112,15 @@ private:
 
     RSAKeyPair PrimaryKeyPair;
 
+    // Declared after the key pair so it is destroyed (and its workers stopped) first.
+    std::unique_ptr<CipherWorkerPool> HandshakeWorkerPool;
+
     double NextSpikeTime = 0.0;
 
     double LastMasterServerUpdate = 0.0;
-    std::shared_ptr<NetHttpRequest> MasterServerUpdateRequest;
+    std::atomic<bool> MasterServerUpdateInProgress = false;
+
+    // Declared last so it is destroyed first, its jobs use most of the above.
+    std::unique_ptr<BackgroundWorker> MaintenanceWorker;
 
 };
\ No newline at end of file
@@ -25,4 +25,9 @@ public:
 
     virtual std::string GetName() = 0;
 
+    // If true the service is polled on a thread of its own rather than from the main 
+    // loop, so it can't hold up the other services. Anything it calls on other services
+    // must be thread safe.
+    virtual bool HasOwnThread() { return false; }
+
 };
\ No newline at end of file
@@ -17,8 +17,11 @@
 #include "Core/Utils/Logging.h"
 #include "Core/Utils/Strings.h"
 
+#include "Core/Utils/DebugObjects.h"
+
 #include "Core/Crypto/RSAKeyPair.h"
 #include "Core/Crypto/RSACipher.h"
+#include "Core/Crypto/CipherWorkerPool.h"
 
 Frpg2MessageStream::Frpg2MessageStream(std::shared_ptr<NetConnection> Connection, RSAKeyPair* InEncryptionKey, bool AsClient)
     : Frpg2PacketStream(Connection)
@@ -40,6 +43,48 @@ void Frpg2MessageStream::SetCipher(std::shared_ptr<Cipher> Encryption, std::shar
 {
     EncryptionCipher = Encryption;
     DecryptionCipher = Decryption;
+
+    UsingHandshakeCipher = false;
+}
+
+void Frpg2MessageStream::SetCipherWorkerPool(CipherWorkerPool* Pool)
+{
+    WorkerPool = Pool;
+}
+
+bool Frpg2MessageStream::ShouldOffloadCipher()
+{
+    return WorkerPool != nullptr && UsingHandshakeCipher;
+}
+
+bool Frpg2MessageStream::Pump()
+{
+    if (InCipherErrorState)
+    {
+        return true;
+    }
+
+    // Send anything that has finished encrypting on the worker pool, in the order it was sent.
+    while (!PendingSends.empty() && PendingSends.front().Job->Complete)
+    {
+        PendingSend& Pending = PendingSends.front();
+        if (!Pending.Job->Success)
+        {
+            WarningS(Connection->GetName().c_str(), "Failed to encrypt message payload.");
+            return true;
+        }
+
+        Pending.Message.Payload = std::move(Pending.Job->Data);
+
+        if (!SendEncrypted(Pending.Message, Pending.Packet))
+        {
+            return true;
+        }
+
+        PendingSends.pop_front();
+    }
+
+    return Frpg2PacketStream::Pump();
 }
 
 bool Frpg2MessageStream::Send(const Frpg2Message& Message, Frpg2MessageType MessageType, uint32_t ResponseToRequestIndex)
@@ -57,16 +102,58 @@ bool Frpg2MessageStream::Send(const Frpg2Message& Message, Frpg2MessageType Mess
         Packet.Disassembly = Disassemble(SendMessage);
     }
 
-    std::vector<uint8_t> DecryptedBuffer = Message.Payload;
+    // Handshake ciphers are expensive so they are encrypted on the worker pool and 
+    // sent from Pump once complete. Anything sent while they are in flight has to 
+    // queue up behind them to keep the order.
+    if (ShouldOffloadCipher() || !PendingSends.empty())
+    {
+        return QueueSend(SendMessage, Packet);
+    }
+
     if (EncryptionCipher)
     {
-        if (!EncryptionCipher->Encrypt(DecryptedBuffer, SendMessage.Payload))
+        if (!EncryptionCipher->Encrypt(SendMessage.Payload))
         {
             WarningS(Connection->GetName().c_str(), "Failed to encrypt message payload.");
             return false;
         }
     }
 
+    return SendEncrypted(SendMessage, Packet);
+}
+
+bool Frpg2MessageStream::QueueSend(Frpg2Message& Message, Frpg2Packet& Packet)
+{
+    PendingSend Pending;
+
+    if (ShouldOffloadCipher())
+    {
+        Pending.Job = WorkerPool->Submit(EncryptionCipher, true, std::move(Message.Payload));
+        if (!Pending.Job)
+        {
+            WarningS(Connection->GetName().c_str(), "Shedding handshake, too many cipher operations are already queued.");
+            Debug::HandshakesShed.Add(1);
+            InCipherErrorState = true;
+            return false;
+        }
+    }
+    else
+    {
+        Pending.Job = std::make_shared<CipherJob>();
+        Pending.Job->Success = !EncryptionCipher || EncryptionCipher->Encrypt(Message.Payload);
+        Pending.Job->Data = std::move(Message.Payload);
+        Pending.Job->Complete = true;
+    }
+
+    Pending.Message = std::move(Message);
+    Pending.Packet = std::move(Packet);
+    PendingSends.push_back(std::move(Pending));
+
+    return true;
+}
+
+bool Frpg2MessageStream::SendEncrypted(const Frpg2Message& SendMessage, Frpg2Packet& Packet)
+{
     if (!MessageToPacket(SendMessage, Packet))
     {
         WarningS(Connection->GetName().c_str(), "Failed to convert message to packet payload.");
@@ -103,6 +190,11 @@ bool Frpg2MessageStream::Send(google::protobuf::MessageLite* Message, Frpg2Messa
 
 bool Frpg2MessageStream::Recieve(Frpg2Message* Message)
 {
+    if (ShouldOffloadCipher())
+    {
+        return RecieveOffloaded(Message);
+    }
+
     Frpg2Packet Packet;
     if (!Frpg2PacketStream::Recieve(&Packet))
     {
@@ -115,10 +207,9 @@ bool Frpg2MessageStream::Recieve(Frpg2Message* Message)
         return false;
     }
 
-    std::vector<uint8_t> EncryptedBuffer = Message->Payload;
-    if (DecryptionCipher && EncryptedBuffer.size() > 0)
+    if (DecryptionCipher && Message->Payload.size() > 0)
     {
-        if (!DecryptionCipher->Decrypt(EncryptedBuffer, Message->Payload))
+        if (!DecryptionCipher->Decrypt(Message->Payload))
         {
             WarningS(Connection->GetName().c_str(), "Failed to decrypt message payload.");
             return false;
@@ -137,6 +228,68 @@ bool Frpg2MessageStream::Recieve(Frpg2Message* Message)
     return true;
 }
 
+bool Frpg2MessageStream::RecieveOffloaded(Frpg2Message* Message)
+{
+    // Start decrypting the next message if we aren't already waiting on one. Only one 
+    // is in flight at a time, the rest wait in the packet queue so order is kept.
+    if (!PendingRecieve)
+    {
+        Frpg2Packet Packet;
+        if (!Frpg2PacketStream::Recieve(&Packet))
+        {
+            return false;
+        }
+
+        if (!PacketToMessage(Packet, PendingRecieveMessage))
+        {
+            WarningS(Connection->GetName().c_str(), "Failed to convert packet payload to message.");
+            return false;
+        }
+
+        PendingRecieveMessage.Disassembly = Packet.Disassembly;
+
+        if (!DecryptionCipher || PendingRecieveMessage.Payload.size() == 0)
+        {
+            *Message = std::move(PendingRecieveMessage);
+            return true;
+        }
+
+        PendingRecieve = WorkerPool->Submit(DecryptionCipher, false, std::move(PendingRecieveMessage.Payload));
+        if (!PendingRecieve)
+        {
+            WarningS(Connection->GetName().c_str(), "Shedding handshake, too many cipher operations are already queued.");
+            Debug::HandshakesShed.Add(1);
+            InCipherErrorState = true;
+            return false;
+        }
+    }
+
+    if (!PendingRecieve->Complete)
+    {
+        return false;
+    }
+
+    std::shared_ptr<CipherJob> Job = std::move(PendingRecieve);
+    if (!Job->Success)
+    {
+        WarningS(Connection->GetName().c_str(), "Failed to decrypt message payload.");
+        return false;
+    }
+
+    *Message = std::move(PendingRecieveMessage);
+    Message->Payload = std::move(Job->Data);
+
+    // Disassemble if required.
+    if constexpr (BuildConfig::DISASSEMBLE_RECIEVED_MESSAGES)
+    {
+        Message->Disassembly.append(Disassemble(*Message));
+
+        Log("\n<< RECV\n%s", Message->Disassembly.c_str());
+    }
+
+    return true;
+}
+
 bool Frpg2MessageStream::PacketToMessage(const Frpg2Packet& Packet, Frpg2Message& Message)
 {
     if (Packet.Payload.size() < sizeof(Frpg2MessageHeader))
@@ -14,8 +14,12 @@
 
 #include "Protobuf/Protobufs.h"
 
+#include <deque>
+
 class RSAKeyPair;
 class Cipher;
+class CipherWorkerPool;
+struct CipherJob;
 
 class Frpg2MessageStream
     : public Frpg2PacketStream
@@ -36,6 +40,14 @@ public:
     // Changes the cipher used for encryption/descryption.
     virtual void SetCipher(std::shared_ptr<Cipher> Encryption, std::shared_ptr<Cipher> Decryption);
 
+    // Runs the rsa handshake ciphers on the given worker pool rather than on the calling 
+    // thread. Sends are flushed by Pump once encrypted, and Recieve returns false until
+    // the next message has finished decrypting. Ciphers given to SetCipher always run inline.
+    void SetCipherWorkerPool(CipherWorkerPool* Pool);
+
+    // Flushes any sends waiting on the worker pool before pumping the underlying packet stream.
+    virtual bool Pump() override;
+
     // Diassembles a messages into a human-readable string.
     std::string Disassemble(const Frpg2Message& Message);
 
@@ -47,10 +59,31 @@ protected:
     bool PacketToMessage(const Frpg2Packet& Packet, Frpg2Message& Message);
     bool MessageToPacket(const Frpg2Message& Message, Frpg2Packet& Packet);
 
+    bool ShouldOffloadCipher();
+    bool QueueSend(Frpg2Message& Message, Frpg2Packet& Packet);
+    bool SendEncrypted(const Frpg2Message& Message, Frpg2Packet& Packet);
+    bool RecieveOffloaded(Frpg2Message* Message);
+
 private:
     
     RSAKeyPair* EncryptionKey;
 
     std::shared_ptr<Cipher> EncryptionCipher;
     std::shared_ptr<Cipher> DecryptionCipher;
+
+    CipherWorkerPool* WorkerPool = nullptr;
+    bool UsingHandshakeCipher = true;
+    bool InCipherErrorState = false;
+
+    struct PendingSend
+    {
+        Frpg2Message Message;
+        Frpg2Packet Packet;
+        std::shared_ptr<CipherJob> Job;
+    };
+
+    std::deque<PendingSend> PendingSends;
+
+    Frpg2Message PendingRecieveMessage;
+    std::shared_ptr<CipherJob> PendingRecieve;
 };
\ No newline at end of file
@@ -27,23 +27,49 @@ Frpg2ReliableUdpFragmentStream::Frpg2ReliableUdpFragmentStream(std::shared_ptr<N
 {
 }
 
+bool Frpg2ReliableUdpFragmentStream::PreparePayload(const std::vector<uint8_t>& Payload, Frpg2ReliableUdpFragment& Output)
+{
+    Output.PayloadDecompressedLength = (uint32_t)Payload.size();
+
+    if (Payload.size() < MIN_SIZE_FOR_COMPRESSION)
+    {
+        Output.Header.compress_flag = false;
+        Output.Payload = Payload;
+        return true;
+    }
+
+    Output.Header.compress_flag = true;
+    return Compress(Payload, Output.Payload);
+}
+
 bool Frpg2ReliableUdpFragmentStream::Send(const Frpg2ReliableUdpFragment& Fragment)
 {
-    std::vector<uint8_t> Payload = Fragment.Payload;
-    bool bCompressed = (Fragment.Payload.size() >= MIN_SIZE_FOR_COMPRESSION);
-    uint32_t UncompressedSize = (uint32_t)Payload.size();
-
-    if (bCompressed)
-    {        
-        std::vector<uint8_t> UncompressPayload = Payload;
-        if (!Compress(UncompressPayload, Payload))
-        {
-            WarningS(Connection->GetName().c_str(), "Failed to compress packet data.");
-            InErrorState = true;
-            return false;
-        }
+    // Already compressed or too small to be worth it, can be fragmented as-is.
+    if (Fragment.Header.compress_flag || Fragment.Payload.size() < MIN_SIZE_FOR_COMPRESSION)
+    {
+        return SendFragmented(Fragment);
     }
 
+    Frpg2ReliableUdpFragment CompressedFragment;
+    CompressedFragment.AckSequenceIndex = Fragment.AckSequenceIndex;
+    CompressedFragment.Disassembly = Fragment.Disassembly;
+
+    if (!PreparePayload(Fragment.Payload, CompressedFragment))
+    {
+        WarningS(Connection->GetName().c_str(), "Failed to compress packet data.");
+        InErrorState = true;
+        return false;
+    }
+
+    return SendFragmented(CompressedFragment);
+}
+
+bool Frpg2ReliableUdpFragmentStream::SendFragmented(const Frpg2ReliableUdpFragment& Fragment)
+{
+    const std::vector<uint8_t>& Payload = Fragment.Payload;
+    bool bCompressed = Fragment.Header.compress_flag;
+    uint32_t UncompressedSize = Fragment.PayloadDecompressedLength;
+
     size_t FragmentCount = (Payload.size() + (MAX_FRAGMENT_LENGTH - 1)) / MAX_FRAGMENT_LENGTH;
 
     // Fragment up if payload is larger than max payload size.
@@ -53,19 +79,17 @@ bool Frpg2ReliableUdpFragmentStream::Send(const Frpg2ReliableUdpFragment& Fragme
         int BytesRemaining = (int)Payload.size() - FragmentOffset;
         int FragmentLength = std::min(MAX_FRAGMENT_LENGTH, BytesRemaining);
 
-        Frpg2ReliableUdpFragment SendFragment;
-        SendFragment.Header.compress_flag = bCompressed;
-        SendFragment.Header.fragment_index = (uint8_t)i;
-        SendFragment.Header.fragment_length = FragmentLength;
-        SendFragment.Header.total_payload_length = (uint16_t)Payload.size();
-        SendFragment.Header.packet_counter = SentFragmentCounter;
-        SendFragment.PayloadDecompressedLength = UncompressedSize;
-        SendFragment.Payload.resize(FragmentLength);
-
-        memcpy(SendFragment.Payload.data(), Payload.data() + FragmentOffset, FragmentLength);
+        Frpg2ReliableUdpFragmentHeader FragmentHeader;
+        FragmentHeader.compress_flag = bCompressed;
+        FragmentHeader.fragment_index = (uint8_t)i;
+        FragmentHeader.fragment_length = FragmentLength;
+        FragmentHeader.total_payload_length = (uint16_t)Payload.size();
+        FragmentHeader.packet_counter = SentFragmentCounter;
 
+        // Encode straight from the slice of the payload into the packet, rather than copying
+        // it out into its own fragment first.
         Frpg2ReliableUdpPacket SendPacket;
-        if (!EncodeFragment(SendFragment, SendPacket))
+        if (!EncodeFragment(FragmentHeader, UncompressedSize, Payload.data() + FragmentOffset, FragmentLength, SendPacket))
         {
             WarningS(Connection->GetName().c_str(), "Failed to encode fragment to packet.");
             InErrorState = true;
@@ -83,6 +107,11 @@ bool Frpg2ReliableUdpFragmentStream::Send(const Frpg2ReliableUdpFragment& Fragme
         // Disassemble if required.
         if constexpr (BuildConfig::DISASSEMBLE_SENT_MESSAGES)
         {
+            Frpg2ReliableUdpFragment SendFragment;
+            SendFragment.Header = FragmentHeader;
+            SendFragment.PayloadDecompressedLength = UncompressedSize;
+            SendFragment.Payload.assign(Payload.data() + FragmentOffset, Payload.data() + FragmentOffset + FragmentLength);
+
             SendPacket.Disassembly = Fragment.Disassembly;
             SendPacket.Disassembly.append(Disassemble(SendFragment));
         }
@@ -170,30 +199,32 @@ bool Frpg2ReliableUdpFragmentStream::DecodeFragment(const Frpg2ReliableUdpPacket
     return true;
 }
 
-bool Frpg2ReliableUdpFragmentStream::EncodeFragment(const Frpg2ReliableUdpFragment& Fragment, Frpg2ReliableUdpPacket& Packet)
+bool Frpg2ReliableUdpFragmentStream::EncodeFragment(const Frpg2ReliableUdpFragmentHeader& Header, uint32_t PayloadDecompressedLength, const uint8_t* Payload, size_t PayloadLength, Frpg2ReliableUdpPacket& Packet)
 {
-    Frpg2ReliableUdpFragment ByteSwappedFragment = Fragment;
-    ByteSwappedFragment.Header.SwapEndian();
-    ByteSwappedFragment.PayloadDecompressedLength = HostOrderToBigEndian(ByteSwappedFragment.PayloadDecompressedLength);
+    Frpg2ReliableUdpFragmentHeader ByteSwappedHeader = Header;
+    ByteSwappedHeader.SwapEndian();
+    uint32_t ByteSwappedDecompressedLength = HostOrderToBigEndian(PayloadDecompressedLength);
+
+    bool bHasDecompressedLength = (Header.compress_flag && Header.fragment_index == 0);
 
-    size_t PayloadSize = sizeof(Frpg2ReliableUdpFragmentHeader) + ByteSwappedFragment.Payload.size();
-    if (ByteSwappedFragment.Header.compress_flag && ByteSwappedFragment.Header.fragment_index == 0)
+    size_t PayloadSize = sizeof(Frpg2ReliableUdpFragmentHeader) + PayloadLength;
+    if (bHasDecompressedLength)
     {
         PayloadSize += 4;
     }
 
     Packet.Payload.resize(PayloadSize);
 
-    memcpy(Packet.Payload.data(), &ByteSwappedFragment.Header, sizeof(Frpg2ReliableUdpFragmentHeader));
+    memcpy(Packet.Payload.data(), &ByteSwappedHeader, sizeof(Frpg2ReliableUdpFragmentHeader));
 
     size_t WriteOffset = sizeof(Frpg2ReliableUdpFragmentHeader);
-    if (ByteSwappedFragment.Header.compress_flag && ByteSwappedFragment.Header.fragment_index == 0)
+    if (bHasDecompressedLength)
     {
-        memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedFragment.PayloadDecompressedLength, 4);
+        memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedDecompressedLength, 4);
         WriteOffset += 4;
     }
 
-    memcpy(Packet.Payload.data() + WriteOffset, ByteSwappedFragment.Payload.data(), ByteSwappedFragment.Payload.size());
+    memcpy(Packet.Payload.data() + WriteOffset, Payload, PayloadLength);
 
     return true;
 }
@@ -207,6 +238,11 @@ void Frpg2ReliableUdpFragmentStream::Reset()
     RecievedFragmentLength = 0;
 }
 
+bool Frpg2ReliableUdpFragmentStream::HasPendingWork()
+{
+    return RecieveQueue.size() > 0 || Frpg2ReliableUdpPacketStream::HasPendingWork();
+}
+
 bool Frpg2ReliableUdpFragmentStream::Pump()
 {
     if (Frpg2ReliableUdpPacketStream::Pump())
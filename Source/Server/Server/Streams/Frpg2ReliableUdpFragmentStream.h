@@ -25,12 +25,19 @@ public:
     // is likely saturated or the packet is invalid.
     virtual bool Send(const Frpg2ReliableUdpFragment& Fragment);
 
+    // Fills in the fragment with the given payload, compressing it if its large enough to be worth it.
+    // This doesn't depend on any stream state, so the result can be passed to Send on multiple streams
+    // without the payload being compressed again for each of them.
+    static bool PreparePayload(const std::vector<uint8_t>& Payload, Frpg2ReliableUdpFragment& Output);
+
     // Returns true if a packet was recieved and stores packet in OutputPacket.
     virtual bool Recieve(Frpg2ReliableUdpFragment* Fragment);
 
     // Overridden so we can do package retransmission/general management.
     virtual bool Pump() override;
 
+    virtual bool HasPendingWork() override;
+
     // Diassembles a messages into a human-readable string.
     std::string Disassemble(const Frpg2ReliableUdpFragment& Packet);
 
@@ -38,8 +45,13 @@ protected:
 
     virtual bool RecieveInternal(Frpg2ReliableUdpFragment* Fragment);
 
+    // Splits an already compressed (if required) fragment up and sends each part.
+    bool SendFragmented(const Frpg2ReliableUdpFragment& Fragment);
+
     bool DecodeFragment(const Frpg2ReliableUdpPacket& Packet, Frpg2ReliableUdpFragment& Fragment);
-    bool EncodeFragment(const Frpg2ReliableUdpFragment& Fragment, Frpg2ReliableUdpPacket& Packet);
+
+    // Writes the header followed by PayloadLength bytes of Payload into the packet.
+    bool EncodeFragment(const Frpg2ReliableUdpFragmentHeader& Header, uint32_t PayloadDecompressedLength, const uint8_t* Payload, size_t PayloadLength, Frpg2ReliableUdpPacket& Packet);
 
     virtual void Reset() override;
 
@@ -54,7 +66,7 @@ private:
 
     // Includes header + compressed payload.
     // The main game seems to allow up to 1024, so we can boost this a bit if needed.
-    const int MAX_FRAGMENT_LENGTH = 900;
-    const int MIN_SIZE_FOR_COMPRESSION = 512;
+    inline static const int MAX_FRAGMENT_LENGTH = 900;
+    inline static const int MIN_SIZE_FOR_COMPRESSION = 512;
 
 };
\ No newline at end of file
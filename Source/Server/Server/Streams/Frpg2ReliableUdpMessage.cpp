@@ -9,93 +9,169 @@
 
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 
-bool Protobuf_To_ReliableUdpMessageType(google::protobuf::MessageLite* Message, Frpg2ReliableUdpMessageType& Output)
+#include <typeindex>
+#include <unordered_map>
+
+namespace 
 {
-#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass) \
-    if (dynamic_cast<Frpg2RequestMessage::ProtobufClass*>(Message) != nullptr)      \
-    {                                                                               \
-        Output = Frpg2ReliableUdpMessageType::Type;                                 \
-        return true;                                                                \
-    }                                                                               
-#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                 \
-    if (dynamic_cast<Frpg2RequestMessage::ProtobufClass*>(Message) != nullptr)      \
-    {                                                                               \
-        Output = Frpg2ReliableUdpMessageType::Type;                                 \
-        return true;                                                                \
-    }                                                                               
-#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                            \
-    if (dynamic_cast<Frpg2RequestMessage::ProtobufClass*>(Message) != nullptr)      \
-    {                                                                               \
-        Output = Frpg2ReliableUdpMessageType::Push; /* Not using push */            \
-        return true;                                                                \
-    }    
+    // Maps the dynamic type of each protobuf class we can send to its message type.
+    std::unordered_map<std::type_index, Frpg2ReliableUdpMessageType> BuildProtobufTypeMap()
+    {
+        std::unordered_map<std::type_index, Frpg2ReliableUdpMessageType> Result;
+
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         Result.emplace(typeid(Frpg2RequestMessage::ProtobufClass), Frpg2ReliableUdpMessageType::Type);
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         Result.emplace(typeid(Frpg2RequestMessage::ProtobufClass), Frpg2ReliableUdpMessageType::Type);
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    Result.emplace(typeid(Frpg2RequestMessage::ProtobufClass), Frpg2ReliableUdpMessageType::Push); /* Not using push */
 #include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
 #undef DEFINE_PUSH_MESSAGE
 #undef DEFINE_MESSAGE
 #undef DEFINE_REQUEST_RESPONSE
 
+        return Result;
+    }
+};
+
+bool Protobuf_To_ReliableUdpMessageType(google::protobuf::MessageLite* Message, Frpg2ReliableUdpMessageType& Output)
+{
+    static const std::unordered_map<std::type_index, Frpg2ReliableUdpMessageType> ProtobufTypeMap = BuildProtobufTypeMap();
+
+    if (Message == nullptr)
+    {
+        return false;
+    }
+
+    if (auto Iter = ProtobufTypeMap.find(typeid(*Message)); Iter != ProtobufTypeMap.end())
+    {
+        Output = Iter->second;
+        return true;
+    }
+
     return false;
 }
 
 bool ReliableUdpMessageType_To_Protobuf(Frpg2ReliableUdpMessageType InType, bool IsResponse, std::shared_ptr<google::protobuf::MessageLite>& Output)
 {
+    switch (InType)
+    {
 #define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)                     \
-    if (InType == Frpg2ReliableUdpMessageType::Type)                                                      \
-    {                                                                                                   \
-        if (IsResponse)                                                                                 \
+    case Frpg2ReliableUdpMessageType::Type:                                                             \
         {                                                                                               \
-            Output = std::make_shared<Frpg2RequestMessage::ResponseProtobufClass>();                    \
-        }                                                                                               \
-        else                                                                                            \
+            if (IsResponse)                                                                             \
+            {                                                                                           \
+                Output = std::make_shared<Frpg2RequestMessage::ResponseProtobufClass>();                \
+            }                                                                                           \
+            else                                                                                        \
+            {                                                                                           \
+                Output = std::make_shared<Frpg2RequestMessage::ProtobufClass>();                        \
+            }                                                                                           \
+            return true;                                                                                \
+        }
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                                     \
+    case Frpg2ReliableUdpMessageType::Type:                                                             \
         {                                                                                               \
+            if (IsResponse)                                                                             \
+            {                                                                                           \
+                return false;                                                                           \
+            }                                                                                           \
             Output = std::make_shared<Frpg2RequestMessage::ProtobufClass>();                            \
-        }                                                                                               \
-        return true;                                                                                    \
+            return true;                                                                                \
+        }
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                                /* Not supported on server, server only sends these */
+#include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
+#undef DEFINE_PUSH_MESSAGE
+#undef DEFINE_MESSAGE
+#undef DEFINE_REQUEST_RESPONSE
     }
-#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                                     \
-    if (InType == Frpg2ReliableUdpMessageType::Type)                                                      \
-    {                                                                                                   \
-        if (IsResponse)                                                                                 \
+
+    return false;
+}
+
+bool ReliableUdpMessageType_To_ProtobufType(Frpg2ReliableUdpMessageType InType, bool IsResponse, const std::type_info*& Output)
+{
+    switch (InType)
+    {
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)                     \
+    case Frpg2ReliableUdpMessageType::Type:                                                             \
         {                                                                                               \
-            return false;                                                                               \
-        }                                                                                               \
-        else                                                                                            \
+            Output = IsResponse ? &typeid(Frpg2RequestMessage::ResponseProtobufClass)                   \
+                                : &typeid(Frpg2RequestMessage::ProtobufClass);                          \
+            return true;                                                                                \
+        }
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                                     \
+    case Frpg2ReliableUdpMessageType::Type:                                                             \
         {                                                                                               \
-            Output = std::make_shared<Frpg2RequestMessage::ProtobufClass>();                            \
+            if (IsResponse)                                                                             \
+            {                                                                                           \
+                return false;                                                                           \
+            }                                                                                           \
+            Output = &typeid(Frpg2RequestMessage::ProtobufClass);                                       \
             return true;                                                                                \
-        }                                                                                               \
-    }
+        }
 #define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                                /* Not supported on server, server only sends these */
 #include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
 #undef DEFINE_PUSH_MESSAGE
 #undef DEFINE_MESSAGE
 #undef DEFINE_REQUEST_RESPONSE
+    }
 
     return false;
 }
 
 bool ReliableUdpMessageType_Expects_Response(Frpg2ReliableUdpMessageType InType)
 {
-    if (InType == Frpg2ReliableUdpMessageType::Push)                                        
-    {                                                                                       
-        return false;                                                                       
+    switch (InType)
+    {
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         case Frpg2ReliableUdpMessageType::Type: return true;
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         case Frpg2ReliableUdpMessageType::Type: return false;
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    /* Not required, all push messages use the Push type */
+#include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
+#undef DEFINE_PUSH_MESSAGE
+#undef DEFINE_MESSAGE
+#undef DEFINE_REQUEST_RESPONSE
     }
 
+    return false;
+}
+
+bool ReliableUdpMessageType_To_Index(Frpg2ReliableUdpMessageType InType, Frpg2ReliableUdpMessageTypeIndex& Output)
+{
+    // Switch rather than an if-chain so the compiler can turn it into a jump table.
+    switch (InType)
+    {
 #define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         \
-    if (InType == Frpg2ReliableUdpMessageType::Type)                                        \
-    {                                                                                       \
-        return true;                                                                        \
-    }
+    case Frpg2ReliableUdpMessageType::Type:                                                 \
+        {                                                                                   \
+            Output = Frpg2ReliableUdpMessageTypeIndex::Type;                                \
+            return true;                                                                    \
+        }
 #define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         \
-    if (InType == Frpg2ReliableUdpMessageType::Type)                                        \
-    {                                                                                       \
-        return false;                                                                       \
-    }
-#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    /* Not required, gets caught by Push test above */
+    case Frpg2ReliableUdpMessageType::Type:                                                 \
+        {                                                                                   \
+            Output = Frpg2ReliableUdpMessageTypeIndex::Type;                                \
+            return true;                                                                    \
+        }
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    /* Not indexed, server only sends these */
 #include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
 #undef DEFINE_PUSH_MESSAGE
 #undef DEFINE_MESSAGE
 #undef DEFINE_REQUEST_RESPONSE
+    }
 
     return false;
 }
+
+const char* ReliableUdpMessageTypeIndex_To_String(Frpg2ReliableUdpMessageTypeIndex Index)
+{
+    switch (Index)
+    {
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         case Frpg2ReliableUdpMessageTypeIndex::Type: return #Type;
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         case Frpg2ReliableUdpMessageTypeIndex::Type: return #Type;
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    /* Not indexed */
+#include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
+#undef DEFINE_PUSH_MESSAGE
+#undef DEFINE_MESSAGE
+#undef DEFINE_REQUEST_RESPONSE
+    }
+
+    return "Unknown";
+}
@@ -13,6 +13,7 @@
 
 #include <vector>
 #include <memory>
+#include <typeinfo>
 
 #include "Protobuf/Protobufs.h"
 
@@ -31,6 +32,21 @@ enum class Frpg2ReliableUdpMessageType
 #undef DEFINE_REQUEST_RESPONSE
 };
 
+// Dense zero-based index of all the message types we can recieve, used to index
+// per-type tables (handlers, counters, etc) directly rather than searching.
+enum class Frpg2ReliableUdpMessageTypeIndex
+{
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         Type,
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         Type,
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    /* Do Nothing */
+#include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
+#undef DEFINE_PUSH_MESSAGE
+#undef DEFINE_MESSAGE
+#undef DEFINE_REQUEST_RESPONSE
+
+    Count
+};
+
 #pragma pack(push, 1)
 struct Frpg2ReliableUdpMessageHeader
 {
@@ -86,3 +102,9 @@ public:
 bool Protobuf_To_ReliableUdpMessageType(google::protobuf::MessageLite* Message, Frpg2ReliableUdpMessageType& Output);
 bool ReliableUdpMessageType_To_Protobuf(Frpg2ReliableUdpMessageType Type, bool IsResponse, std::shared_ptr<google::protobuf::MessageLite>& Output);
 bool ReliableUdpMessageType_Expects_Response(Frpg2ReliableUdpMessageType Type);
+
+// Gets the protobuf class ReliableUdpMessageType_To_Protobuf would create, without creating one.
+bool ReliableUdpMessageType_To_ProtobufType(Frpg2ReliableUdpMessageType Type, bool IsResponse, const std::type_info*& Output);
+
+bool ReliableUdpMessageType_To_Index(Frpg2ReliableUdpMessageType Type, Frpg2ReliableUdpMessageTypeIndex& Output);
+const char* ReliableUdpMessageTypeIndex_To_String(Frpg2ReliableUdpMessageTypeIndex Index);
@@ -29,42 +29,40 @@ Frpg2ReliableUdpMessageStream::Frpg2ReliableUdpMessageStream(std::shared_ptr<Net
 {
 }
 
-bool Frpg2ReliableUdpMessageStream::SendInternal(const Frpg2ReliableUdpMessage& Message, const Frpg2ReliableUdpMessage* ResponseTo)
+void Frpg2ReliableUdpMessageStream::AssignMessageIndex(Frpg2ReliableUdpMessageHeader& Header, const Frpg2ReliableUdpMessage* ResponseTo)
 {
-    Frpg2ReliableUdpMessage SendMessage = Message;
-    if (SendMessage.Header.msg_type == Frpg2ReliableUdpMessageType::Push)
+    if (Header.msg_type == Frpg2ReliableUdpMessageType::Push)
     {
-        SendMessage.Header.msg_index = 0xFFFFFFFF;
+        Header.msg_index = 0xFFFFFFFF;
 
         Debug::PushMessagesSent.Add(1);
     }
     else if (ResponseTo != nullptr)
     {
-        SendMessage.Header.msg_index = ResponseTo->Header.msg_index;
-        SendMessage.Header.msg_type = Frpg2ReliableUdpMessageType::Reply;
+        Header.msg_index = ResponseTo->Header.msg_index;
+        Header.msg_type = Frpg2ReliableUdpMessageType::Reply;
 
         Debug::ResponsesSent.Add(1);
     }
     else
     {
-        SendMessage.Header.msg_index = SentMessageCounter++;
-        LastSentMessageIndex = SendMessage.Header.msg_index;
+        Header.msg_index = SentMessageCounter++;
+        LastSentMessageIndex = Header.msg_index;
 
         Debug::ResponsesSent.Add(1);
     }
+}
 
-    Frpg2ReliableUdpFragment Packet;
-    if (!EncodeMessage(SendMessage, Packet))
-    {
-        WarningS(Connection->GetName().c_str(), "Failed to convert message to packet.");
-        InErrorState = true;
-        return false;
-    }
-
+bool Frpg2ReliableUdpMessageStream::SendInternal(Frpg2ReliableUdpFragment& Packet, const Frpg2ReliableUdpMessageHeader& Header, const Frpg2ReliableUdpMessage* ResponseTo)
+{
     // Disassemble if required.
     if constexpr (BuildConfig::DISASSEMBLE_SENT_MESSAGES)
     {
-        Packet.Disassembly = Disassemble(SendMessage);
+        Frpg2ReliableUdpMessage SendMessage;
+        if (DecodeMessage(Packet, SendMessage))
+        {
+            Packet.Disassembly = Disassemble(SendMessage);
+        }
     }
 
     // TODO: Remove when we have a better way to handle this without breaking abstraction.
@@ -78,11 +76,11 @@ bool Frpg2ReliableUdpMessageStream::SendInternal(const Frpg2ReliableUdpMessage&
         return false;
     }
 
-    if (SendMessage.Header.msg_type != Frpg2ReliableUdpMessageType::Reply)
+    if (Header.msg_type != Frpg2ReliableUdpMessageType::Reply)
     {
-        if (ReliableUdpMessageType_Expects_Response(SendMessage.Header.msg_type))
+        if (ReliableUdpMessageType_Expects_Response(Header.msg_type))
         {
-            OutstandingResponses.insert({ SendMessage.Header.msg_index, SendMessage.Header.msg_type });
+            OutstandingResponses.insert({ Header.msg_index, Header.msg_type });
         }
     }
 
@@ -91,64 +89,83 @@ bool Frpg2ReliableUdpMessageStream::SendInternal(const Frpg2ReliableUdpMessage&
 
 bool Frpg2ReliableUdpMessageStream::Send(google::protobuf::MessageLite* Message, const Frpg2ReliableUdpMessage* ResponseTo)
 {
-    Frpg2ReliableUdpMessage ResponseMessage;
-    ResponseMessage.Payload.resize(Message->ByteSize());
-
+    Frpg2ReliableUdpMessageHeader Header;
     if (ResponseTo == nullptr)
     {
-        if (!Protobuf_To_ReliableUdpMessageType(Message, ResponseMessage.Header.msg_type))
+        if (!Protobuf_To_ReliableUdpMessageType(Message, Header.msg_type))
         {
             WarningS(Connection->GetName().c_str(), "Failed to determine message type by protobuf.");
             InErrorState = true;
             return false;
         }
     }
-    else
-    {
-        // TODO: Remove when we have a better way to handle this without breaking abstraction.
-        ResponseMessage.AckSequenceIndex = ResponseTo->AckSequenceIndex;
-    }
 
-    if (!Message->SerializeToArray(ResponseMessage.Payload.data(), (int)ResponseMessage.Payload.size()))
-    {
-        WarningS(Connection->GetName().c_str(), "Failed to serialize protobuf payload.");
-        InErrorState = true;
-        return false;
-    }
+    AssignMessageIndex(Header, ResponseTo);
 
-    if (!SendInternal(ResponseMessage, ResponseTo))
-    {
-        return true;
-    }
+    // Serialize straight into the buffer that is passed down to the fragment stream, after 
+    // the space reserved for the message headers, rather than into an intermediate payload.
+    Frpg2ReliableUdpFragment Packet;
+    size_t PayloadOffset = EncodeMessageHeader(Header, (size_t)Message->ByteSize(), Packet);
+    Message->SerializeWithCachedSizesToArray(Packet.Payload.data() + PayloadOffset);
 
-    return true;
+    return SendInternal(Packet, Header, ResponseTo);
 }
 
 bool Frpg2ReliableUdpMessageStream::SendRawProtobuf(const std::vector<uint8_t>& Data, const Frpg2ReliableUdpMessage* ResponseTo)
 {
-    Frpg2ReliableUdpMessage ResponseMessage;
-    ResponseMessage.Payload = Data;
-
+    Frpg2ReliableUdpMessageHeader Header;
     if (ResponseTo == nullptr)
     {
-        ResponseMessage.Header.msg_type = Frpg2ReliableUdpMessageType::Push;
+        Header.msg_type = Frpg2ReliableUdpMessageType::Push;
     }
-    else
+
+    AssignMessageIndex(Header, ResponseTo);
+
+    Frpg2ReliableUdpFragment Packet;
+    size_t PayloadOffset = EncodeMessageHeader(Header, Data.size(), Packet);
+    memcpy(Packet.Payload.data() + PayloadOffset, Data.data(), Data.size());
+
+    return SendInternal(Packet, Header, ResponseTo);
+}
+
+bool Frpg2ReliableUdpMessageStream::PreparePush(google::protobuf::MessageLite* Message, Frpg2ReliableUdpFragment& Output)
+{
+    // Only push messages can be prepared, everything else has a per-stream message index.
+    Frpg2ReliableUdpMessageHeader Header;
+    if (!Protobuf_To_ReliableUdpMessageType(Message, Header.msg_type) || Header.msg_type != Frpg2ReliableUdpMessageType::Push)
     {
-        // TODO: Remove when we have a better way to handle this without breaking abstraction.
-        ResponseMessage.AckSequenceIndex = ResponseTo->AckSequenceIndex;
+        Warning("Failed to prepare push message, protobuf is not a push message type.");
+        return false;
     }
 
-    if (!SendInternal(ResponseMessage, ResponseTo))
+    Header.msg_index = 0xFFFFFFFF;
+
+    Frpg2ReliableUdpFragment Uncompressed;
+    size_t PayloadOffset = EncodeMessageHeader(Header, (size_t)Message->ByteSize(), Uncompressed);
+    Message->SerializeWithCachedSizesToArray(Uncompressed.Payload.data() + PayloadOffset);
+
+    if (!Frpg2ReliableUdpFragmentStream::PreparePayload(Uncompressed.Payload, Output))
     {
-        return true;
+        Warning("Failed to compress push message.");
+        return false;
     }
 
     return true;
 }
 
+bool Frpg2ReliableUdpMessageStream::SendPreparedPush(const Frpg2ReliableUdpFragment& Prepared)
+{
+    Debug::PushMessagesSent.Add(1);
+
+    return Frpg2ReliableUdpFragmentStream::Send(Prepared);
+}
+
 bool Frpg2ReliableUdpMessageStream::Recieve(Frpg2ReliableUdpMessage* Message)
 {
+    // Callers reuse the same message for each one they recieve, so by now whatever 
+    // handled the last one is done with its protobuf.
+    ReleaseProtobuf(Message->Protobuf);
+
     Frpg2ReliableUdpFragment Packet;
     if (!Frpg2ReliableUdpFragmentStream::Recieve(&Packet))
     {
@@ -197,7 +214,7 @@ bool Frpg2ReliableUdpMessageStream::Recieve(Frpg2ReliableUdpMessage* Message)
         IsResponse = true;
     }
 
-    if (!ReliableUdpMessageType_To_Protobuf(MessageType, IsResponse, Message->Protobuf))
+    if (!AcquireProtobuf(MessageType, IsResponse, Message->Protobuf))
     {
         WarningS(Connection->GetName().c_str(), "Failed to create protobuf instance for message: type=0x%08x index=0x%08x", MessageType, Message->Header.msg_index);
 
@@ -230,6 +247,41 @@ bool Frpg2ReliableUdpMessageStream::Recieve(Frpg2ReliableUdpMessage* Message)
     return true;
 }
 
+bool Frpg2ReliableUdpMessageStream::AcquireProtobuf(Frpg2ReliableUdpMessageType Type, bool IsResponse, std::shared_ptr<google::protobuf::MessageLite>& Output)
+{
+    const std::type_info* ProtobufType = nullptr;
+    if (!ReliableUdpMessageType_To_ProtobufType(Type, IsResponse, ProtobufType))
+    {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<google::protobuf::MessageLite>>& FreeList = FreeProtobufs[*ProtobufType];
+    if (!FreeList.empty())
+    {
+        Output = std::move(FreeList.back());
+        FreeList.pop_back();
+        Output->Clear();
+        return true;
+    }
+
+    if (!ReliableUdpMessageType_To_Protobuf(Type, IsResponse, Output))
+    {
+        return false;
+    }
+
+    Debug::ProtobufAllocations.Add(1);
+    return true;
+}
+
+void Frpg2ReliableUdpMessageStream::ReleaseProtobuf(std::shared_ptr<google::protobuf::MessageLite>& Protobuf)
+{
+    if (Protobuf && Protobuf.use_count() == 1)
+    {
+        FreeProtobufs[typeid(*Protobuf)].push_back(std::move(Protobuf));
+    }
+    Protobuf.reset();
+}
+
 bool Frpg2ReliableUdpMessageStream::DecodeMessage(const Frpg2ReliableUdpFragment& Packet, Frpg2ReliableUdpMessage& Message)
 {
     if (Packet.Payload.size() < sizeof(Frpg2ReliableUdpMessageHeader))
@@ -258,33 +310,33 @@ bool Frpg2ReliableUdpMessageStream::DecodeMessage(const Frpg2ReliableUdpFragment
     return true;
 }
 
-bool Frpg2ReliableUdpMessageStream::EncodeMessage(const Frpg2ReliableUdpMessage& Message, Frpg2ReliableUdpFragment& Packet)
+size_t Frpg2ReliableUdpMessageStream::EncodeMessageHeader(const Frpg2ReliableUdpMessageHeader& Header, size_t PayloadSize, Frpg2ReliableUdpFragment& Packet)
 {
-    Frpg2ReliableUdpMessage ByteSwappedMessage = Message;
-    ByteSwappedMessage.Header.SwapEndian();
-    ByteSwappedMessage.ResponseHeader.SwapEndian();
+    Frpg2ReliableUdpMessageHeader ByteSwappedHeader = Header;
+    ByteSwappedHeader.SwapEndian();
 
-    size_t PayloadSize = sizeof(Frpg2ReliableUdpMessageHeader) + ByteSwappedMessage.Payload.size();
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::Reply)
+    Frpg2ReliableUdpMessageResponseHeader ByteSwappedResponseHeader;
+    ByteSwappedResponseHeader.SwapEndian();
+
+    size_t HeaderSize = sizeof(Frpg2ReliableUdpMessageHeader);
+    if (Header.msg_type == Frpg2ReliableUdpMessageType::Reply)
     {
-        PayloadSize += sizeof(Frpg2ReliableUdpMessageResponseHeader);
+        HeaderSize += sizeof(Frpg2ReliableUdpMessageResponseHeader);
     }
 
-    Packet.Payload.resize(PayloadSize);
+    Packet.Payload.resize(HeaderSize + PayloadSize);
 
     int WriteOffset = 0;
-    memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedMessage.Header, sizeof(Frpg2ReliableUdpMessageHeader));
+    memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedHeader, sizeof(Frpg2ReliableUdpMessageHeader));
     WriteOffset += sizeof(Frpg2ReliableUdpMessageHeader);
 
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::Reply)
+    if (Header.msg_type == Frpg2ReliableUdpMessageType::Reply)
     {
-        memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedMessage.ResponseHeader, sizeof(Frpg2ReliableUdpMessageResponseHeader));
+        memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedResponseHeader, sizeof(Frpg2ReliableUdpMessageResponseHeader));
         WriteOffset += sizeof(Frpg2ReliableUdpMessageResponseHeader);
     }
 
-    memcpy(Packet.Payload.data() + WriteOffset, ByteSwappedMessage.Payload.data(), ByteSwappedMessage.Payload.size());
-
-    return true;
+    return HeaderSize;
 }
 
 void Frpg2ReliableUdpMessageStream::Reset()
@@ -15,6 +15,7 @@
 #include "Protobuf/Protobufs.h"
 
 #include <unordered_map>
+#include <typeindex>
 
 class Cipher;
 
@@ -30,6 +31,13 @@ public:
     // If we have a protobuf thats already serialized we can send it via this. Code assumes it should be sent with Push message type.
     virtual bool SendRawProtobuf(const std::vector<uint8_t>& Data, const Frpg2ReliableUdpMessage* ResponseTo = nullptr);
 
+    // Serializes and compresses a push message ahead of time, so the same message can be sent to 
+    // many clients with SendPreparedPush without repeating that work for each of them.
+    static bool PreparePush(google::protobuf::MessageLite* Message, Frpg2ReliableUdpFragment& Output);
+
+    // Sends a push message previously prepared with PreparePush.
+    virtual bool SendPreparedPush(const Frpg2ReliableUdpFragment& Prepared);
+
     // Returns true if a packet was recieved and stores packet in OutputPacket.
     virtual bool Recieve(Frpg2ReliableUdpMessage* Message);
 
@@ -43,12 +51,25 @@ public:
 
 protected:
 
+    // Fills in the message index (and type for replies) of a message about to be sent.
+    void AssignMessageIndex(Frpg2ReliableUdpMessageHeader& Header, const Frpg2ReliableUdpMessage* ResponseTo);
+
     // Returns true if send was successful, if false is returned the send queue
-    // is likely saturated or the packet is invalid.
-    virtual bool SendInternal(const Frpg2ReliableUdpMessage& Message, const Frpg2ReliableUdpMessage* ResponseTo = nullptr);
+    // is likely saturated or the packet is invalid. Packet should already contain the encoded message.
+    virtual bool SendInternal(Frpg2ReliableUdpFragment& Packet, const Frpg2ReliableUdpMessageHeader& Header, const Frpg2ReliableUdpMessage* ResponseTo = nullptr);
 
     bool DecodeMessage(const Frpg2ReliableUdpFragment& Packet, Frpg2ReliableUdpMessage& Message);
-    bool EncodeMessage(const Frpg2ReliableUdpMessage& Message, Frpg2ReliableUdpFragment& Packet);
+
+    // Gets a cleared protobuf to decode a recieved message into, reusing one from the free list if possible.
+    bool AcquireProtobuf(Frpg2ReliableUdpMessageType Type, bool IsResponse, std::shared_ptr<google::protobuf::MessageLite>& Output);
+
+    // Puts a recieved messages protobuf back on the free list, unless something else (a handler 
+    // that's still waiting on a query, etc) is holding on to it. Either way Protobuf is reset.
+    void ReleaseProtobuf(std::shared_ptr<google::protobuf::MessageLite>& Protobuf);
+
+    // Writes the message headers to the start of the packets payload and sizes it to fit PayloadSize bytes 
+    // of protobuf after them. Returns the offset the protobuf should be written to.
+    static size_t EncodeMessageHeader(const Frpg2ReliableUdpMessageHeader& Header, size_t PayloadSize, Frpg2ReliableUdpFragment& Packet);
 
     virtual void Reset() override;
 
@@ -62,6 +83,11 @@ private:
 
     std::unordered_map<uint32_t, Frpg2ReliableUdpMessageType> OutstandingResponses;
 
+    // Protobufs previously used to decode recieved messages, by class. Only this stream touches
+    // them so there's no locking, and each list only grows to the most messages of that type 
+    // that were in use at once.
+    std::unordered_map<std::type_index, std::vector<std::shared_ptr<google::protobuf::MessageLite>>> FreeProtobufs;
+
     uint32_t SentMessageCounter = 0;
 
     uint32_t LastSentMessageIndex = 0;
@@ -824,6 +824,16 @@ bool Frpg2ReliableUdpPacketStream::Pump()
     return false;
 }
 
+bool Frpg2ReliableUdpPacketStream::HasPendingWork()
+{
+    return InErrorState ||
+           State != Frpg2ReliableUdpStreamState::Established ||
+           SendQueue.size() > 0 ||
+           RetransmitBuffer.size() > 0 ||
+           PendingRecieveQueue.size() > 0 ||
+           RecieveQueue.size() > 0;
+}
+
 void Frpg2ReliableUdpPacketStream::EmitDebugInfo(bool Incoming, const Frpg2ReliableUdpPacket& Packet)
 {
     uint32_t Local, Remote;
@@ -44,6 +44,11 @@ public:
     // Overridden so we can do package retransmission/general management.
     virtual bool Pump() override;
 
+    // Returns true if the stream has anything to do on its next pump besides
+    // recieve new data; queued or unacknowledged packets, handshakes, etc.
+    // Streams without pending work only need pumping when data arrives.
+    virtual bool HasPendingWork();
+
     // Gets the current connection state of this message stream.
     Frpg2ReliableUdpStreamState GetState() { return State; }
 
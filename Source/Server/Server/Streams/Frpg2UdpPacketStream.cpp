@@ -21,21 +21,25 @@
 
 #include <thread>
 #include <chrono>
+#include <cstring>
 
 Frpg2UdpPacketStream::Frpg2UdpPacketStream(std::shared_ptr<NetConnection> InConnection, const std::vector<uint8_t>& InCwcKey, uint64_t InAuthToken, bool AsClient)
     : Connection(InConnection)
     , CwcKey(InCwcKey)
     , AuthToken(InAuthToken)
 {
+    // Both directions use the same key, so only expand it once.
+    std::shared_ptr<CWCKeySchedule> KeySchedule = std::make_shared<CWCKeySchedule>(InCwcKey);
+
     if (AsClient)
     {
-        EncryptionCipher = std::make_shared<CWCClientUDPCipher>(InCwcKey, AuthToken);
-        DecryptionCipher = std::make_shared<CWCServerUDPCipher>(InCwcKey, AuthToken);
+        EncryptionCipher = std::make_shared<CWCClientUDPCipher>(KeySchedule, AuthToken);
+        DecryptionCipher = std::make_shared<CWCServerUDPCipher>(KeySchedule, AuthToken);
     }
     else
     {
-        EncryptionCipher = std::make_shared<CWCServerUDPCipher>(InCwcKey, AuthToken);
-        DecryptionCipher = std::make_shared<CWCClientUDPCipher>(InCwcKey, AuthToken);
+        EncryptionCipher = std::make_shared<CWCServerUDPCipher>(KeySchedule, AuthToken);
+        DecryptionCipher = std::make_shared<CWCClientUDPCipher>(KeySchedule, AuthToken);
     }
 
     RecieveBuffer.resize(64 * 1024);
@@ -70,18 +74,16 @@ bool Frpg2UdpPacketStream::Pump()
 
             RecieveBuffer.resize(BytesRecieved);
 
-            Frpg2UdpPacket Packet;
-            if (!BytesToPacket(RecieveBuffer, Packet))
-            {
-                WarningS(Connection->GetName().c_str(), "Failed to parse recieved packet.");
-                InErrorState = true;
-                return true;
-            }
+            // Decrypt in place in the recieve buffer, the packet only takes a copy of the plaintext.
+            CipherSpan Span;
+            Span.Buffer = RecieveBuffer.data();
+            Span.Capacity = RecieveBuffer.size();
+            Span.Offset = 0;
+            Span.Length = RecieveBuffer.size();
 
             if (DecryptionCipher)
             {        
-                std::vector<uint8_t> EncryptedBuffer = Packet.Payload;
-                if (!DecryptionCipher->Decrypt(EncryptedBuffer, Packet.Payload))
+                if (!DecryptionCipher->Decrypt(Span))
                 {
                     WarningS(Connection->GetName().c_str(), "Failed to decrypt packet payload.");
                     InErrorState = true;
@@ -89,6 +91,14 @@ bool Frpg2UdpPacketStream::Pump()
                 }
             }
 
+            Frpg2UdpPacket Packet;
+            if (!BytesToPacket(Span.Data(), Span.Length, Packet))
+            {
+                WarningS(Connection->GetName().c_str(), "Failed to parse recieved packet.");
+                InErrorState = true;
+                return true;
+            }
+
            /* static bool dumped = false;
             if (!dumped && Connection->IsConnected())
             {
@@ -109,38 +119,54 @@ bool Frpg2UdpPacketStream::Pump()
 
 bool Frpg2UdpPacketStream::Send(const Frpg2UdpPacket& Packet)
 {
-    Frpg2UdpPacket SendPacket = Packet;
+    // Build the datagram in a reusable buffer, leaving room around the 
+    // payload for the cipher to write its framing into.
+    size_t PrefixSize = EncryptionCipher ? EncryptionCipher->GetPrefixSize() : 0;
+    size_t SuffixSize = EncryptionCipher ? EncryptionCipher->GetSuffixSize() : 0;
 
-    std::vector<uint8_t> DecryptedBuffer = SendPacket.Payload;
-    if (EncryptionCipher)
+    // If batching, the packet is encrypted and sent later by EncryptBatch/FlushBatch.
+    if (BatchSends)
     {
-        if (SendPacket.HasConnectionPrefix)
+        if (BatchedSendCount == 0 && BatchStartedCallback)
         {
-            dynamic_cast<CWCClientUDPCipher*>(EncryptionCipher.get())->SetPacketsHaveConnectionPrefix(true);
+            BatchStartedCallback();
         }
 
-        if (!EncryptionCipher->Encrypt(DecryptedBuffer, SendPacket.Payload))
+        if (BatchedSendCount == BatchedSends.size())
         {
-            WarningS(Connection->GetName().c_str(), "Failed to encrypt packet payload.");
-            InErrorState = true;
-            return false;
+            BatchedSends.emplace_back();
         }
 
-        if (SendPacket.HasConnectionPrefix)
+        BatchedSend& Batched = BatchedSends[BatchedSendCount++];
+        Batched.HasConnectionPrefix = Packet.HasConnectionPrefix;
+        Batched.Encrypted = false;
+
+        if (!PacketToBytes(Packet, PrefixSize, SuffixSize, Batched.Buffer, Batched.Span))
         {
-            dynamic_cast<CWCClientUDPCipher*>(EncryptionCipher.get())->SetPacketsHaveConnectionPrefix(false);
+            WarningS(Connection->GetName().c_str(), "Failed to send packet, unable to serialize.");
+            InErrorState = true;
+            return false;
         }
+
+        return true;
     }
 
-    std::vector<uint8_t> Bytes;
-    if (!PacketToBytes(SendPacket, Bytes))
+    CipherSpan Span;
+    if (!PacketToBytes(Packet, PrefixSize, SuffixSize, SendBuffer, Span))
     {
         WarningS(Connection->GetName().c_str(), "Failed to send packet, unable to serialize.");
         InErrorState = true;
         return false;
     }
 
-    if (!Connection->Send(Bytes, 0, (int)Bytes.size()))
+    if (!EncryptPacket(Span, Packet.HasConnectionPrefix))
+    {
+        WarningS(Connection->GetName().c_str(), "Failed to encrypt packet payload.");
+        InErrorState = true;
+        return false;
+    }
+
+    if (!Connection->Send(SendBuffer, (int)Span.Offset, (int)Span.Length))
     {
         WarningS(Connection->GetName().c_str(), "Failed to send packet.");
         InErrorState = true;
@@ -150,6 +176,65 @@ bool Frpg2UdpPacketStream::Send(const Frpg2UdpPacket& Packet)
     return true;
 }
 
+bool Frpg2UdpPacketStream::EncryptPacket(CipherSpan& Span, bool HasConnectionPrefix)
+{
+    if (!EncryptionCipher)
+    {
+        return true;
+    }
+
+    if (HasConnectionPrefix)
+    {
+        dynamic_cast<CWCClientUDPCipher*>(EncryptionCipher.get())->SetPacketsHaveConnectionPrefix(true);
+    }
+
+    bool Encrypted = EncryptionCipher->Encrypt(Span);
+
+    if (HasConnectionPrefix)
+    {
+        dynamic_cast<CWCClientUDPCipher*>(EncryptionCipher.get())->SetPacketsHaveConnectionPrefix(false);
+    }
+
+    return Encrypted;
+}
+
+void Frpg2UdpPacketStream::EncryptBatch()
+{
+    for (; BatchedEncryptCount < BatchedSendCount; BatchedEncryptCount++)
+    {
+        BatchedSend& Batched = BatchedSends[BatchedEncryptCount];
+        Batched.Encrypted = EncryptPacket(Batched.Span, Batched.HasConnectionPrefix);
+    }
+}
+
+void Frpg2UdpPacketStream::FlushBatch()
+{
+    // Anything queued since the last EncryptBatch still needs doing.
+    EncryptBatch();
+
+    for (size_t i = 0; i < BatchedSendCount && !InErrorState; i++)
+    {
+        BatchedSend& Batched = BatchedSends[i];
+
+        if (!Batched.Encrypted)
+        {
+            WarningS(Connection->GetName().c_str(), "Failed to encrypt packet payload.");
+            InErrorState = true;
+            break;
+        }
+
+        if (!Connection->Send(Batched.Buffer, (int)Batched.Span.Offset, (int)Batched.Span.Length))
+        {
+            WarningS(Connection->GetName().c_str(), "Failed to send packet.");
+            InErrorState = true;
+            break;
+        }
+    }
+
+    BatchedSendCount = 0;
+    BatchedEncryptCount = 0;
+}
+
 bool Frpg2UdpPacketStream::Recieve(Frpg2UdpPacket* OutputPacket)
 {
     if (RecieveQueue.size() == 0)
@@ -163,21 +248,23 @@ bool Frpg2UdpPacketStream::Recieve(Frpg2UdpPacket* OutputPacket)
     return true;
 }
 
-bool Frpg2UdpPacketStream::BytesToPacket(const std::vector<uint8_t>& Buffer, Frpg2UdpPacket& Packet)
+bool Frpg2UdpPacketStream::BytesToPacket(const uint8_t* Buffer, size_t Length, Frpg2UdpPacket& Packet)
 {
-    int PayloadSize = (int)Buffer.size();
-
-    Packet.Payload.resize(PayloadSize);
-    memcpy(Packet.Payload.data(), Buffer.data(), PayloadSize);
+    Packet.Payload.assign(Buffer, Buffer + Length);
 
     return true;
 }
 
-bool Frpg2UdpPacketStream::PacketToBytes(const Frpg2UdpPacket& Packet, std::vector<uint8_t>& Buffer)
+bool Frpg2UdpPacketStream::PacketToBytes(const Frpg2UdpPacket& Packet, size_t PrefixSize, size_t SuffixSize, std::vector<uint8_t>& Buffer, CipherSpan& Span)
 {
-    Buffer.resize(Packet.Payload.size());
+    Buffer.resize(PrefixSize + Packet.Payload.size() + SuffixSize);
+
+    memcpy(Buffer.data() + PrefixSize, Packet.Payload.data(), Packet.Payload.size());
 
-    memcpy(Buffer.data(), Packet.Payload.data(), Packet.Payload.size());
+    Span.Buffer = Buffer.data();
+    Span.Capacity = Buffer.size();
+    Span.Offset = PrefixSize;
+    Span.Length = Packet.Payload.size();
 
     return true;
 }
@@ -11,10 +11,12 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
 
 #include "Server/Streams/Frpg2UdpPacket.h"
 
-class Cipher;
+#include "Core/Crypto/Cipher.h"
+
 class NetConnection;
 
 class Frpg2UdpPacketStream
@@ -37,10 +39,34 @@ public:
     // and the client this stream goes to should be disconnected.
     virtual bool Pump();
 
+    // When enabled Send only queues packets, they are encrypted by EncryptBatch 
+    // and sent by FlushBatch. This allows the owner to encrypt the batches of 
+    // many streams in parallel.
+    void SetBatchSends(bool Enabled) { BatchSends = Enabled; }
+    bool HasBatchedSends() { return BatchedSendCount > 0; }
+
+    // Called when a packet is queued into an empty batch, lets the owner keep track of
+    // which streams have something to send rather than checking all of them. It's called 
+    // from whichever thread is sending on the stream.
+    void SetBatchStartedCallback(std::function<void()> Callback) { BatchStartedCallback = Callback; }
+
+    // Encrypts all queued packets. Safe to call from a worker thread as long as
+    // nothing else is using this stream at the same time.
+    void EncryptBatch();
+
+    // Sends all queued packets in the order they were queued, encrypting
+    // any that EncryptBatch hasn't already.
+    void FlushBatch();
+
 protected:
 
-    bool BytesToPacket(const std::vector<uint8_t>& Buffer, Frpg2UdpPacket& Packet);
-    bool PacketToBytes(const Frpg2UdpPacket& Packet, std::vector<uint8_t>& Buffer);
+    bool BytesToPacket(const uint8_t* Buffer, size_t Length, Frpg2UdpPacket& Packet);
+
+    // Copies the packet payload into the buffer with the given amount of 
+    // room reserved either side of it, Span is set to cover the payload.
+    bool PacketToBytes(const Frpg2UdpPacket& Packet, size_t PrefixSize, size_t SuffixSize, std::vector<uint8_t>& Buffer, CipherSpan& Span);
+
+    bool EncryptPacket(CipherSpan& Span, bool HasConnectionPrefix);
 
 protected:
 
@@ -58,6 +84,23 @@ private:
     std::vector<Frpg2UdpPacket> RecieveQueue;
 
     std::vector<uint8_t> RecieveBuffer;
+    std::vector<uint8_t> SendBuffer;
+
+    struct BatchedSend
+    {
+        std::vector<uint8_t> Buffer;
+        CipherSpan Span;
+        bool HasConnectionPrefix = false;
+        bool Encrypted = false;
+    };
+
+    // Entries (and their buffers) are reused between batches, only the 
+    // first BatchedSendCount are live.
+    bool BatchSends = false;
+    std::vector<BatchedSend> BatchedSends;
+    size_t BatchedSendCount = 0;
+    size_t BatchedEncryptCount = 0;
+    std::function<void()> BatchStartedCallback;
 
     std::shared_ptr<Cipher> EncryptionCipher;
     std::shared_ptr<Cipher> DecryptionCipher;
@@ -72,6 +72,27 @@ bool DebugStatisticsHandler::handleGet(CivetServer* Server, struct mg_connection
             counters.push_back(stat);
         }
 
+        // Per message type handled counts from the game service's dispatch table.
+        if (std::shared_ptr<GameService> Game = Service->GetServer()->GetService<GameService>())
+        {
+            GameMessageDispatcher& Dispatcher = Game->GetMessageDispatcher();
+            for (size_t i = 0; i < (size_t)Frpg2ReliableUdpMessageTypeIndex::Count; i++)
+            {
+                Frpg2ReliableUdpMessageTypeIndex Index = (Frpg2ReliableUdpMessageTypeIndex)i;
+                uint64_t HandledCount = Dispatcher.GetHandledCount(Index);
+                if (HandledCount == 0)
+                {
+                    continue;
+                }
+
+                auto stat = nlohmann::json::object();
+                stat["name"] = StringFormat("Messages Handled (%s)", ReliableUdpMessageTypeIndex_To_String(Index));
+                stat["average_rate"] = "-";
+                stat["total_lifetime"] = StringFormat("%llu", HandledCount);
+                counters.push_back(stat);
+            }
+        }
+
         auto logs = nlohmann::json::array();
         for (const LogMessage& Message : GetRecentLogs())
         {
@@ -50,10 +50,7 @@ bool MessageHandler::handlePost(CivetServer* Server, struct mg_connection* Conne
     if (playerId == 0)
     {
         LogS("WebUI", "Sending message to all players: %s", message.c_str());
-        for (auto Client : Game->GetClients())
-        {
-            Client->SendTextMessage(message);
-        }
+        Game->BroadcastTextMessage(message, Game->GetClients());
     }
     else
     {
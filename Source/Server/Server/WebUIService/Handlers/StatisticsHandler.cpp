@@ -19,6 +19,7 @@
 
 #include "Core/Utils/Logging.h"
 #include "Core/Utils/Strings.h"
+#include "Core/Utils/DebugObjects.h"
 
 #include <ctime>
 
@@ -71,7 +72,23 @@ void StatisticsHandler::GatherData()
             Samples.erase(Samples.begin());
         }
 
-        UniquePlayerCount = Service->GetServer()->GetDatabase().GetTotalPlayers();
+        // Counting players is a full database query, so it's left to the database thread.
+        if (!UniquePlayerCountQueued)
+        {
+            UniquePlayerCountQueued = true;
+
+            Service->GetServer()->GetDatabaseExecutor().Run(
+                [](ServerDatabase& Database) {
+                    DebugTimerScope Scope(Debug::Maintenance_StatisticsTime);
+                    return Database.GetTotalPlayers();
+                },
+                [this](size_t TotalPlayers) {
+                    std::scoped_lock lock(DataMutex);
+                    UniquePlayerCount = TotalPlayers;
+                    UniquePlayerCountQueued = false;
+                }
+            );
+        }
     }
 
     // Grab some per-frame statistics.
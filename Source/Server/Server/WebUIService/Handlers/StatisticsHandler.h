@@ -47,6 +47,7 @@ protected:
 	std::map<OnlineAreaId, size_t> PopulatedAreas; 
 
 	size_t UniquePlayerCount = 0;
+	bool UniquePlayerCountQueued = false;
 
 	size_t PreviousSampleClientSize = 0;
 
@@ -507,6 +507,87 @@ void mlt_4(uint32_t r[], const uint32_t a[], const uint32_t b[])
     }
 }
 
+/* on 64-bit targets with a native 64 x 64 => 128 bit multiply the */
+/* hash is computed on 64-bit limbs (4 multiplies instead of 16)   */
+
+#if defined( _MSC_VER ) && defined( _M_X64 )
+#  include <intrin.h>
+#  define CWC_MUL_64
+#  define mul_64(a, b, hi)  _umul128((a), (b), (hi))
+#elif defined( __SIZEOF_INT128__ )
+#  define CWC_MUL_64
+static uint64_t mul_64(uint64_t a, uint64_t b, uint64_t *hi)
+{   unsigned __int128 p = (unsigned __int128)a * b;
+    *hi = (uint64_t)(p >> 64);
+    return (uint64_t)p;
+}
+#endif
+
+#if defined( CWC_MUL_64 )
+
+/* Carter-Wegman hash iteration on 12 bytes of data */
+
+void do_cwc(uint32_t in[], cwc_ctx ctx[1])
+{   uint64_t    d1, d0, z1, z0, p3, p2, p1, p0, ah, al, bh, bl, ch, cl, c;
+
+	if (PLATFORM_BYTE_ORDER == IS_BIG_ENDIAN)
+	{
+		d1 = bswap_32(in[0]);
+		d0 = ((uint64_t)bswap_32(in[1]) << 32) | bswap_32(in[2]);
+	}
+	else
+	{
+		d1 = in[0];
+		d0 = ((uint64_t)in[1] << 32) | in[2];
+	}
+
+    /* add current hash value into the current data block   */
+    p0 = ((uint64_t)ctx->hash[2] << 32) | ctx->hash[3];
+    d0 += p0;
+    d1 += (((uint64_t)ctx->hash[0] << 32) | ctx->hash[1]) + (d0 < p0);
+
+    /* multiply by the hash key in Z giving p3:p2:p1:p0     */
+    z1 = ((uint64_t)ctx->zval[0] << 32) | ctx->zval[1];
+    z0 = ((uint64_t)ctx->zval[2] << 32) | ctx->zval[3];
+
+    p0 = mul_64(d0, z0, &p1);
+    al = mul_64(d0, z1, &ah);
+    bl = mul_64(d1, z0, &bh);
+    cl = mul_64(d1, z1, &ch);
+
+    p1 += al; c = (p1 < al);
+    p1 += bl; c += (p1 < bl);
+    p2 = ah + c; c = (p2 < c);
+    p2 += bh; c += (p2 < bh);
+    p2 += cl; c += (p2 < cl);
+    p3 = ch + c;
+
+    /* reduce modulo (2^127 - 1) as 2 * hi + lo exactly as  */
+    /* in the 32-bit version below                          */
+    p3 = (p3 << 1) | (p2 >> 63);
+    p2 <<= 1;
+    if(p1 >> 63)
+    {
+        p1 &= 0x7fffffffffffffffull;
+        p2 += 1;
+    }
+
+    p2 += p0;
+    p3 += p1 + (p2 < p0);
+    if(p3 >> 63)
+    {
+        p3 &= 0x7fffffffffffffffull;
+        p3 += (++p2 == 0);
+    }
+
+    ctx->hash[0] = (uint32_t)(p3 >> 32);
+    ctx->hash[1] = (uint32_t)p3;
+    ctx->hash[2] = (uint32_t)(p2 >> 32);
+    ctx->hash[3] = (uint32_t)p2;
+}
+
+#else
+
 /* Carter-Wegman hash iteration on 12 bytes of data */
 
 void do_cwc(uint32_t in[], cwc_ctx ctx[1])
@@ -555,6 +636,8 @@ void do_cwc(uint32_t in[], cwc_ctx ctx[1])
 
 #endif
 
+#endif
+
 ret_type cwc_init_and_key(                  /* initialise mode and set key  */
             const unsigned char key[],      /* the key value                */
             unsigned long key_len,          /* and its length in bytes      */